@@ -0,0 +1,291 @@
+#include "FaceNormalService.h"
+#include "OCCHandler.h"
+#include "SprayProfiler.h"
+#include <BRep_Tool.hxx>
+#include <BRepAdaptor_Surface.hxx>
+#include <BRepTools.hxx>
+#include <BRepTopAdaptor_FClass2d.hxx>
+#include <TopLoc_Location.hxx>
+#include <Precision.hxx>
+#include <TopoDS.hxx>
+#include <gp_Pnt2d.hxx>
+#include <gp_Vec.hxx>
+#include <OSD_Parallel.hxx>
+#include <Message_ProgressScope.hxx>
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+// 3点高斯-勒让德积分的节点与权重（区间[-1, 1]）
+static const double GAUSS_NODES[3] = { -0.7745966692414834, 0.0, 0.7745966692414834 };
+static const double GAUSS_WEIGHTS[3] = { 5.0 / 9.0, 8.0 / 9.0, 5.0 / 9.0 };
+
+// 批量查询时每个并行任务计算的面数
+static const int FACE_NORMAL_BATCH_CHUNK = 256;
+
+// 面积加权法向量的长度至少为面积的这一比例，否则视为相互抵消
+static const double FACE_NORMAL_RELATIVE_MIN = 1e-6;
+
+// UV范围中点处的单位法向量（正向面）
+static bool midpointNormal(const TopoDS_Face& face, gp_XYZ& result) {
+    BRepAdaptor_Surface surface(face);
+    double uMin, uMax, vMin, vMax;
+    BRepTools::UVBounds(face, uMin, uMax, vMin, vMax);
+    gp_Pnt point;
+    gp_Vec du, dv;
+    surface.D1((uMin + uMax) * 0.5, (vMin + vMax) * 0.5, point, du, dv);
+    gp_XYZ normal = du.XYZ().Crossed(dv.XYZ());
+    const double modulus = normal.Modulus();
+    if (modulus < 1e-10) {
+        return false;
+    }
+    result = normal / modulus;
+    return true;
+}
+
+// 构造函数
+FaceNormalService::FaceNormalService() {
+}
+
+// 计算单个面的缓存项：TShape坐标系、正向
+FaceNormalService::Entry FaceNormalService::compute(const TopoDS_Face& face) {
+    Entry entry;
+    entry.tshape = face.TShape();
+
+    TopoDS_Face bare = TopoDS::Face(face.Located(TopLoc_Location()).Oriented(TopAbs_FORWARD));
+    gp_XYZ weighted(0, 0, 0);
+    double area = 0.0;
+
+    TopLoc_Location location;
+    Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(bare, location);
+    if (!triangulation.IsNull() && triangulation->NbTriangles() > 0) {
+        // 三角形法向量按面积加权（叉积长度即两倍面积）
+        entry.triangulation = triangulation;
+        const gp_Trsf& trsf = location.Transformation();
+        const bool transformed = !location.IsIdentity();
+        for (int t = 1; t <= triangulation->NbTriangles(); t++) {
+            int n1, n2, n3;
+            triangulation->Triangle(t).Get(n1, n2, n3);
+            gp_Pnt p1 = triangulation->Node(n1);
+            gp_Pnt p2 = triangulation->Node(n2);
+            gp_Pnt p3 = triangulation->Node(n3);
+            if (transformed) {
+                p1.Transform(trsf);
+                p2.Transform(trsf);
+                p3.Transform(trsf);
+            }
+            gp_XYZ cross = (p2.XYZ() - p1.XYZ()).Crossed(p3.XYZ() - p1.XYZ());
+            weighted += cross * 0.5;
+            area += cross.Modulus() * 0.5;
+        }
+        if (transformed && trsf.IsNegative()) {
+            weighted.Reverse();
+        }
+    } else {
+        // 无剖分：UV范围内3x3高斯点，按雅可比行列式加权；裁剪边界外的点不计
+        BRepAdaptor_Surface surface(bare);
+        double uMin, uMax, vMin, vMax;
+        BRepTools::UVBounds(bare, uMin, uMax, vMin, vMax);
+        const double uHalf = (uMax - uMin) * 0.5;
+        const double vHalf = (vMax - vMin) * 0.5;
+        BRepTopAdaptor_FClass2d classifier(bare, Precision::PConfusion());
+
+        gp_XYZ allWeighted(0, 0, 0);
+        double allArea = 0.0;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                const double u = uMin + uHalf * (1.0 + GAUSS_NODES[i]);
+                const double v = vMin + vHalf * (1.0 + GAUSS_NODES[j]);
+                gp_Pnt point;
+                gp_Vec du, dv;
+                surface.D1(u, v, point, du, dv);
+                gp_XYZ cross = du.XYZ().Crossed(dv.XYZ()) * (GAUSS_WEIGHTS[i] * GAUSS_WEIGHTS[j] * uHalf * vHalf);
+                allWeighted += cross;
+                allArea += cross.Modulus();
+                if (classifier.Perform(gp_Pnt2d(u, v)) != TopAbs_OUT) {
+                    weighted += cross;
+                    area += cross.Modulus();
+                }
+            }
+        }
+        // 高斯点全部落在裁剪边界外（细长或环形的面）时使用全部采样点
+        if (area <= 0.0) {
+            weighted = allWeighted;
+            area = allArea;
+        }
+    }
+
+    // 封闭或近似对称的面（圆柱、球冠、整周旋转面）加权和相互抵消，只剩数值噪声：
+    // 相对面积过小时改用UV中点处的法向量
+    const double modulus = weighted.Modulus();
+    if (area > 0.0 && modulus > FACE_NORMAL_RELATIVE_MIN * area) {
+        entry.normal = weighted / modulus;
+        entry.area = area;
+        entry.valid = true;
+    } else if (area > 0.0 && midpointNormal(bare, entry.normal)) {
+        entry.area = area;
+        entry.valid = true;
+    }
+    return entry;
+}
+
+// 查找仍然有效的缓存项（剖分变化后视为未命中）
+bool FaceNormalService::find(const TopoDS_Face& face, Entry& entry) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = entries.find(face.TShape().get());
+    if (it == entries.end()) {
+        return false;
+    }
+    TopLoc_Location location;
+    const Handle(Poly_Triangulation)& triangulation = BRep_Tool::Triangulation(face, location);
+    if (it->second.triangulation != triangulation) {
+        return false;
+    }
+    entry = it->second;
+    return true;
+}
+
+// 写入缓存项
+void FaceNormalService::insert(const Entry& entry) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    entries[entry.tshape.get()] = entry;
+}
+
+// 将缓存项转换到面的位置与拓扑方向
+bool FaceNormalService::resolve(const TopoDS_Face& face, const Entry& entry, gp_Dir& result) {
+    if (!entry.valid) {
+        return false;
+    }
+    gp_Dir direction(entry.normal);
+    if (!face.Location().IsIdentity()) {
+        direction.Transform(face.Location().Transformation());
+    }
+    if (face.Orientation() == TopAbs_REVERSED) {
+        direction.Reverse();
+    }
+    result = direction;
+    return true;
+}
+
+// 面的单位法向量
+bool FaceNormalService::normal(const TopoDS_Face& face, gp_Dir& result) {
+    double area = 0.0;
+    return normalAndArea(face, result, area);
+}
+
+// 面的单位法向量与面积
+bool FaceNormalService::normalAndArea(const TopoDS_Face& face, gp_Dir& result, double& area) {
+    if (face.IsNull()) {
+        return false;
+    }
+    Entry entry;
+    if (find(face, entry)) {
+        SPRAY_COUNTER_ADD("faceNormals.hits", 1);
+    } else {
+        SPRAY_COUNTER_ADD("faceNormals.misses", 1);
+        try {
+            entry = compute(face);
+        } catch (...) {
+            entry = Entry();
+            entry.tshape = face.TShape();
+        }
+        insert(entry);
+    }
+    area = entry.area;
+    return resolve(face, entry, result);
+}
+
+// 批量查询
+bool FaceNormalService::normals(const std::vector<TopoDS_Face>& faces, FaceNormalArrays& normals, bool parallel,
+                                const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("faceNormals.batch");
+
+    const size_t count = faces.size();
+    normals.x.assign(count, 0.0);
+    normals.y.assign(count, 0.0);
+    normals.z.assign(count, 0.0);
+    normals.valid.assign(count, 0);
+
+    // 找出未缓存的面（同一TShape只计算一次）
+    std::vector<Entry> resolved(count);
+    std::vector<int> missing;
+    std::unordered_map<const TopoDS_TShape*, size_t> missingSlot;  // TShape -> missing中的序号
+    for (size_t i = 0; i < count; i++) {
+        if (faces[i].IsNull()) {
+            continue;
+        }
+        if (!find(faces[i], resolved[i]) && missingSlot.emplace(faces[i].TShape().get(), missing.size()).second) {
+            missing.push_back(static_cast<int>(i));
+        }
+    }
+    SPRAY_COUNTER_ADD("faceNormals.hits", static_cast<long long>(count - missing.size()));
+    SPRAY_COUNTER_ADD("faceNormals.misses", static_cast<long long>(missing.size()));
+
+    // 并行计算，各块的进度范围在主线程中预先分配
+    const int missingCount = static_cast<int>(missing.size());
+    const int chunkCount = (missingCount + FACE_NORMAL_BATCH_CHUNK - 1) / FACE_NORMAL_BATCH_CHUNK;
+    Message_ProgressScope scope(range, "计算面法向量", std::max(chunkCount, 1));
+    std::vector<Message_ProgressRange> chunkRanges;
+    chunkRanges.reserve(chunkCount);
+    for (int c = 0; c < chunkCount; c++) {
+        chunkRanges.push_back(scope.Next());
+    }
+
+    std::vector<Entry> computed(missing.size());
+    OSD_Parallel::For(0, chunkCount, [&](int c) {
+        Message_ProgressScope chunkScope(chunkRanges[c], nullptr, 1);
+        if (!chunkScope.More()) {
+            return;
+        }
+        const int end = std::min(missingCount, (c + 1) * FACE_NORMAL_BATCH_CHUNK);
+        for (int k = c * FACE_NORMAL_BATCH_CHUNK; k < end; k++) {
+            const TopoDS_Face& face = faces[missing[k]];
+            try {
+                computed[k] = compute(face);
+            } catch (...) {
+                computed[k] = Entry();
+                computed[k].tshape = face.TShape();
+            }
+        }
+    }, !parallel);
+
+    if (!scope.More()) {
+        return false;
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        for (const Entry& entry : computed) {
+            entries[entry.tshape.get()] = entry;
+        }
+    }
+
+    // 套用各面的位置与拓扑方向
+    for (size_t i = 0; i < count; i++) {
+        if (faces[i].IsNull()) {
+            continue;
+        }
+        auto it = missingSlot.find(faces[i].TShape().get());
+        const Entry& entry = it != missingSlot.end() ? computed[it->second] : resolved[i];
+        gp_Dir direction;
+        if (resolve(faces[i], entry, direction)) {
+            normals.x[i] = direction.X();
+            normals.y[i] = direction.Y();
+            normals.z[i] = direction.Z();
+            normals.valid[i] = 1;
+        }
+    }
+    return true;
+}
+
+// 清空缓存
+void FaceNormalService::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    entries.clear();
+}
+
+// 缓存的面数量
+size_t FaceNormalService::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return entries.size();
+}
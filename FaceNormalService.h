@@ -0,0 +1,66 @@
+#pragma once
+
+#include <TopoDS_Face.hxx>
+#include <TopoDS_TShape.hxx>
+#include <Poly_Triangulation.hxx>
+#include <gp_Dir.hxx>
+#include <gp_XYZ.hxx>
+#include <Message_ProgressRange.hxx>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+struct FaceNormalArrays;
+
+// 面法向量服务（按TShape缓存，线程安全）
+//
+// 法向量为整个面的面积加权平均：面已有三角剖分时对全部三角形的法向量按面积加权，
+// 否则在UV范围内取3x3高斯点，按雅可比行列式加权（落在裁剪边界外的点不计）。
+// 加权和相对面积过小（封闭或对称的面相互抵消）时改用UV中点处的法向量。
+// 缓存保存TShape自身坐标系、正向（FORWARD）下的结果，查询时再套用面的位置和拓扑方向，
+// 因此同一零件的多个实例、模型整体旋转平移后都能命中缓存。面的剖分变化后自动重新计算。
+class FaceNormalService {
+public:
+    FaceNormalService();
+
+    // 面的单位法向量（已考虑位置与拓扑方向），无法计算时返回false
+    bool normal(const TopoDS_Face& face, gp_Dir& result);
+
+    // 面的单位法向量与面积，无法计算时返回false
+    bool normalAndArea(const TopoDS_Face& face, gp_Dir& result, double& area);
+
+    // 批量查询：未缓存的面并行计算后写入缓存，结果按faces顺序写入normals；取消时返回false
+    bool normals(const std::vector<TopoDS_Face>& faces, FaceNormalArrays& normals, bool parallel,
+                 const Message_ProgressRange& range = Message_ProgressRange());
+
+    // 清空缓存（释放对TShape的引用）
+    void clear();
+
+    // 缓存的面数量
+    size_t size() const;
+
+private:
+    // 缓存项（TShape坐标系、正向）
+    struct Entry {
+        Handle(TopoDS_TShape) tshape;            // 持有TShape，避免地址被复用
+        Handle(Poly_Triangulation) triangulation; // 计算时使用的剖分（无剖分时为空）
+        gp_XYZ normal;                           // 单位法向量
+        double area = 0.0;                       // 面积
+        bool valid = false;                      // 是否成功计算
+    };
+
+    // 计算单个面的缓存项
+    static Entry compute(const TopoDS_Face& face);
+
+    // 查找仍然有效的缓存项
+    bool find(const TopoDS_Face& face, Entry& entry) const;
+
+    // 写入缓存项
+    void insert(const Entry& entry);
+
+    // 将缓存项转换到面的位置与拓扑方向
+    static bool resolve(const TopoDS_Face& face, const Entry& entry, gp_Dir& result);
+
+    mutable std::shared_mutex mutex;                          // 读多写少
+    std::unordered_map<const TopoDS_TShape*, Entry> entries;  // 按TShape缓存
+};
@@ -1,4 +1,9 @@
 #include "FaceProcessor.h"
+#include "FaceNormalService.h"
+#include "PolyDataBatchBuilder.h"
+#include "TrajectoryFile.h"
+#include "SprayLog.h"
+#include "SprayProfiler.h"
 #include <BRep_Tool.hxx>
 #include <BRepBndLib.hxx>
 #include <Bnd_Box.hxx>
@@ -36,11 +41,13 @@
 #include <BRepBuilderAPI_MakeWire.hxx>
 #include <TopoDS_Iterator.hxx>
 #include <GeomAPI_IntCS.hxx>
+#include <Message_ProgressScope.hxx>
 #include <Geom_Line.hxx>
 #include <Geom_Plane.hxx>
 
 // 构造函数
-FaceProcessor::FaceProcessor() : pathSpacing(10.0), offsetDistance(5.0), pointDensity(1.0), minPathLength(20.0) {
+FaceProcessor::FaceProcessor() : pathSpacing(10.0), offsetDistance(5.0), pointDensity(1.0), minPathLength(20.0),
+      faceNormalService(std::make_shared<FaceNormalService>()), singlePrecisionPolyData(false) {
 }
 
 // 析构函数
@@ -59,7 +66,7 @@ void FaceProcessor::setCuttingParameters(gp_Dir cutdirection ,double spacing, do
     pathSpacing = spacing;
     offsetDistance = offset;
     if (density <= 0.0) {
-        std::cerr << "警告：点密度必须大于0，设置为默认值1.0" << std::endl;
+        SPRAY_LOG_WARN << "警告：点密度必须大于0，设置为默认值1.0";
         pointDensity = 1.0;
     } else {
         pointDensity = density;
@@ -69,17 +76,22 @@ void FaceProcessor::setCuttingParameters(gp_Dir cutdirection ,double spacing, do
 // 设置最小路径长度
 void FaceProcessor::setMinPathLength(double minLength) {
     if (minLength < 0.0) {
-        std::cerr << "警告：最小路径长度不能为负数，设置为0.0" << std::endl;
+        SPRAY_LOG_WARN << "警告：最小路径长度不能为负数，设置为0.0";
         minPathLength = 0.0;
     } else {
         minPathLength = minLength;
     }
 }
 
+// 设置面法向量服务
+void FaceProcessor::setFaceNormalService(const std::shared_ptr<FaceNormalService>& service) {
+    faceNormalService = service ? service : std::make_shared<FaceNormalService>();
+}
+
 // 自动检测并调整单位
 void FaceProcessor::autoDetectAndAdjustUnits() {
     if (generatedPaths.empty()) {
-        std::cout << "没有路径可用于单位检测" << std::endl;
+        SPRAY_LOG_INFO << "没有路径可用于单位检测";
         return;
     }
 
@@ -93,7 +105,7 @@ void FaceProcessor::autoDetectAndAdjustUnits() {
     }
 
     if (lengths.empty()) {
-        std::cout << "没有有效长度的路径用于单位检测" << std::endl;
+        SPRAY_LOG_INFO << "没有有效长度的路径用于单位检测";
         return;
     }
 
@@ -103,11 +115,11 @@ void FaceProcessor::autoDetectAndAdjustUnits() {
     double maxLength = lengths.back();
     double medianLength = lengths[lengths.size() / 2];
 
-    std::cout << "\n=== 单位自动检测 ===" << std::endl;
-    std::cout << "路径长度统计:" << std::endl;
-    std::cout << "- 最短: " << std::fixed << std::setprecision(6) << minLength << std::endl;
-    std::cout << "- 最长: " << std::fixed << std::setprecision(6) << maxLength << std::endl;
-    std::cout << "- 中位数: " << std::fixed << std::setprecision(6) << medianLength << std::endl;
+    SPRAY_LOG_INFO << "\n=== 单位自动检测 ===";
+    SPRAY_LOG_INFO << "路径长度统计:";
+    SPRAY_LOG_INFO << "- 最短: " << std::fixed << std::setprecision(6) << minLength;
+    SPRAY_LOG_INFO << "- 最长: " << std::fixed << std::setprecision(6) << maxLength;
+    SPRAY_LOG_INFO << "- 中位数: " << std::fixed << std::setprecision(6) << medianLength;
 
     // 基于长度范围推测单位
     std::string detectedUnit = "未知";
@@ -130,25 +142,27 @@ void FaceProcessor::autoDetectAndAdjustUnits() {
         suggestedThreshold = 0.00002; // 0.00002km = 20mm
     }
 
-    std::cout << "推测单位: " << detectedUnit << std::endl;
-    std::cout << "建议的最小路径长度阈值: " << suggestedThreshold << std::endl;
+    SPRAY_LOG_INFO << "推测单位: " << detectedUnit;
+    SPRAY_LOG_INFO << "建议的最小路径长度阈值: " << suggestedThreshold;
 
     // 询问是否自动调整
-    std::cout << "当前阈值: " << minPathLength << std::endl;
+    SPRAY_LOG_INFO << "当前阈值: " << minPathLength;
     if (std::abs(minPathLength - suggestedThreshold) > suggestedThreshold * 0.1) {
-        std::cout << "建议将阈值调整为: " << suggestedThreshold << std::endl;
+        SPRAY_LOG_INFO << "建议将阈值调整为: " << suggestedThreshold;
         // 自动调整（在实际应用中可能需要用户确认）
         minPathLength = suggestedThreshold;
-        std::cout << "已自动调整最小路径长度阈值为: " << minPathLength << std::endl;
+        SPRAY_LOG_INFO << "已自动调整最小路径长度阈值为: " << minPathLength;
     } else {
-        std::cout << "当前阈值合理，无需调整" << std::endl;
+        SPRAY_LOG_INFO << "当前阈值合理，无需调整";
     }
 }
 
 // 生成切割平面
 bool FaceProcessor::generateCuttingPlanes() {
+    SPRAY_PROFILE_SCOPE("paths.generateCuttingPlanes");
+
     if (inputFaces.IsNull()) {
-        std::cerr << "No input faces available for cutting plane generation." << std::endl;
+        SPRAY_LOG_WARN << "No input faces available for cutting plane generation.";
         return false;
     }
 
@@ -163,11 +177,11 @@ bool FaceProcessor::generateCuttingPlanes() {
     }
 
     if (allFaces.empty()) {
-        std::cerr << "No faces found in input shape." << std::endl;
+        SPRAY_LOG_WARN << "No faces found in input shape.";
         return false;
     }
 
-    std::cout << "Generating cutting planes for " << allFaces.size() << " faces..." << std::endl;
+    SPRAY_LOG_INFO << "Generating cutting planes for " << allFaces.size() << " faces...";
 
     // 创建包含所有面的复合形状
     TopoDS_Compound visibleCompound;
@@ -183,7 +197,7 @@ bool FaceProcessor::generateCuttingPlanes() {
     BRepBndLib::Add(visibleCompound, boundingBox);
 
     if (boundingBox.IsVoid()) {
-        std::cerr << "无法计算形状的包围盒" << std::endl;
+        SPRAY_LOG_WARN << "无法计算形状的包围盒";
         return false;
     }
 
@@ -250,15 +264,18 @@ bool FaceProcessor::generateCuttingPlanes() {
         cuttingPlanes.push_back(cuttingPlane);
     }
 
-    std::cout << "生成了 " << cuttingPlanes.size() << " 个切割平面" << std::endl;
+    SPRAY_LOG_INFO << "生成了 " << cuttingPlanes.size() << " 个切割平面";
+    SPRAY_COUNTER_ADD("paths.planesSliced", static_cast<long long>(cuttingPlanes.size()));
     return !cuttingPlanes.empty();
 
 }
 
 // 生成路径
-bool FaceProcessor::generatePaths() {
+bool FaceProcessor::generatePaths(const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("paths.generatePaths");
+
     if (inputFaces.IsNull()) {
-        std::cerr << "No input faces available for path generation." << std::endl;
+        SPRAY_LOG_WARN << "No input faces available for path generation.";
         return false;
     }
 
@@ -277,7 +294,7 @@ bool FaceProcessor::generatePaths() {
         allFaces.push_back(face);
     }
 
-    std::cout << "Generating paths for " << allFaces.size() << " faces..." << std::endl;
+    SPRAY_LOG_INFO << "Generating paths for " << allFaces.size() << " faces...";
 
     int pathCount = 0;
 
@@ -291,13 +308,16 @@ bool FaceProcessor::generatePaths() {
     }
 
     // 对每个切割平面
-    for (size_t i = 0; i < cuttingPlanes.size(); i++) {
+    Message_ProgressScope scope(range, "切割平面求交", static_cast<Standard_Real>(cuttingPlanes.size()));
+    for (size_t i = 0; i < cuttingPlanes.size() && scope.More(); i++) {
+        Message_ProgressRange planeRange = scope.Next();
+
         // 创建切割平面
         TopoDS_Face planeFace = BRepBuilderAPI_MakeFace(cuttingPlanes[i]).Face();
 
         // 计算与可见面的交线
         BRepAlgoAPI_Section section(visibleCompound, planeFace, Standard_False);
-        section.Build();
+        section.Build(planeRange);
 
         if (!section.IsDone() || section.Shape().IsNull()) {
             continue;
@@ -341,19 +361,18 @@ bool FaceProcessor::generatePaths() {
                 // 计算路径长度并进行筛选
                 double pathLength = calculatePathLength(path);
 
-                // 添加调试信息
-                if (pathCount < 10) {  // 只显示前10条路径的调试信息
-                    std::cout << "路径 " << pathCount << ": 点数=" << path.points.size()
-                              << ", 长度=" << std::fixed << std::setprecision(2) << pathLength
-                              << "mm, 阈值=" << minPathLength << "mm";
-                }
-
                 // 只保留长度大于等于最小长度的路径
-                if (pathLength >= minPathLength) {
-                    if (pathCount < 10) {
-                        std::cout << " -> 保留" << std::endl;
-                    }
+                bool keepPath = pathLength >= minPathLength;
+
+                // 调试信息：只显示前10条路径
+                if (pathCount < 10) {
+                    SPRAY_LOG_DEBUG << "路径 " << pathCount << ": 点数=" << path.points.size()
+                                    << ", 长度=" << std::fixed << std::setprecision(2) << pathLength
+                                    << "mm, 阈值=" << minPathLength << "mm"
+                                    << (keepPath ? " -> 保留" : " -> 过滤");
+                }
 
+                if (keepPath) {
                     // 设置路径索引和宽度
                     path.pathIndex = pathCount++;
                     path.width = pathSpacing;
@@ -363,17 +382,20 @@ bool FaceProcessor::generatePaths() {
                     // 添加到路径列表
                     generatedPaths.push_back(path);
                 } else {
-                    if (pathCount < 10) {
-                        std::cout << " -> 过滤" << std::endl;
-                    }
                     pathCount++;  // 仍然增加计数器以保持调试信息的连续性
                 }
             }
         }
     }
 
-    std::cout << "生成了 " << generatedPaths.size() << " 条路径（已过滤长度小于 "
-              << minPathLength << "mm 的短路径）" << std::endl;
+    if (!scope.More()) {
+        SPRAY_LOG_INFO << "⏹️ 已取消路径生成";
+        clearPaths();
+        return false;
+    }
+
+    SPRAY_LOG_INFO << "生成了 " << generatedPaths.size() << " 条路径（已过滤长度小于 "
+                   << minPathLength << "mm 的短路径）";
 
     // 输出一些统计信息
     if (!generatedPaths.empty()) {
@@ -388,17 +410,26 @@ bool FaceProcessor::generatePaths() {
             maxLength = std::max(maxLength, length);
         }
 
-        std::cout << "路径长度统计: 总长=" << std::fixed << std::setprecision(1) << totalLength
-                  << "mm, 平均=" << (totalLength/generatedPaths.size())
-                  << "mm, 最短=" << minLength
-                  << "mm, 最长=" << maxLength << "mm" << std::endl;
+        SPRAY_LOG_INFO << "路径长度统计: 总长=" << std::fixed << std::setprecision(1) << totalLength
+                       << "mm, 平均=" << (totalLength/generatedPaths.size())
+                       << "mm, 最短=" << minLength
+                       << "mm, 最长=" << maxLength << "mm";
 
         // 如果发现路径长度异常，自动检测单位
         if (minLength < 1.0 || maxLength > 10000.0) {
-            std::cout << "检测到异常的路径长度，启动单位自动检测..." << std::endl;
+            SPRAY_LOG_INFO << "检测到异常的路径长度，启动单位自动检测...";
             autoDetectAndAdjustUnits();
         }
     }
+
+    if (SprayProfiler::instance().isEnabled()) {
+        long long pointCount = 0;
+        for (const SprayPath& path : generatedPaths) {
+            pointCount += static_cast<long long>(path.points.size());
+        }
+        SPRAY_COUNTER_ADD("paths.pathsGenerated", static_cast<long long>(generatedPaths.size()));
+        SPRAY_COUNTER_ADD("paths.pointsEmitted", pointCount);
+    }
     return !generatedPaths.empty();
 }
 
@@ -456,15 +487,12 @@ double FaceProcessor::calculatePathLength(const SprayPath& path) const {
         minSegment = std::min(minSegment, segmentLength);
     }
 
-    // 对于前几条路径，输出详细的调试信息
-    static int debugCount = 0;
-    if (debugCount < 5 && path.points.size() > 1) {
-        std::cout << "  详细信息: 段数=" << (path.points.size()-1)
+    // 对于前几条路径，输出详细的调试信息（按调用点限流，多线程安全）
+    if (path.points.size() > 1) {
+        SPRAY_LOG_FIRST_N(SprayLogLevel::Debug, 5) << "  详细信息: 段数=" << (path.points.size()-1)
                   << ", 最长段=" << std::fixed << std::setprecision(3) << maxSegment
-                  << ", 最短段=" << std::fixed << std::setprecision(3) << minSegment
-                  << ", 平均段=" << std::fixed << std::setprecision(3) << (totalLength/(path.points.size()-1))
-                  << std::endl;
-        debugCount++;
+                  << ", 最短段=" << minSegment
+                  << ", 平均段=" << (totalLength/(path.points.size()-1));
     }
 
     return totalLength;
@@ -473,7 +501,7 @@ double FaceProcessor::calculatePathLength(const SprayPath& path) const {
 // 检测单位并设置最优阈值
 void FaceProcessor::detectAndSetOptimalThreshold() {
     if (generatedPaths.empty()) {
-        std::cout << "No paths available for unit detection. Generate paths first." << std::endl;
+        SPRAY_LOG_INFO << "No paths available for unit detection. Generate paths first.";
         return;
     }
 
@@ -483,28 +511,28 @@ void FaceProcessor::detectAndSetOptimalThreshold() {
     testPath.points.push_back(PathPoint(gp_Pnt(10, 0, 0), gp_Dir(0, 0, 1)));
 
     double testLength = calculatePathLength(testPath);
-    std::cout << "Unit detection: 10-unit test path length = " << testLength << std::endl;
+    SPRAY_LOG_INFO << "Unit detection: 10-unit test path length = " << testLength;
 
     // 根据测试长度判断单位并设置阈值
     if (testLength > 9.99 && testLength < 10.01) {
-        std::cout << "Detected units: millimeters (mm)" << std::endl;
+        SPRAY_LOG_INFO << "Detected units: millimeters (mm)";
         setMinPathLength(20.0);
-        std::cout << "Set threshold to: 20.0 mm" << std::endl;
+        SPRAY_LOG_INFO << "Set threshold to: 20.0 mm";
     } else if (testLength > 0.0099 && testLength < 0.0101) {
-        std::cout << "Detected units: meters (m)" << std::endl;
+        SPRAY_LOG_INFO << "Detected units: meters (m)";
         setMinPathLength(0.02);
-        std::cout << "Set threshold to: 0.02 m (20mm)" << std::endl;
+        SPRAY_LOG_INFO << "Set threshold to: 0.02 m (20mm)";
     } else if (testLength > 0.99 && testLength < 1.01) {
-        std::cout << "Detected units: centimeters (cm)" << std::endl;
+        SPRAY_LOG_INFO << "Detected units: centimeters (cm)";
         setMinPathLength(2.0);
-        std::cout << "Set threshold to: 2.0 cm (20mm)" << std::endl;
+        SPRAY_LOG_INFO << "Set threshold to: 2.0 cm (20mm)";
     } else if (testLength > 0.39 && testLength < 0.40) {
-        std::cout << "Detected units: inches (in)" << std::endl;
+        SPRAY_LOG_INFO << "Detected units: inches (in)";
         setMinPathLength(0.787);
-        std::cout << "Set threshold to: 0.787 in (20mm)" << std::endl;
+        SPRAY_LOG_INFO << "Set threshold to: 0.787 in (20mm)";
     } else {
-        std::cout << "Unknown units detected. Test length: " << testLength << std::endl;
-        std::cout << "Please manually set appropriate threshold." << std::endl;
+        SPRAY_LOG_INFO << "Unknown units detected. Test length: " << testLength;
+        SPRAY_LOG_INFO << "Please manually set appropriate threshold.";
     }
 }
 
@@ -532,7 +560,7 @@ std::string FaceProcessor::detectUnits() const {
 // 打印路径长度统计信息
 void FaceProcessor::printPathLengthStatistics() const {
     if (generatedPaths.empty()) {
-        std::cout << "No paths available for statistics." << std::endl;
+        SPRAY_LOG_INFO << "No paths available for statistics.";
         return;
     }
 
@@ -553,13 +581,13 @@ void FaceProcessor::printPathLengthStatistics() const {
     }
     double avgLength = totalLength / lengths.size();
 
-    std::cout << "\n=== Path Length Statistics ===" << std::endl;
-    std::cout << "Total paths: " << lengths.size() << std::endl;
-    std::cout << "Min length: " << std::fixed << std::setprecision(6) << minLength << std::endl;
-    std::cout << "Max length: " << std::fixed << std::setprecision(6) << maxLength << std::endl;
-    std::cout << "Average length: " << std::fixed << std::setprecision(6) << avgLength << std::endl;
-    std::cout << "Total length: " << std::fixed << std::setprecision(6) << totalLength << std::endl;
-    std::cout << "Current threshold: " << minPathLength << std::endl;
+    SPRAY_LOG_INFO << "\n=== Path Length Statistics ===";
+    SPRAY_LOG_INFO << "Total paths: " << lengths.size();
+    SPRAY_LOG_INFO << "Min length: " << std::fixed << std::setprecision(6) << minLength;
+    SPRAY_LOG_INFO << "Max length: " << std::fixed << std::setprecision(6) << maxLength;
+    SPRAY_LOG_INFO << "Average length: " << std::fixed << std::setprecision(6) << avgLength;
+    SPRAY_LOG_INFO << "Total length: " << std::fixed << std::setprecision(6) << totalLength;
+    SPRAY_LOG_INFO << "Current threshold: " << minPathLength;
 
     // 计算会被过滤的路径数量
     int filteredCount = 0;
@@ -569,11 +597,11 @@ void FaceProcessor::printPathLengthStatistics() const {
         }
     }
 
-    std::cout << "Paths that would be filtered: " << filteredCount
-              << " (" << (100.0 * filteredCount / lengths.size()) << "%)" << std::endl;
+    SPRAY_LOG_INFO << "Paths that would be filtered: " << filteredCount
+                   << " (" << (100.0 * filteredCount / lengths.size()) << "%)";
 
     std::string units = detectUnits();
-    std::cout << "Detected units: " << units << std::endl;
+    SPRAY_LOG_INFO << "Detected units: " << units;
 }
 
 
@@ -594,8 +622,10 @@ void FaceProcessor::printPathLengthStatistics() const {
 
 // 整合轨迹 - 将多条分散的路径整合为连续的喷涂轨迹
 bool FaceProcessor::integrateTrajectories() {
+    SPRAY_PROFILE_SCOPE("paths.integrateTrajectories");
+
     if (generatedPaths.empty()) {
-        std::cerr << "没有可用的路径进行整合" << std::endl;
+        SPRAY_LOG_WARN << "没有可用的路径进行整合";
         return false;
     }
 
@@ -606,7 +636,8 @@ bool FaceProcessor::integrateTrajectories() {
     // 按切割平面分组路径
     groupPathsByPlane();
 
-    std::cout << "开始整合 " << generatedPaths.size() << " 条路径..." << std::endl;
+    SPRAY_LOG_INFO << "开始整合 " << generatedPaths.size() << " 条路径...";
+    SPRAY_COUNTER_ADD("paths.trajectoriesIntegrated", static_cast<long long>(integratedTrajectories.size()));
     return !integratedTrajectories.empty();
 }
 
@@ -622,114 +653,105 @@ const std::vector<IntegratedTrajectory>& FaceProcessor::getIntegratedTrajectorie
 
 
 
-// 将路径转换为VTK PolyData用于可视化
-vtkSmartPointer<vtkPolyData> FaceProcessor::pathsToPolyData(bool onlySprayPaths) const {
-    auto polyData = vtkSmartPointer<vtkPolyData>::New();
-    auto points = vtkSmartPointer<vtkPoints>::New();
-    auto cells = vtkSmartPointer<vtkCellArray>::New();
-
-    // 创建一个数组用于存储路径索引（可用于颜色映射）
-    auto pathIdArray = vtkSmartPointer<vtkDoubleArray>::New();
-    pathIdArray->SetName("PathIndex");
-
-    // 创建一个数组用于存储是否为喷涂点
-    auto sprayPointArray = vtkSmartPointer<vtkDoubleArray>::New();
-    sprayPointArray->SetName("IsSprayPoint");
-
-    // 创建一个数组用于存储法向量
-    auto normalArray = vtkSmartPointer<vtkDoubleArray>::New();
-    normalArray->SetNumberOfComponents(3);
-    normalArray->SetName("Normals");
-
-    // 添加颜色数组，使所有路径都可见
-    auto colorArray = vtkSmartPointer<vtkUnsignedCharArray>::New();
-    colorArray->SetNumberOfComponents(3);
-    colorArray->SetName("Colors");
-
-    int pointIndex = 0;
-
-    // 遍历每一条喷涂路径
-    for (const auto& path : generatedPaths) {
-        std::vector<vtkIdType> pointIds;
-
-        // 检查是否有足够的点创建路径
-        if (path.points.size() < 2) {
-            continue;  // 跳过少于2个点的路径
+// 写入一条路径/轨迹的点属性：坐标、法向量、所属索引、喷涂标记与颜色（喷涂点绿色，非喷涂点橙色）
+static void writePathPoints(PolyDataBatchBuilder& builder, vtkIdType index, const std::vector<PathPoint>& points,
+                            double ownerIndex, bool onlySprayPoints, int ownerArray, int sprayArray) {
+    for (const PathPoint& point : points) {
+        if (onlySprayPoints && !point.isSprayPoint) {
+            continue;
         }
+        builder.setPoint(index, point.position.X(), point.position.Y(), point.position.Z());
+        builder.setNormal(index, point.normal.X(), point.normal.Y(), point.normal.Z());
+        builder.setScalar(ownerArray, index, ownerIndex);
+        builder.setScalar(sprayArray, index, point.isSprayPoint ? 1.0 : 0.0);
+        if (point.isSprayPoint) {
+            builder.setColor(index, 0, 255, 0);
+        } else {
+            builder.setColor(index, 255, 165, 0);
+        }
+        index++;
+    }
+}
 
-        // 处理路径中的点
-        for (size_t i = 0; i < path.points.size(); ++i) {
-            // 如果只显示喷涂路径且当前点不是喷涂点，则跳过
-            if (onlySprayPaths && !path.points[i].isSprayPoint) {
-                continue;
-            }
-
-            const auto& point = path.points[i];
-            points->InsertNextPoint(point.position.X(), point.position.Y(), point.position.Z());
-            pointIds.push_back(pointIndex);
-
-            // 存储法向量
-            double normal[3] = {point.normal.X(), point.normal.Y(), point.normal.Z()};
-            normalArray->InsertNextTuple(normal);
-
-            // 存储路径索引
-            pathIdArray->InsertNextValue(path.pathIndex);
-
-            // 存储是否为喷涂点
-            sprayPointArray->InsertNextValue(point.isSprayPoint ? 1.0 : 0.0);
+// 设置可视化数据是否使用单精度（点坐标、法向量与标量数组）
+void FaceProcessor::setSinglePrecisionPolyData(bool enabled) {
+    singlePrecisionPolyData = enabled;
+}
 
-            // 为每个点添加颜色 - 根据是否为喷涂点区分
-            if (point.isSprayPoint) {
-                // 喷涂点使用统一的绿色
-                colorArray->InsertNextTuple3(0, 255, 0);  // 纯绿色
-            } else {
-                // 非喷涂点使用橙色
-                colorArray->InsertNextTuple3(255, 165, 0);  // 橙色
+// 将路径转换为VTK PolyData用于可视化
+// 先统计每条路径输出的点数，再由批量构造器一次分配全部数组、按路径并行写入
+vtkSmartPointer<vtkPolyData> FaceProcessor::pathsToPolyData(bool onlySprayPaths) const {
+    SPRAY_PROFILE_SCOPE("paths.pathsToPolyData");
+
+    PolyDataBatchBuilder builder(PolyDataBatchBuilder::PolyLines, singlePrecisionPolyData);
+    const int pathIdArray = builder.addScalarArray("PathIndex");    // 路径索引（可用于颜色映射）
+    const int sprayArray = builder.addScalarArray("IsSprayPoint");  // 是否为喷涂点
+    builder.enableNormals();
+    builder.enableColors();
+
+    // 第一遍：统计各路径输出的点数（少于2个点的路径跳过）
+    builder.setBatchCount(generatedPaths.size());
+    for (size_t p = 0; p < generatedPaths.size(); ++p) {
+        const SprayPath& path = generatedPaths[p];
+        vtkIdType count = 0;
+        if (path.points.size() >= 2) {
+            for (const PathPoint& point : path.points) {
+                // 如果只显示喷涂路径，跳过非喷涂点
+                if (!onlySprayPaths || point.isSprayPoint) {
+                    count++;
+                }
             }
-
-            pointIndex++;
         }
+        builder.setBatchPointCount(p, count);
+    }
+    builder.allocate();
 
-        // 关键修改：为每条路径单独创建一个polyLine，并立即添加到cells中
-        // 这样不同路径之间就不会连接在一起
-        if (pointIds.size() >= 2) {
-            vtkSmartPointer<vtkPolyLine> polyLine = vtkSmartPointer<vtkPolyLine>::New();
-            polyLine->GetPointIds()->SetNumberOfIds(pointIds.size());
-            for (size_t i = 0; i < pointIds.size(); ++i) {
-                polyLine->GetPointIds()->SetId(i, pointIds[i]);
-            }
-            cells->InsertNextCell(polyLine);
+    // 第二遍：每条路径单独一条折线，不同路径之间不会连接在一起
+    builder.forEachBatch([&](size_t p) {
+        if (builder.batchPointCount(p) > 0) {
+            writePathPoints(builder, builder.batchBegin(p), generatedPaths[p].points, generatedPaths[p].pathIndex,
+                            onlySprayPaths, pathIdArray, sprayArray);
         }
-    }
+    });
+    return builder.build();
+}
 
-    polyData->SetPoints(points);
-    polyData->SetLines(cells);
-    polyData->GetPointData()->AddArray(pathIdArray);
-    polyData->GetPointData()->AddArray(sprayPointArray);
-    polyData->GetPointData()->SetNormals(normalArray);
-    polyData->GetPointData()->SetScalars(colorArray); // 设置颜色为标量数据，这样VTK会使用这些颜色渲染
+// HSV转RGB（h为角度，s、v在0-1之间）
+static void hsvToRgb(float hue, float saturation, float value, unsigned char rgb[3]) {
+    float h = hue / 60.0f;
+    int hi = (int)floor(h);
+    float f = h - hi;
+    float p = value * (1.0f - saturation);
+    float q = value * (1.0f - saturation * f);
+    float t = value * (1.0f - saturation * (1.0f - f));
+
+    float r, g, b;
+    switch (hi) {
+        case 0: r = value; g = t; b = p; break;
+        case 1: r = q; g = value; b = p; break;
+        case 2: r = p; g = value; b = t; break;
+        case 3: r = p; g = q; b = value; break;
+        case 4: r = t; g = p; b = value; break;
+        default: r = value; g = p; b = q; break;
+    }
 
-    return polyData;
+    rgb[0] = (unsigned char)(r * 255);
+    rgb[1] = (unsigned char)(g * 255);
+    rgb[2] = (unsigned char)(b * 255);
 }
 
-// 将切割平面转换为VTK PolyData用于可视化
+// 将切割平面转换为VTK PolyData用于可视化（每个平面一个覆盖模型包围盒投影范围的四边形）
 vtkSmartPointer<vtkPolyData> FaceProcessor::cuttingPlanesToPolyData() const {
-    auto polyData = vtkSmartPointer<vtkPolyData>::New();
-    auto points = vtkSmartPointer<vtkPoints>::New();
-    auto cells = vtkSmartPointer<vtkCellArray>::New();
-
-    // 创建一个数组用于存储平面索引
-    auto planeIdArray = vtkSmartPointer<vtkDoubleArray>::New();
-    planeIdArray->SetName("PlaneIndex");
+    SPRAY_PROFILE_SCOPE("paths.cuttingPlanesToPolyData");
 
-    // 创建一个颜色数组
-    auto colorArray = vtkSmartPointer<vtkUnsignedCharArray>::New();
-    colorArray->SetNumberOfComponents(3);
-    colorArray->SetName("Colors");
+    PolyDataBatchBuilder builder(PolyDataBatchBuilder::Quads, singlePrecisionPolyData);
+    const int planeIdArray = builder.addScalarArray("PlaneIndex");  // 平面索引
+    builder.enableColors();
 
     // 如果没有切割平面，返回空的PolyData
     if (cuttingPlanes.empty()) {
-        return polyData;
+        builder.allocate();
+        return builder.build();
     }
 
     // 计算边界盒以确定平面的大小
@@ -737,15 +759,22 @@ vtkSmartPointer<vtkPolyData> FaceProcessor::cuttingPlanesToPolyData() const {
     BRepBndLib::Add(inputFaces, boundingBox);
 
     if (boundingBox.IsVoid()) {
-        std::cerr << "无法计算形状的包围盒" << std::endl;
-        return polyData;
+        SPRAY_LOG_WARN << "无法计算形状的包围盒";
+        builder.allocate();
+        return builder.build();
     }
 
     double xMin, yMin, zMin, xMax, yMax, zMax;
     boundingBox.Get(xMin, yMin, zMin, xMax, yMax, zMax);
 
-    // 为每个切割平面创建一个矩形
+    builder.setBatchCount(cuttingPlanes.size());
     for (size_t i = 0; i < cuttingPlanes.size(); i++) {
+        builder.setBatchPointCount(i, 4);
+    }
+    builder.allocate();
+
+    // 为每个切割平面创建一个矩形
+    builder.forEachBatch([&](size_t i) {
         const gp_Pln& plane = cuttingPlanes[i];
 
         // 获取平面原点和法向量
@@ -786,68 +815,20 @@ vtkSmartPointer<vtkPolyData> FaceProcessor::cuttingPlanesToPolyData() const {
         gp_Pnt p3 = origin.Translated(gp_Vec(xDir) * maxX + gp_Vec(yDir) * maxY);
         gp_Pnt p4 = origin.Translated(gp_Vec(xDir) * minX + gp_Vec(yDir) * maxY);
 
-        // 添加四个点
-        vtkIdType pid1 = points->InsertNextPoint(p1.X(), p1.Y(), p1.Z());
-        vtkIdType pid2 = points->InsertNextPoint(p2.X(), p2.Y(), p2.Z());
-        vtkIdType pid3 = points->InsertNextPoint(p3.X(), p3.Y(), p3.Z());
-        vtkIdType pid4 = points->InsertNextPoint(p4.X(), p4.Y(), p4.Z());
-
-        // 创建两个三角形组成一个矩形
-        vtkSmartPointer<vtkTriangle> triangle1 = vtkSmartPointer<vtkTriangle>::New();
-        triangle1->GetPointIds()->SetId(0, pid1);
-        triangle1->GetPointIds()->SetId(1, pid2);
-        triangle1->GetPointIds()->SetId(2, pid3);
-
-        vtkSmartPointer<vtkTriangle> triangle2 = vtkSmartPointer<vtkTriangle>::New();
-        triangle2->GetPointIds()->SetId(0, pid1);
-        triangle2->GetPointIds()->SetId(1, pid3);
-        triangle2->GetPointIds()->SetId(2, pid4);
-
-        cells->InsertNextCell(triangle1);
-        cells->InsertNextCell(triangle2);
-
-        // 为所有点添加平面索引和颜色
-        for (int j = 0; j < 4; j++) {
-            planeIdArray->InsertNextValue(i);
-
-            // 使用HSV颜色空间为每个平面生成不同的颜色
-            float hue = (i * 20) % 360; // 每个平面的色调间隔20度
-            float saturation = 0.7f;
-            float value = 0.7f; // 稍微暗一点，让平面半透明时更易于区分
-
-            // HSV转RGB
-            float h = hue / 60.0f;
-            int hi = (int)floor(h);
-            float f = h - hi;
-            float p = value * (1.0f - saturation);
-            float q = value * (1.0f - saturation * f);
-            float t = value * (1.0f - saturation * (1.0f - f));
-
-            float r, g, b;
-            switch (hi) {
-                case 0: r = value; g = t; b = p; break;
-                case 1: r = q; g = value; b = p; break;
-                case 2: r = p; g = value; b = t; break;
-                case 3: r = p; g = q; b = value; break;
-                case 4: r = t; g = p; b = value; break;
-                default: r = value; g = p; b = q; break;
-            }
-
-            unsigned char rgb[3] = {
-                (unsigned char)(r * 255),
-                (unsigned char)(g * 255),
-                (unsigned char)(b * 255)
-            };
-            colorArray->InsertNextTuple3(rgb[0], rgb[1], rgb[2]);
+        // 写入四个角点；颜色每个平面只计算一次
+        // 使用HSV颜色空间为每个平面生成不同的颜色：色调间隔20度，稍微暗一点，让平面半透明时更易于区分
+        unsigned char rgb[3];
+        hsvToRgb(static_cast<float>((i * 20) % 360), 0.7f, 0.7f, rgb);
+        const gp_Pnt corners[4] = { p1, p2, p3, p4 };
+        vtkIdType index = builder.batchBegin(i);
+        for (const gp_Pnt& corner : corners) {
+            builder.setPoint(index, corner.X(), corner.Y(), corner.Z());
+            builder.setScalar(planeIdArray, index, static_cast<double>(i));
+            builder.setColor(index, rgb[0], rgb[1], rgb[2]);
+            index++;
         }
-    }
-
-    polyData->SetPoints(points);
-    polyData->SetPolys(cells);
-    polyData->GetPointData()->AddArray(planeIdArray);
-    polyData->GetPointData()->SetScalars(colorArray);
-
-    return polyData;
+    });
+    return builder.build();
 }
 
 // 按切割平面分组路径
@@ -884,7 +865,7 @@ void FaceProcessor::groupPathsByPlane() {
         }
     }
 
-    std::cout << "整合完成，生成了 " << integratedTrajectories.size() << " 条整合轨迹" << std::endl;
+    SPRAY_LOG_INFO << "整合完成，生成了 " << integratedTrajectories.size() << " 条整合轨迹";
 }
 
 // 对平面内的路径进行排序，使相邻路径尽可能接近
@@ -1085,84 +1066,32 @@ void FaceProcessor::optimizeTrajectoryDirection(IntegratedTrajectory& trajectory
     // 例如：最小化总的移动距离、考虑喷涂方向等
 }
 
-// 将整合后的轨迹转换为VTK PolyData用于可视化
+// 将整合后的轨迹转换为VTK PolyData用于可视化（每条轨迹一条连续的折线）
 vtkSmartPointer<vtkPolyData> FaceProcessor::integratedTrajectoriesToPolyData() const {
-    auto polyData = vtkSmartPointer<vtkPolyData>::New();
-    auto points = vtkSmartPointer<vtkPoints>::New();
-    auto cells = vtkSmartPointer<vtkCellArray>::New();
-
-    // 创建数组用于存储轨迹信息
-    auto trajectoryIdArray = vtkSmartPointer<vtkDoubleArray>::New();
-    trajectoryIdArray->SetName("TrajectoryIndex");
-
-    auto sprayPointArray = vtkSmartPointer<vtkDoubleArray>::New();
-    sprayPointArray->SetName("IsSprayPoint");
-
-    auto normalArray = vtkSmartPointer<vtkDoubleArray>::New();
-    normalArray->SetNumberOfComponents(3);
-    normalArray->SetName("Normals");
-
-    auto colorArray = vtkSmartPointer<vtkUnsignedCharArray>::New();
-    colorArray->SetNumberOfComponents(3);
-    colorArray->SetName("Colors");
-
-    int pointIndex = 0;
-
-    // 遍历每条整合轨迹
-    for (const auto& trajectory : integratedTrajectories) {
-        std::vector<vtkIdType> pointIds;
-
-        if (trajectory.points.size() < 2) {
-            continue;
-        }
-
-        // 处理轨迹中的点
-        for (size_t i = 0; i < trajectory.points.size(); ++i) {
-            const auto& point = trajectory.points[i];
-            points->InsertNextPoint(point.position.X(), point.position.Y(), point.position.Z());
-            pointIds.push_back(pointIndex);
-
-            // 存储法向量
-            double normal[3] = {point.normal.X(), point.normal.Y(), point.normal.Z()};
-            normalArray->InsertNextTuple(normal);
-
-            // 存储轨迹索引
-            trajectoryIdArray->InsertNextValue(trajectory.trajectoryIndex);
-
-            // 存储是否为喷涂点
-            sprayPointArray->InsertNextValue(point.isSprayPoint ? 1.0 : 0.0);
-
-            // 根据是否为喷涂点设置颜色
-            if (point.isSprayPoint) {
-                // 所有喷涂点使用统一的绿色
-                colorArray->InsertNextTuple3(0, 255, 0);  // 纯绿色
-            } else {
-                // 非喷涂路径（连接/过渡段）使用橙色
-                colorArray->InsertNextTuple3(255, 165, 0);  // 橙色
-            }
-
-            pointIndex++;
-        }
-
-        // 为整条轨迹创建一个连续的polyLine
-        if (pointIds.size() >= 2) {
-            vtkSmartPointer<vtkPolyLine> polyLine = vtkSmartPointer<vtkPolyLine>::New();
-            polyLine->GetPointIds()->SetNumberOfIds(pointIds.size());
-            for (size_t i = 0; i < pointIds.size(); ++i) {
-                polyLine->GetPointIds()->SetId(i, pointIds[i]);
-            }
-            cells->InsertNextCell(polyLine);
-        }
+    SPRAY_PROFILE_SCOPE("paths.integratedTrajectoriesToPolyData");
+
+    PolyDataBatchBuilder builder(PolyDataBatchBuilder::PolyLines, singlePrecisionPolyData);
+    const int trajectoryIdArray = builder.addScalarArray("TrajectoryIndex");
+    const int sprayArray = builder.addScalarArray("IsSprayPoint");
+    builder.enableNormals();
+    builder.enableColors();
+
+    // 少于2个点的轨迹跳过
+    builder.setBatchCount(integratedTrajectories.size());
+    for (size_t t = 0; t < integratedTrajectories.size(); ++t) {
+        const size_t count = integratedTrajectories[t].points.size();
+        builder.setBatchPointCount(t, count >= 2 ? static_cast<vtkIdType>(count) : 0);
     }
+    builder.allocate();
 
-    polyData->SetPoints(points);
-    polyData->SetLines(cells);
-    polyData->GetPointData()->AddArray(trajectoryIdArray);
-    polyData->GetPointData()->AddArray(sprayPointArray);
-    polyData->GetPointData()->SetNormals(normalArray);
-    polyData->GetPointData()->SetScalars(colorArray);
-
-    return polyData;
+    // 非喷涂点（连接/过渡段）使用橙色
+    builder.forEachBatch([&](size_t t) {
+        if (builder.batchPointCount(t) > 0) {
+            writePathPoints(builder, builder.batchBegin(t), integratedTrajectories[t].points,
+                            integratedTrajectories[t].trajectoryIndex, false, trajectoryIdArray, sprayArray);
+        }
+    });
+    return builder.build();
 }
 
 // 获取表面层级信息
@@ -1170,19 +1099,65 @@ const std::vector<SurfaceLayer>& FaceProcessor::getSurfaceLayers() const {
     return surfaceLayers;
 }
 
+// 保存喷涂程序文件
+bool FaceProcessor::saveProgram(const std::string& filename, bool compress) const {
+    TrajectoryFileWriter writer(compress);
+    if (!writer.open(filename)) {
+        return false;
+    }
+    for (const SprayPath& path : generatedPaths) {
+        if (!writer.writePath(path)) return false;
+    }
+    for (const IntegratedTrajectory& trajectory : integratedTrajectories) {
+        if (!writer.writeTrajectory(trajectory)) return false;
+    }
+    for (const SurfaceLayer& layer : surfaceLayers) {
+        if (!writer.writeSurfaceLayer(layer)) return false;
+    }
+    if (!writer.close()) {
+        return false;
+    }
+    SPRAY_LOG_INFO << "💾 已保存喷涂程序: " << filename << "（" << generatedPaths.size() << " 条路径，"
+                   << integratedTrajectories.size() << " 条轨迹）";
+    return true;
+}
+
+// 读取喷涂程序文件
+bool FaceProcessor::loadProgram(const std::string& filename) {
+    TrajectoryFileReader reader;
+    std::vector<SprayPath> paths;
+    std::vector<IntegratedTrajectory> trajectories;
+    std::vector<SurfaceLayer> layers;
+    if (!reader.open(filename) || !reader.readAll(paths, trajectories, layers)) {
+        SPRAY_LOG_ERROR << "❌ 读取喷涂程序失败: " << filename;
+        return false;
+    }
+
+    generatedPaths = std::move(paths);
+    integratedTrajectories = std::move(trajectories);
+    surfaceLayers = std::move(layers);
+    connectionPaths.clear();
+    pathVisibility.clear();
+    SPRAY_LOG_INFO << "📂 已读取喷涂程序: " << filename << "（" << generatedPaths.size() << " 条路径，"
+                   << integratedTrajectories.size() << " 条轨迹）";
+    return true;
+}
+
 // 面级别可见性分析
 bool FaceProcessor::analyzeFaceVisibility() {
-    std::cout << "开始面级别可见性分析..." << std::endl;
+    SPRAY_PROFILE_SCOPE("paths.analyzeFaceVisibility");
+
+    SPRAY_LOG_INFO << "开始面级别可见性分析...";
 
     // 1. 从输入形状中提取所有面
     extractFacesFromShape();
 
     if (faceVisibility.empty()) {
-        std::cerr << "没有找到可分析的面" << std::endl;
+        SPRAY_LOG_WARN << "没有找到可分析的面";
         return false;
     }
 
-    std::cout << "提取了 " << faceVisibility.size() << " 个面进行可见性分析" << std::endl;
+    SPRAY_LOG_INFO << "提取了 " << faceVisibility.size() << " 个面进行可见性分析";
 
     // 2. 计算面的深度
     calculateFaceDepths();
@@ -1200,31 +1175,38 @@ bool FaceProcessor::analyzeFaceVisibility() {
         }
     }
 
-    std::cout << "可见性分析完成，识别出 " << visibleCount << " 个可见面（共 "
-              << faceVisibility.size() << " 个面）" << std::endl;
+    SPRAY_LOG_INFO << "可见性分析完成，识别出 " << visibleCount << " 个可见面（共 "
+                   << faceVisibility.size() << " 个面）";
 
     return visibleCount > 0;
 }
 
 // 路径级别可见性分析
-bool FaceProcessor::analyzePathVisibility() {
+bool FaceProcessor::analyzePathVisibility(const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("paths.analyzePathVisibility");
+
     if (generatedPaths.empty()) {
-        std::cerr << "没有可用的路径进行可见性分析" << std::endl;
+        SPRAY_LOG_WARN << "没有可用的路径进行可见性分析";
         return false;
     }
 
-    std::cout << "开始路径级别可见性分析..." << std::endl;
+    SPRAY_LOG_INFO << "开始路径级别可见性分析...";
 
     // 1. 计算路径深度
     calculatePathDepths();
 
     // 2. 检测路径遮挡
-    detectOcclusions();
+    detectOcclusions(range);
+    if (range.UserBreak()) {
+        SPRAY_LOG_INFO << "⏹️ 已取消路径可见性分析";
+        surfaceLayers.clear();
+        return false;
+    }
 
     // 3. 分类表面层级
     classifySurfaceLayers();
 
-    std::cout << "路径可见性分析完成，识别出 " << surfaceLayers.size() << " 个表面层级" << std::endl;
+    SPRAY_LOG_INFO << "路径可见性分析完成，识别出 " << surfaceLayers.size() << " 个表面层级";
 
     return !surfaceLayers.empty();
 }
@@ -1304,34 +1286,12 @@ gp_Pnt FaceProcessor::calculateFaceCenter(const TopoDS_Face& face) {
     return props.CentreOfMass();
 }
 
-// 计算面的法向量
+// 计算面的法向量（面积加权平均，已考虑面的拓扑方向）
 gp_Dir FaceProcessor::calculateFaceNormal(const TopoDS_Face& face) {
-    // 获取面的几何表面
-    Handle(Geom_Surface) surface = BRep_Tool::Surface(face);
-    if (surface.IsNull()) {
-        return gp_Dir(0, 0, 1);  // 默认法向量
-    }
-
-    // 在面的中心计算法向量
-    gp_Pnt center = calculateFaceCenter(face);
-
-    // 获取面的参数范围
-    double uMin, uMax, vMin, vMax;
-    BRepTools::UVBounds(face, uMin, uMax, vMin, vMax);
-
-    double u = (uMin + uMax) / 2.0;
-    double v = (vMin + vMax) / 2.0;
-
-    gp_Pnt point;
-    gp_Vec du, dv;
-    surface->D1(u, v, point, du, dv);
-
-    gp_Vec normal = du.Crossed(dv);
-    if (normal.Magnitude() > 1e-10) {
-        normal.Normalize();
-        return gp_Dir(normal.X(), normal.Y(), normal.Z());
+    gp_Dir normal;
+    if (faceNormalService->normal(face, normal)) {
+        return normal;
     }
-
     return gp_Dir(0, 0, 1);  // 默认法向量
 }
 
@@ -1373,8 +1333,9 @@ void FaceProcessor::calculatePathDepths() {
 }
 
 // 检测路径遮挡
-void FaceProcessor::detectOcclusions() {
-    for (size_t i = 0; i < generatedPaths.size(); i++) {
+void FaceProcessor::detectOcclusions(const Message_ProgressRange& range) {
+    Message_ProgressScope scope(range, "路径遮挡检测", static_cast<Standard_Real>(generatedPaths.size()));
+    for (size_t i = 0; i < generatedPaths.size() && scope.More(); i++, scope.Next()) {
         auto& visibility = pathVisibility[i];
 
         for (size_t j = 0; j < generatedPaths.size(); j++) {
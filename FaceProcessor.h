@@ -8,8 +8,13 @@
 #include <gp_Dir.hxx>
 #include <gp_Pln.hxx>
 #include <gp_Pnt.hxx>
+#include <Message_ProgressRange.hxx>
+#include <memory>
+#include <string>
 #include <vector>
 
+class FaceNormalService;
+
 // 路径点数据结构
 struct PathPoint {
     gp_Pnt position;     // 点的位置
@@ -91,6 +96,9 @@ public:
     // 设置最小路径长度
     void setMinPathLength(double minLength);
 
+    // 设置面法向量服务（与OCCHandler共享时复用已计算的法向量）
+    void setFaceNormalService(const std::shared_ptr<FaceNormalService>& service);
+
     // 自动检测并调整单位
     void autoDetectAndAdjustUnits();
 
@@ -99,8 +107,8 @@ public:
     // 生成切割平面
     bool generateCuttingPlanes();
 
-    // 生成路径
-    bool generatePaths();
+    // 生成路径（按切割平面报告进度，取消时清空路径并返回false）
+    bool generatePaths(const Message_ProgressRange& range = Message_ProgressRange());
 
     // 整合轨迹 - 将多条分散的路径整合为连续的喷涂轨迹
     bool integrateTrajectories();
@@ -115,11 +123,20 @@ public:
     bool analyzeFaceVisibility();
 
     // 路径级别可见性分析 - 分析路径的可见性和层级
-    bool analyzePathVisibility();
+    bool analyzePathVisibility(const Message_ProgressRange& range = Message_ProgressRange());
 
     // 获取表面层级信息
     const std::vector<SurfaceLayer>& getSurfaceLayers() const;
 
+    // 将路径、整合轨迹与表面层级保存为喷涂程序文件（格式见TrajectoryFile.h）
+    bool saveProgram(const std::string& filename, bool compress = false) const;
+
+    // 读取喷涂程序文件，替换当前的路径、整合轨迹与表面层级（之后可直接生成可视化数据）
+    bool loadProgram(const std::string& filename);
+
+    // 设置可视化数据是否使用单精度（点坐标、法向量与标量数组，上传GPU的数据量减半；默认双精度）
+    void setSinglePrecisionPolyData(bool enabled);
+
     // 将路径转换为VTK PolyData用于可视化
     vtkSmartPointer<vtkPolyData> pathsToPolyData(bool onlySprayPaths = true) const;
 
@@ -158,6 +175,8 @@ private:
     std::vector<SurfaceLayer> surfaceLayers; // 表面层级信息
     std::vector<FaceVisibilityInfo> faceVisibility; // 面的可见性信息
     std::vector<TopoDS_Face> visibleFaces; // 可见的面
+    std::shared_ptr<FaceNormalService> faceNormalService; // 面法向量缓存
+    bool singlePrecisionPolyData;    // 可视化数据是否使用单精度
 
     // 获取面的包围盒
     bool getFaceBoundingBox(const TopoDS_Face& face, double& xMin, double& yMin, double& zMin,
@@ -197,7 +216,7 @@ private:
 
     // 路径级别可见性分析方法
     void calculatePathDepths();
-    void detectOcclusions();
+    void detectOcclusions(const Message_ProgressRange& range = Message_ProgressRange());
     void classifySurfaceLayers();
     bool isPathOccluded(int pathIndex, int candidateOccluderIndex);
     double calculateOcclusionRatio(const SprayPath& occludedPath, const SprayPath& occluderPath);
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <functional>
 #include <iostream>
 
 // OCCT includes
@@ -17,6 +19,94 @@
 #include <TopoDS_Shell.hxx>
 #include <TopTools_ListOfShape.hxx>
 #include <gp_Dir.hxx>
+#include <gp_Trsf.hxx>
+#include <Bnd_Box.hxx>
+#include <Message_ProgressRange.hxx>
+
+class OcclusionCache;
+class ShapeCache;
+class STEPControl_Reader;
+class RepairContext;
+class BRepTools_ReShape;
+class FaceNormalService;
+
+// 三角剖分的线性偏差（显示与BREP缓存共用，保证缓存中的剖分可以直接用于显示）
+static const double OCC_MESH_DEFLECTION = 0.5;
+
+// 面法向量（按分量分开存放的连续数组，便于对多个方向批量计算点积）
+struct FaceNormalArrays {
+    std::vector<double> x;              // 法向量X分量
+    std::vector<double> y;              // 法向量Y分量
+    std::vector<double> z;              // 法向量Z分量
+    std::vector<unsigned char> valid;   // 是否成功计算法向量（失败的面不参与分类）
+};
+
+// 并行转换STEP时单个根实体的耗时记录
+struct StepRootTiming {
+    int rootIndex = 0;      // 根实体序号（从1开始）
+    std::string name;       // 产品名称（无法获取时为实体类型与标签）
+    double seconds = 0.0;   // 转换耗时（秒）
+    int shapeCount = 0;     // 转换得到的形状数量
+};
+
+// STEP文件中的根实体（产品）信息
+struct StepProductInfo {
+    int rootIndex = 0;      // 根实体序号（从1开始，用于选择性加载）
+    std::string name;       // 产品名称（可能为空）
+    std::string entityType; // STEP实体类型
+    std::string label;      // 实体标签（如 #123）
+};
+
+// STEP选择性加载的范围（默认加载全部）
+struct StepLoadSelection {
+    std::vector<int> rootIndices;  // 只转换这些根实体（从1开始，为空时转换全部）
+    bool useRegion = false;        // 是否按关注区域筛选
+    Bnd_Box region;                // 关注区域（文件坐标系，移动到原点之前）
+
+    // BREP缓存键中的选择标签
+    std::string tag() const;
+};
+
+// 修复前的快速诊断结果（见 OCCHandler::diagnoseForRepair）
+struct RepairDiagnosis {
+    bool valid = false;             // BRepCheck_Analyzer是否判定有效
+    int solidCount = 0;             // 实体数量
+    int freeShellCount = 0;         // 不属于实体的壳数量
+    int freeFaceCount = 0;          // 不属于壳的面数量
+    int faceCount = 0;              // 面数量
+    int wireCount = 0;              // 线框数量
+    int smallInnerWireCount = 0;    // 面积小于内部线框移除阈值（容差的平方）的内环数量
+    int closedFreeBoundCount = 0;   // 封闭自由边界数量
+    int openFreeBoundCount = 0;     // 开放自由边界数量
+    int freeEdgeCount = 0;          // 自由边数量
+    int sewnFreeBoundCount = 0;     // 按修复容差缝合后的自由边界数量（封闭与开放）
+    int sewnFreeEdgeCount = 0;      // 按修复容差缝合后的自由边数量
+    double maxTolerance = 0.0;      // 最大容差
+    double averageTolerance = 0.0;  // 平均容差
+    int overToleranceCount = 0;     // 容差超过上限（修复容差的100倍）的子形状数量
+
+    // 计划执行的修复操作
+    bool needsSewing = false;              // 缝合
+    bool needsShapeFix = false;            // ShapeFix_Shape 形状修复
+    bool needsInternalWireRemoval = false; // 移除微小内部线框
+    bool needsToleranceLimit = false;      // 限制容差
+
+    // 是否不需要任何修复操作
+    bool isClean() const;
+};
+
+// 计划修复中执行的单个操作
+struct RepairOperatorRun {
+    std::string name;       // 操作名称
+    double seconds = 0.0;   // 耗时（秒）
+    bool changed = false;   // 是否修改了模型
+};
+
+// 计划修复的诊断与执行记录
+struct RepairPlanReport {
+    RepairDiagnosis diagnosis;                 // 修复前的诊断
+    std::vector<RepairOperatorRun> operators;  // 按执行顺序的操作（分区修复时为空）
+};
 
 class OCCHandler {
 public:
@@ -24,7 +114,27 @@ public:
     ~OCCHandler();
 
     // 加载STEP文件，返回是否成功，可选择是否移动到原点和是否自动修复
-    bool loadStepFile(const std::string& filename, bool moveToOrigin = false, bool autoRepair = true);
+    // range: 进度与取消；取消时返回false并保留之前的模型
+    bool loadStepFile(const std::string& filename, bool moveToOrigin = false, bool autoRepair = true,
+                      const Message_ProgressRange& range = Message_ProgressRange());
+
+    // 列出STEP文件的根实体（只读取文件，不转换几何），用于选择性加载
+    bool listStepProducts(const std::string& filename, std::vector<StepProductInfo>& products) const;
+
+    // 只加载指定的根实体（序号见listStepProducts），其余根实体不转换也不修复
+    bool loadStepProducts(const std::string& filename, const std::vector<int>& rootIndices,
+                          bool moveToOrigin = false, bool autoRepair = true,
+                          const Message_ProgressRange& range = Message_ProgressRange());
+
+    // 只加载包围盒与关注区域相交的部分（装配体逐个子形状筛选），区域外的部分不修复
+    bool loadStepRegion(const std::string& filename, const Bnd_Box& region,
+                        bool moveToOrigin = false, bool autoRepair = true,
+                        const Message_ProgressRange& range = Message_ProgressRange());
+
+    // 按选择范围加载STEP文件（loadStepFile/loadStepProducts/loadStepRegion的通用形式）
+    bool loadStepSelection(const std::string& filename, const StepLoadSelection& selection,
+                           bool moveToOrigin = false, bool autoRepair = true,
+                           const Message_ProgressRange& range = Message_ProgressRange());
 
     // 获取当前模型
     TopoDS_Shape getShape() const;
@@ -36,6 +146,12 @@ public:
     // TopoDS_Shape转vtkPolyData（带参数）
     vtkSmartPointer<vtkPolyData> shapeToPolyData(const TopoDS_Shape& shape) const;
 
+    // B-rep边转vtkPolyData折线（每条边一个折线单元，由已有三角剖分上的边多边形离散）
+    vtkSmartPointer<vtkPolyData> shapeEdgesToPolyData() const;
+
+    // B-rep边转vtkPolyData折线（带参数）
+    vtkSmartPointer<vtkPolyData> shapeEdgesToPolyData(const TopoDS_Shape& shape) const;
+
     // 打印TopoDS_Shape结构（根据形状类型停止递归）
     void printShapeStructure(const TopoDS_Shape& shape = TopoDS_Shape(),
                             TopAbs_ShapeEnum stopAtType = TopAbs_SHAPE,
@@ -70,7 +186,16 @@ public:
     // direction: 参考方向
     // angleTolerance: 面法向量与参考方向的最大夹角（度）
     // returnExtracted: 如果为true则返回提取的面，否则返回剩余的面
-    TopoDS_Shape extractFacesByNormal(const gp_Dir& direction, double angleTolerance = 5.0, bool returnExtracted = true);
+    TopoDS_Shape extractFacesByNormal(const gp_Dir& direction, double angleTolerance = 5.0, bool returnExtracted = true,
+                                      const Message_ProgressRange& range = Message_ProgressRange());
+
+    // 面法向量服务（按TShape缓存面积加权法向量，可与FaceProcessor共享）
+    std::shared_ptr<FaceNormalService> getFaceNormalService() const;
+
+    // 按多个方向一次提取面（如 +Z、-Z、±X、±Y）：所有面的法向量只并行计算一次。
+    // 返回与directions顺序对应的复合体，某方向没有符合条件的面时为空形状
+    std::vector<TopoDS_Shape> extractFacesByNormals(const std::vector<gp_Dir>& directions, double angleTolerance = 5.0,
+                                                    const Message_ProgressRange& range = Message_ProgressRange());
 
 
 
@@ -83,8 +208,9 @@ public:
     // 使用缝合算法将面组合成shell
     TopoDS_Shape sewFacesToShells(const TopTools_ListOfShape& faces, double tolerance = 1.0) const;
 
-    // 按高度分层并进行遮挡裁剪
-    TopoDS_Shape removeOccludedPortions(const TopoDS_Shape& extractedFaces, double heightTolerance = 5.0);
+    // 按高度分层并进行遮挡裁剪（取消时返回空形状，不写入遮挡缓存）
+    TopoDS_Shape removeOccludedPortions(const TopoDS_Shape& extractedFaces, double heightTolerance = 5.0,
+                                        const Message_ProgressRange& range = Message_ProgressRange());
 
 
 
@@ -119,13 +245,33 @@ public:
     TopoDS_Shape moveShapeToPlane(const TopoDS_Shape& shape, double targetZ) const;
 
     // STEP导入后模型修复函数
-    bool repairImportedModel(double tolerance = 1e-6, bool verbose = true);
+    bool repairImportedModel(double tolerance = 1e-6, bool verbose = true,
+                             const Message_ProgressRange& range = Message_ProgressRange());
 
     // 增强的模型修复函数（基于OCCT 7.9）
-    bool enhancedModelRepair(double tolerance = 1e-6, bool verbose = true);
+    bool enhancedModelRepair(double tolerance = 1e-6, bool verbose = true,
+                             const Message_ProgressRange& range = Message_ProgressRange());
 
     // 针对喷涂轨迹优化的修复
-    bool sprayTrajectoryOptimizedRepair(double tolerance = 1e-3, bool verbose = true);
+    bool sprayTrajectoryOptimizedRepair(double tolerance = 1e-3, bool verbose = true,
+                                        const Message_ProgressRange& range = Message_ProgressRange());
+
+    // 修复前的快速诊断（一次分析，决定需要执行哪些修复操作）
+    RepairDiagnosis diagnoseForRepair(double tolerance = 1e-3) const;
+
+    // 按诊断结果只执行需要的修复操作（缝合、形状修复、移除内部线框、限制容差），有效的模型直接跳过；
+    // 异常或取消时恢复修复前的模型
+    bool repairWithPlan(double tolerance = 1e-3, bool verbose = true,
+                        const Message_ProgressRange& range = Message_ProgressRange());
+
+    // 最近一次计划修复的诊断与各操作耗时
+    const RepairPlanReport& getLastRepairReport() const;
+
+    // 设置修复上下文：修复后备链共享原始模型快照、诊断结果与缝合结果，后备修复从缝合结果继续（为空时各修复独立执行）
+    void setRepairContext(const std::shared_ptr<RepairContext>& context);
+
+    // 获取修复上下文
+    std::shared_ptr<RepairContext> getRepairContext() const;
 
     // 形状验证和分析
     bool validateAndAnalyzeShape(bool verbose = true);
@@ -145,8 +291,114 @@ public:
     // 专业级形状修复（包含详细分析和修复）
     bool professionalShapeHealing(double tolerance = 1e-6, bool verbose = true);
 
+    // 设置是否启用并行处理（遮挡裁剪的逐面布尔运算和线框逐面修复在线程池中并发执行，并开启OCCT内部并行）
+    void setParallelMode(bool enabled);
+
+    // 是否启用了并行处理
+    bool isParallelMode() const;
+
+    // 设置是否启用遮挡裁剪结果缓存（旋转或重新提取面后只重新裁剪遮挡关系变化的面）
+    void setOcclusionCacheEnabled(bool enabled);
+
+    // 清空遮挡裁剪结果缓存
+    void clearOcclusionCache();
+
+    // 设置BREP缓存目录（为空时关闭）：加载过的STEP文件按内容哈希与修复参数缓存修复后的形状和三角剖分
+    void setShapeCacheDirectory(const std::string& directory);
+
+    // 获取BREP缓存目录
+    std::string getShapeCacheDirectory() const;
+
+    // 设置是否并行转换STEP根实体（默认关闭；装配体根实体较多时加快加载；共享的零件会在各线程中分别转换）
+    // 需要OCCT 7.8及以上，更早的版本转换依赖全局状态，开启后仍按串行转换
+    void setParallelImport(bool enabled);
+
+    // 是否并行转换STEP根实体
+    bool isParallelImport() const;
+
+    // 最近一次并行转换的各根实体耗时（按根实体顺序）
+    const std::vector<StepRootTiming>& getStepRootTimings() const;
+
+    // 设置是否分区修复：多实体装配体按实体/壳/空间簇拆分，各部分并行执行同一修复流程后重新组装
+    // （实体之间不再互相缝合）
+    void setPartitionedRepair(bool enabled);
+
+    // 是否分区修复
+    bool isPartitionedRepair() const;
+
+    // 设置是否空间分区缝合：面数较多时先按网格分块并行预缝合，再做一次全局缝合
+    void setSpatialSewing(bool enabled);
+
+    // 是否空间分区缝合
+    bool isSpatialSewing() const;
+
 private:
     TopoDS_Shape shape;
+    bool parallelMode; // 是否启用并行处理
+    gp_Trsf modelTransform; // 加载后累计的整体变换（旋转/平移到原点）
+    bool occlusionCacheEnabled; // 是否启用遮挡裁剪结果缓存
+    std::shared_ptr<OcclusionCache> occlusionCache; // 遮挡裁剪结果缓存
+    std::shared_ptr<FaceNormalService> faceNormalService; // 面法向量缓存
+    std::shared_ptr<ShapeCache> shapeCache; // 加载并修复后模型的BREP缓存
+    bool parallelImport; // 是否并行转换STEP根实体
+    std::vector<StepRootTiming> stepRootTimings; // 最近一次并行转换的各根实体耗时
+    bool partitionedRepair; // 是否分区并行修复
+    bool spatialSewing; // 是否空间分区缝合
+    RepairPlanReport lastRepairReport; // 最近一次计划修复的记录
+    std::shared_ptr<RepairContext> repairContext; // 修复后备链共享的上下文
+
+    // 当前模型可用的上下文诊断结果，不可用时返回nullptr
+    const RepairDiagnosis* trackedRepairDiagnosis() const;
+
+    // 从上下文继续缝合，返回true时当前模型已替换为缝合结果，调用方跳过缝合
+    bool resumeSewingFromContext(double tolerance);
+
+    // 在上下文中记录对原始模型的缝合结果
+    void recordSewingInContext(double tolerance, const TopoDS_Shape& before, const TopoDS_Shape& sewed,
+                               const Handle(BRepTools_ReShape)& history);
+
+    // 计算当前模型所有面的法向量（并行、经缓存），faces按遍历顺序输出；取消时返回false
+    bool computeFaceNormals(std::vector<TopoDS_Face>& faces, FaceNormalArrays& normals,
+                            const Message_ProgressRange& range) const;
+
+    // 按一个方向分类面法向量：matches[i]为1表示夹角在容差内（无效法向量为0）
+    static void classifyFaceNormals(const FaceNormalArrays& normals, const gp_Dir& direction,
+                                    double cosAngleTolerance, unsigned char* matches);
+
+    // 缝合当前模型的全部面，失败或取消时返回空形状；history为缝合历史（分块缝合时为空）
+    TopoDS_Shape sewAllFaces(double tolerance, int& faceCount, Handle(BRepTools_ReShape)& history,
+                             const Message_ProgressRange& range) const;
+
+    // 单个部分的修复流程（在独立的处理器上执行）
+    typedef std::function<bool(OCCHandler& part, const Message_ProgressRange& range)> PartRepairFunction;
+
+    // 将模型拆分为可以独立修复的部分；不属于面的线框、边和顶点放入untouched
+    std::vector<TopoDS_Shape> partitionForRepair(double tolerance, std::vector<TopoDS_Shape>& untouched) const;
+
+    // 分区并行修复，只有一个部分时返回false（由调用方按原流程修复）；succeeded为修复结果
+    bool repairPartitioned(const char* name, double tolerance, bool verbose, const PartRepairFunction& repair,
+                           const Message_ProgressRange& range, bool& succeeded);
+
+    // 转换已读取的STEP模型的根实体（rootIndices为空时转换全部），按设置串行或并行
+    bool transferStepRoots(STEPControl_Reader& reader, const std::vector<int>& rootIndices,
+                           TopoDS_Shape& result, const Message_ProgressRange& range = Message_ProgressRange());
+
+    // 并行转换根实体，结果按根实体顺序组成复合体
+    bool transferStepRootsParallel(STEPControl_Reader& reader, const std::vector<int>& rootIndices,
+                                   TopoDS_Shape& result, const Message_ProgressRange& range = Message_ProgressRange());
+
+    // 按关注区域筛选形状，区域内没有形状时返回空形状
+    TopoDS_Shape filterShapeByRegion(const TopoDS_Shape& source, const Bnd_Box& region) const;
+
+    // 用所有更高层的面依次裁剪单个面，返回裁剪后剩余的面片（可能为空）
+    TopTools_ListOfShape cutFaceByUpperLayers(const TopoDS_Face& face,
+                                              const std::vector<std::pair<double, TopTools_ListOfShape>>& layers,
+                                              size_t layerIndex,
+                                              const Message_ProgressRange& range = Message_ProgressRange()) const;
+
+    // 检查面是否被更高层的某个面遮挡超过80%（跨层遮挡后处理）
+    bool isFaceMostlyOccluded(const TopoDS_Shape& face, const TopTools_ListOfShape& higherFaces,
+                              const Message_ProgressRange& range = Message_ProgressRange()) const;
 
     // 获取形状类型的字符串表示
     std::string getShapeTypeString(const TopAbs_ShapeEnum& shapeType) const;
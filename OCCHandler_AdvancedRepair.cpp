@@ -1,6 +1,8 @@
 #include "OCCHandler.h"
+#include "SprayLog.h"
+#include "SprayProfiler.h"
 #include <BRepCheck_Analyzer.hxx>
-#include <BRepBuilderAPI_Sewing.hxx>
+#include <BRepTools_ReShape.hxx>
 #include <ShapeFix_Shape.hxx>
 #include <ShapeFix_Wire.hxx>
 #include <ShapeFix_Face.hxx>
@@ -31,119 +33,147 @@
 #include <TopoDS.hxx>
 #include <BRepGProp.hxx>
 #include <GProp_GProps.hxx>
+#include <Message_ProgressScope.hxx>
 #include <iostream>
 
 // 增强的模型修复函数（基于OCCT 7.9）
-bool OCCHandler::enhancedModelRepair(double tolerance, bool verbose) {
+bool OCCHandler::enhancedModelRepair(double tolerance, bool verbose, const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("occ.enhancedModelRepair");
+
     if (shape.IsNull()) {
         if (verbose) {
-            std::cerr << "❌ 没有加载的模型，无法进行修复" << std::endl;
+            SPRAY_LOG_ERROR << "❌ 没有加载的模型，无法进行修复";
         }
         return false;
     }
 
+    // 分区修复：各部分并行执行下面的同一流程
+    bool partitionedResult = false;
+    if (partitionedRepair && repairPartitioned("增强修复", tolerance, verbose,
+            [tolerance](OCCHandler& part, const Message_ProgressRange& partRange) {
+                return part.enhancedModelRepair(tolerance, false, partRange);
+            }, range, partitionedResult)) {
+        return partitionedResult;
+    }
+
     if (verbose) {
-        std::cout << "🚀 开始增强模型修复（基于OCCT 7.9）..." << std::endl;
-        std::cout << "📏 使用容差: " << tolerance << std::endl;
+        SPRAY_LOG_INFO << "🚀 开始增强模型修复（基于OCCT 7.9）...";
+        SPRAY_LOG_INFO << "📏 使用容差: " << tolerance;
     }
 
+    // 进度：缝合、形状修复
+    Message_ProgressScope scope(range, "增强修复", 2);
+
     try {
-        // 步骤1: 详细的形状分析
-        if (verbose) {
-            std::cout << "\n📊 步骤1: 详细形状分析..." << std::endl;
-        }
+        // 后备修复时复用修复上下文中对原始模型的诊断，不再重复分析
+        const RepairDiagnosis* reusedDiagnosis = trackedRepairDiagnosis();
+        if (reusedDiagnosis != nullptr) {
+            if (verbose) {
+                SPRAY_LOG_INFO << "\n♻️ 步骤1-3: 复用修复上下文中的诊断结果...";
+                SPRAY_LOG_INFO << "   基本有效性: " << (reusedDiagnosis->valid ? "✅" : "❌");
+                SPRAY_LOG_INFO << "   平均容差: " << reusedDiagnosis->averageTolerance;
+                SPRAY_LOG_INFO << "   最大容差: " << reusedDiagnosis->maxTolerance;
+                SPRAY_LOG_INFO << "   封闭自由边界: " << reusedDiagnosis->closedFreeBoundCount;
+                SPRAY_LOG_INFO << "   开放自由边界: " << reusedDiagnosis->openFreeBoundCount;
+            }
+        } else {
+            // 步骤1: 详细的形状分析
+            if (verbose) {
+                SPRAY_LOG_INFO << "\n📊 步骤1: 详细形状分析...";
+            }
         
-        // 基本有效性检查
-        BRepCheck_Analyzer analyzer(shape);
-        bool isValid = analyzer.IsValid();
+            // 基本有效性检查
+            BRepCheck_Analyzer analyzer(shape);
+            bool isValid = analyzer.IsValid();
         
-        // 容差分析
-        ShapeAnalysis_ShapeTolerance toleranceAnalyzer;
-        Standard_Real avgTolerance = toleranceAnalyzer.Tolerance(shape, 0);
-        Standard_Real maxTolerance = toleranceAnalyzer.Tolerance(shape, 1);
-        Standard_Real minTolerance = toleranceAnalyzer.Tolerance(shape, -1);
+            // 容差分析
+            ShapeAnalysis_ShapeTolerance toleranceAnalyzer;
+            Standard_Real avgTolerance = toleranceAnalyzer.Tolerance(shape, 0);
+            Standard_Real maxTolerance = toleranceAnalyzer.Tolerance(shape, 1);
+            Standard_Real minTolerance = toleranceAnalyzer.Tolerance(shape, -1);
         
-        if (verbose) {
-            std::cout << "   基本有效性: " << (isValid ? "✅" : "❌") << std::endl;
-            std::cout << "   平均容差: " << avgTolerance << std::endl;
-            std::cout << "   最大容差: " << maxTolerance << std::endl;
-            std::cout << "   最小容差: " << minTolerance << std::endl;
-        }
+            if (verbose) {
+                SPRAY_LOG_INFO << "   基本有效性: " << (isValid ? "✅" : "❌");
+                SPRAY_LOG_INFO << "   平均容差: " << avgTolerance;
+                SPRAY_LOG_INFO << "   最大容差: " << maxTolerance;
+                SPRAY_LOG_INFO << "   最小容差: " << minTolerance;
+            }
 
-        // 步骤2: 自由边界分析
-        if (verbose) {
-            std::cout << "\n🔍 步骤2: 自由边界分析..." << std::endl;
-        }
+            // 步骤2: 自由边界分析
+            if (verbose) {
+                SPRAY_LOG_INFO << "\n🔍 步骤2: 自由边界分析...";
+            }
         
-        ShapeAnalysis_FreeBounds freeBoundsAnalyzer(shape);
-        TopoDS_Compound closedWires = freeBoundsAnalyzer.GetClosedWires();
-        TopoDS_Compound openWires = freeBoundsAnalyzer.GetOpenWires();
+            ShapeAnalysis_FreeBounds freeBoundsAnalyzer(shape);
+            TopoDS_Compound closedWires = freeBoundsAnalyzer.GetClosedWires();
+            TopoDS_Compound openWires = freeBoundsAnalyzer.GetOpenWires();
         
-        // 统计自由边界
-        int closedWireCount = 0, openWireCount = 0;
-        for (TopExp_Explorer exp(closedWires, TopAbs_WIRE); exp.More(); exp.Next()) closedWireCount++;
-        for (TopExp_Explorer exp(openWires, TopAbs_WIRE); exp.More(); exp.Next()) openWireCount++;
+            // 统计自由边界
+            int closedWireCount = 0, openWireCount = 0;
+            for (TopExp_Explorer exp(closedWires, TopAbs_WIRE); exp.More(); exp.Next()) closedWireCount++;
+            for (TopExp_Explorer exp(openWires, TopAbs_WIRE); exp.More(); exp.Next()) openWireCount++;
         
-        if (verbose) {
-            std::cout << "   封闭自由边界: " << closedWireCount << std::endl;
-            std::cout << "   开放自由边界: " << openWireCount << std::endl;
-        }
+            if (verbose) {
+                SPRAY_LOG_INFO << "   封闭自由边界: " << closedWireCount;
+                SPRAY_LOG_INFO << "   开放自由边界: " << openWireCount;
+            }
 
-        // 步骤3: 小面检查
-        if (verbose) {
-            std::cout << "\n🔬 步骤3: 小面检查..." << std::endl;
-        }
+            // 步骤3: 小面检查
+            if (verbose) {
+                SPRAY_LOG_INFO << "\n🔬 步骤3: 小面检查...";
+            }
         
-        ShapeAnalysis_CheckSmallFace smallFaceChecker;
-        int smallFaceCount = 0;
-        for (TopExp_Explorer faceExp(shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
-            TopoDS_Face face = TopoDS::Face(faceExp.Current());
-            TopoDS_Edge edge1, edge2;
-            if (smallFaceChecker.CheckSpotFace(face, tolerance) ||
-                smallFaceChecker.CheckStripFace(face, edge1, edge2, tolerance)) {
-                smallFaceCount++;
+            ShapeAnalysis_CheckSmallFace smallFaceChecker;
+            int smallFaceCount = 0;
+            for (TopExp_Explorer faceExp(shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
+                TopoDS_Face face = TopoDS::Face(faceExp.Current());
+                TopoDS_Edge edge1, edge2;
+                if (smallFaceChecker.CheckSpotFace(face, tolerance) ||
+                    smallFaceChecker.CheckStripFace(face, edge1, edge2, tolerance)) {
+                    smallFaceCount++;
+                }
             }
-        }
         
-        if (verbose) {
-            std::cout << "   发现小面数量: " << smallFaceCount << std::endl;
+            if (verbose) {
+                SPRAY_LOG_INFO << "   发现小面数量: " << smallFaceCount;
+            }
         }
 
         // 步骤4: 高级缝合修复
         if (verbose) {
-            std::cout << "\n🧵 步骤4: 高级缝合修复..." << std::endl;
-        }
-        
-        BRepBuilderAPI_Sewing sewing(tolerance);
-        sewing.SetTolerance(tolerance);
-        sewing.SetFaceMode(Standard_True);
-        sewing.SetFloatingEdgesMode(Standard_True);
-        sewing.SetNonManifoldMode(Standard_False);
-        
-        // 添加所有面
-        int faceCount = 0;
-        for (TopExp_Explorer faceExp(shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
-            sewing.Add(faceExp.Current());
-            faceCount++;
-        }
-        
-        if (verbose) {
-            std::cout << "   处理 " << faceCount << " 个面..." << std::endl;
+            SPRAY_LOG_INFO << "\n🧵 步骤4: 高级缝合修复...";
         }
         
-        sewing.Perform();
-        TopoDS_Shape sewedShape = sewing.SewedShape();
-        
-        if (!sewedShape.IsNull()) {
-            shape = sewedShape;
+        if (resumeSewingFromContext(tolerance)) {
+            scope.Next();
             if (verbose) {
-                std::cout << "✅ 高级缝合修复成功" << std::endl;
+                SPRAY_LOG_INFO << "♻️ 复用修复上下文中的缝合结果";
+            }
+        } else {
+            // 缝合所有面
+            int faceCount = 0;
+            Handle(BRepTools_ReShape) sewingHistory;
+            TopoDS_Shape sewedShape = sewAllFaces(tolerance, faceCount, sewingHistory, scope.Next());
+            if (!scope.More()) {
+                return false;
+            }
+
+            if (verbose) {
+                SPRAY_LOG_INFO << "   处理 " << faceCount << " 个面...";
+            }
+
+            if (!sewedShape.IsNull()) {
+                recordSewingInContext(tolerance, shape, sewedShape, sewingHistory);
+                shape = sewedShape;
+                if (verbose) {
+                    SPRAY_LOG_INFO << "✅ 高级缝合修复成功";
+                }
             }
         }
 
         // 步骤5: ShapeFix_Shape 全面修复
         if (verbose) {
-            std::cout << "\n🛠️ 步骤5: 全面形状修复..." << std::endl;
+            SPRAY_LOG_INFO << "\n🛠️ 步骤5: 全面形状修复...";
         }
         
         Handle(ShapeFix_Shape) shapeFixer = new ShapeFix_Shape();
@@ -152,21 +182,24 @@ bool OCCHandler::enhancedModelRepair(double tolerance, bool verbose) {
         shapeFixer->SetMaxTolerance(tolerance * 100);
         shapeFixer->SetMinTolerance(tolerance * 0.01);
         
-        bool fixResult = shapeFixer->Perform();
+        bool fixResult = shapeFixer->Perform(scope.Next());
+        if (!scope.More()) {
+            return false;
+        }
         
         if (fixResult) {
             TopoDS_Shape fixedShape = shapeFixer->Shape();
             if (!fixedShape.IsNull()) {
                 shape = fixedShape;
                 if (verbose) {
-                    std::cout << "✅ 全面形状修复成功" << std::endl;
+                    SPRAY_LOG_INFO << "✅ 全面形状修复成功";
                 }
             }
         }
 
         // 步骤6: 最终验证
         if (verbose) {
-            std::cout << "\n✔️ 步骤6: 最终验证..." << std::endl;
+            SPRAY_LOG_INFO << "\n✔️ 步骤6: 最终验证...";
         }
         
         BRepCheck_Analyzer finalAnalyzer(shape);
@@ -179,75 +212,88 @@ bool OCCHandler::enhancedModelRepair(double tolerance, bool verbose) {
         for (TopExp_Explorer exp(shape, TopAbs_VERTEX); exp.More(); exp.Next()) finalVertexCount++;
         
         if (verbose) {
-            std::cout << "📊 最终统计:" << std::endl;
-            std::cout << "   面数量: " << finalFaceCount << std::endl;
-            std::cout << "   边数量: " << finalEdgeCount << std::endl;
-            std::cout << "   顶点数量: " << finalVertexCount << std::endl;
-            std::cout << "   模型有效性: " << (finalValid ? "✅" : "⚠️") << std::endl;
-            std::cout << "🎉 增强模型修复完成！" << std::endl;
+            SPRAY_LOG_INFO << "📊 最终统计:";
+            SPRAY_LOG_INFO << "   面数量: " << finalFaceCount;
+            SPRAY_LOG_INFO << "   边数量: " << finalEdgeCount;
+            SPRAY_LOG_INFO << "   顶点数量: " << finalVertexCount;
+            SPRAY_LOG_INFO << "   模型有效性: " << (finalValid ? "✅" : "⚠️");
+            SPRAY_LOG_INFO << "🎉 增强模型修复完成！";
         }
 
         return true;
 
     } catch (const std::exception& e) {
         if (verbose) {
-            std::cerr << "❌ 增强修复过程中发生异常: " << e.what() << std::endl;
+            SPRAY_LOG_ERROR << "❌ 增强修复过程中发生异常: " << e.what();
         }
         return false;
     } catch (...) {
         if (verbose) {
-            std::cerr << "❌ 增强修复过程中发生未知异常" << std::endl;
+            SPRAY_LOG_ERROR << "❌ 增强修复过程中发生未知异常";
         }
         return false;
     }
 }
 
 // 针对喷涂轨迹优化的修复
-bool OCCHandler::sprayTrajectoryOptimizedRepair(double tolerance, bool verbose) {
+bool OCCHandler::sprayTrajectoryOptimizedRepair(double tolerance, bool verbose, const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("occ.sprayTrajectoryOptimizedRepair");
+
     if (shape.IsNull()) {
         if (verbose) {
-            std::cerr << "❌ 没有加载的模型，无法进行修复" << std::endl;
+            SPRAY_LOG_ERROR << "❌ 没有加载的模型，无法进行修复";
         }
         return false;
     }
 
+    // 分区修复：各部分并行执行下面的同一流程
+    bool partitionedResult = false;
+    if (partitionedRepair && repairPartitioned("喷涂优化修复", tolerance, verbose,
+            [tolerance](OCCHandler& part, const Message_ProgressRange& partRange) {
+                return part.sprayTrajectoryOptimizedRepair(tolerance, false, partRange);
+            }, range, partitionedResult)) {
+        return partitionedResult;
+    }
+
     if (verbose) {
-        std::cout << "🎯 开始喷涂轨迹优化修复..." << std::endl;
-        std::cout << "📏 使用容差: " << tolerance << "mm（适合喷涂应用）" << std::endl;
+        SPRAY_LOG_INFO << "🎯 开始喷涂轨迹优化修复...";
+        SPRAY_LOG_INFO << "📏 使用容差: " << tolerance << "mm（适合喷涂应用）";
     }
 
+    Message_ProgressScope scope(range, "喷涂优化修复", 1);
+
     try {
         // 步骤1: 面连接性优化（对轨迹生成最重要）
         if (verbose) {
-            std::cout << "\n🔗 步骤1: 面连接性优化..." << std::endl;
+            SPRAY_LOG_INFO << "\n🔗 步骤1: 面连接性优化...";
         }
         
-        BRepBuilderAPI_Sewing sewing(tolerance);
-        sewing.SetTolerance(tolerance);
-        sewing.SetFaceMode(Standard_True);
-        sewing.SetFloatingEdgesMode(Standard_True);
-        sewing.SetNonManifoldMode(Standard_False);
-        
-        // 添加所有面
-        int originalFaceCount = 0;
-        for (TopExp_Explorer faceExp(shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
-            sewing.Add(faceExp.Current());
-            originalFaceCount++;
-        }
-        
-        sewing.Perform();
-        TopoDS_Shape sewedShape = sewing.SewedShape();
-        
-        if (!sewedShape.IsNull()) {
-            shape = sewedShape;
+        if (resumeSewingFromContext(tolerance)) {
+            scope.Next();
             if (verbose) {
-                std::cout << "✅ 面连接性优化完成，处理了 " << originalFaceCount << " 个面" << std::endl;
+                SPRAY_LOG_INFO << "♻️ 复用修复上下文中的缝合结果";
+            }
+        } else {
+            // 缝合所有面
+            int originalFaceCount = 0;
+            Handle(BRepTools_ReShape) sewingHistory;
+            TopoDS_Shape sewedShape = sewAllFaces(tolerance, originalFaceCount, sewingHistory, scope.Next());
+            if (!scope.More()) {
+                return false;
+            }
+
+            if (!sewedShape.IsNull()) {
+                recordSewingInContext(tolerance, shape, sewedShape, sewingHistory);
+                shape = sewedShape;
+                if (verbose) {
+                    SPRAY_LOG_INFO << "✅ 面连接性优化完成，处理了 " << originalFaceCount << " 个面";
+                }
             }
         }
 
         // 步骤2: 移除内部线框（简化轨迹生成）
         if (verbose) {
-            std::cout << "\n🧹 步骤2: 移除内部线框..." << std::endl;
+            SPRAY_LOG_INFO << "\n🧹 步骤2: 移除内部线框...";
         }
         
         Handle(ShapeUpgrade_RemoveInternalWires) wireRemover = new ShapeUpgrade_RemoveInternalWires(shape);
@@ -261,7 +307,7 @@ bool OCCHandler::sprayTrajectoryOptimizedRepair(double tolerance, bool verbose)
             if (!cleanedShape.IsNull()) {
                 shape = cleanedShape;
                 if (verbose) {
-                    std::cout << "✅ 内部线框移除完成" << std::endl;
+                    SPRAY_LOG_INFO << "✅ 内部线框移除完成";
                 }
             }
         }
@@ -270,12 +316,12 @@ bool OCCHandler::sprayTrajectoryOptimizedRepair(double tolerance, bool verbose)
 
     } catch (const std::exception& e) {
         if (verbose) {
-            std::cerr << "❌ 喷涂轨迹优化修复过程中发生异常: " << e.what() << std::endl;
+            SPRAY_LOG_ERROR << "❌ 喷涂轨迹优化修复过程中发生异常: " << e.what();
         }
         return false;
     } catch (...) {
         if (verbose) {
-            std::cerr << "❌ 喷涂轨迹优化修复过程中发生未知异常" << std::endl;
+            SPRAY_LOG_ERROR << "❌ 喷涂轨迹优化修复过程中发生未知异常";
         }
         return false;
     }
@@ -1,5 +1,13 @@
 #include "OCCHandler.h"
+#include "SprayLog.h"
+#include "OcclusionCache.h"
+#include "FaceNormalService.h"
+#include "ShapeCache.h"
+#include "RepairContext.h"
+#include "SprayProfiler.h"
 #include <STEPControl_Reader.hxx>
+#include <Message_ProgressScope.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
 #include <IFSelect_ReturnStatus.hxx>
 #include <iostream>
 #include <Bnd_Box.hxx>
@@ -17,9 +25,24 @@
 #include <TopoDS_Compound.hxx>
 #include <TopTools_ListOfShape.hxx>
 #include <TopTools_ListIteratorOfListOfShape.hxx>
+#include <sstream>
+
+// BREP缓存的参数标签：修复流程与剖分精度变化时缓存失效
+static std::string shapeCacheTag(bool autoRepair, bool partitioned, bool spatialSewing) {
+    std::ostringstream tag;
+    tag << "repair=" << (autoRepair ? "plan:1e-3,enhanced:1e-6,basic:1e-6" : "none")
+        << (autoRepair && partitioned ? ",partitioned" : "")
+        << (autoRepair && spatialSewing ? ",spatial-sewing" : "")
+        << ";mesh=" << OCC_MESH_DEFLECTION;
+    return tag.str();
+}
 
 // 构造函数
-OCCHandler::OCCHandler() {
+OCCHandler::OCCHandler()
+    : parallelMode(true), occlusionCacheEnabled(true), occlusionCache(std::make_shared<OcclusionCache>()),
+      faceNormalService(std::make_shared<FaceNormalService>()),
+      shapeCache(std::make_shared<ShapeCache>()), parallelImport(false), partitionedRepair(false),
+      spatialSewing(false) {
     // 初始化代码（如果需要）
 }
 
@@ -29,55 +52,148 @@ OCCHandler::~OCCHandler() {
 }
 
 // 加载STEP文件
-bool OCCHandler::loadStepFile(const std::string& filename, bool moveToOrigin, bool autoRepair) {
-    STEPControl_Reader reader;
-    IFSelect_ReturnStatus status = reader.ReadFile(filename.c_str());
-    if (status != IFSelect_RetDone) {
-        std::cerr << "STEP文件加载失败: " << filename << std::endl;
-        return false;
+bool OCCHandler::loadStepFile(const std::string& filename, bool moveToOrigin, bool autoRepair,
+                              const Message_ProgressRange& range) {
+    return loadStepSelection(filename, StepLoadSelection(), moveToOrigin, autoRepair, range);
+}
+
+// 按选择范围加载STEP文件
+bool OCCHandler::loadStepSelection(const std::string& filename, const StepLoadSelection& selection,
+                                   bool moveToOrigin, bool autoRepair, const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("occ.loadStepFile");
+
+    // 进度：读取1、转换3、修复4、写缓存1
+    Message_ProgressScope scope(range, "加载STEP", autoRepair ? 9 : 5);
+
+    // 先查BREP缓存：文件内容与修复参数都相同时直接使用上次修复并剖分好的形状
+    std::string cacheKey;
+    TopoDS_Shape loadedShape;
+    bool cacheHit = false;
+    if (shapeCache->isEnabled()) {
+        SPRAY_PROFILE_SCOPE("occ.loadStepFile.cache");
+        if (shapeCache->makeKey(filename, shapeCacheTag(autoRepair, partitionedRepair, spatialSewing) + selection.tag(), cacheKey)) {
+            cacheHit = shapeCache->load(cacheKey, loadedShape);
+        }
+        SPRAY_COUNTER_ADD(cacheHit ? "load.shapeCacheHits" : "load.shapeCacheMisses", 1);
     }
 
-    // 转换STEP实体到OCCT数据结构
-    reader.TransferRoots();
-    shape = reader.OneShape();
+    if (cacheHit) {
+        SPRAY_LOG_INFO << "♻️ 使用BREP缓存: " << filename;
+    } else {
+        STEPControl_Reader reader;
+        IFSelect_ReturnStatus status;
+        {
+            SPRAY_PROFILE_SCOPE("occ.loadStepFile.read");
+            status = reader.ReadFile(filename.c_str());
+        }
+        scope.Next();
+        if (status != IFSelect_RetDone) {
+            SPRAY_LOG_WARN << "STEP文件加载失败: " << filename;
+            return false;
+        }
+        if (!scope.More()) {
+            SPRAY_LOG_INFO << "⏹️ 已取消加载: " << filename;
+            return false;
+        }
 
-    if (shape.IsNull()) {
-        std::cerr << "无法从STEP文件获取有效形状: " << filename << std::endl;
+        // 转换STEP实体到OCCT数据结构（先转换到局部变量，取消时保留之前的模型）
+        {
+            SPRAY_PROFILE_SCOPE("occ.loadStepFile.transfer");
+            if (!transferStepRoots(reader, selection.rootIndices, loadedShape, scope.Next(3))) {
+                loadedShape.Nullify();
+            }
+        }
+
+        // 只保留与关注区域相交的部分，后续修复与处理只针对这部分
+        if (selection.useRegion && !loadedShape.IsNull()) {
+            SPRAY_PROFILE_SCOPE("occ.loadStepFile.region");
+            loadedShape = filterShapeByRegion(loadedShape, selection.region);
+            if (loadedShape.IsNull()) {
+                SPRAY_LOG_WARN << "⚠️ 关注区域内没有形状: " << filename;
+            }
+        }
+        if (!scope.More()) {
+            SPRAY_LOG_INFO << "⏹️ 已取消加载: " << filename;
+            return false;
+        }
+    }
+
+    if (loadedShape.IsNull()) {
+        SPRAY_LOG_WARN << "无法从STEP文件获取有效形状: " << filename;
         return false;
     }
 
-    std::cout << "✅ STEP文件加载成功: " << filename << std::endl;
+    SPRAY_LOG_INFO << "✅ STEP文件加载成功: " << filename;
+
+    // 修复直接作用于当前模型，取消时恢复
+    TopoDS_Shape previousShape = shape;
+    gp_Trsf previousTransform = modelTransform;
+    shape = loadedShape;
+
+    // 新模型：重置整体变换并清空上一个模型的遮挡缓存与法向量缓存
+    modelTransform = gp_Trsf();
+    occlusionCache->clear();
+    faceNormalService->clear();
+
+    // 如果需要，自动修复模型（缓存中的形状已修复）
+    if (autoRepair && !cacheHit) {
+        SPRAY_PROFILE_SCOPE("occ.loadStepFile.repair");
+        SPRAY_LOG_INFO << "🔧 开始自动修复导入的模型...";
+
+        Message_ProgressScope repairScope(scope.Next(4), "自动修复", 3);
+
+        // 后备链共享修复上下文：诊断只做一次，后备修复从已有的缝合结果继续
+        std::shared_ptr<RepairContext> context = std::make_shared<RepairContext>(shape);
+        setRepairContext(context);
 
-    // 如果需要，自动修复模型
-    if (autoRepair) {
-        std::cout << "🔧 开始自动修复导入的模型..." << std::endl;
-        
-        // 使用增强的修复功能
-        bool repairSuccess = sprayTrajectoryOptimizedRepair(1e-3, true);
+        // 先诊断，只执行需要的修复操作；失败时依次使用增强修复和基础修复
+        bool repairSuccess = repairWithPlan(1e-3, true, repairScope.Next());
         if (repairSuccess) {
-            std::cout << "✅ 喷涂轨迹优化修复完成" << std::endl;
-        } else {
-            std::cout << "⚠️ 尝试基本修复..." << std::endl;
-            repairSuccess = enhancedModelRepair(1e-6, true);
+            SPRAY_LOG_INFO << "✅ 计划修复完成";
+        } else if (repairScope.More()) {
+            // 后备修复从原始模型的新副本开始，不继承上一步原地修改过的TShape
+            SPRAY_LOG_WARN << "⚠️ 尝试基本修复...";
+            shape = context->restartShape();
+            repairSuccess = enhancedModelRepair(1e-6, true, repairScope.Next());
             if (repairSuccess) {
-                std::cout << "✅ 增强模型修复完成" << std::endl;
-            } else {
-                std::cout << "⚠️ 使用基础修复..." << std::endl;
-                repairSuccess = repairImportedModel(1e-6, true);
+                SPRAY_LOG_INFO << "✅ 增强模型修复完成";
+            } else if (repairScope.More()) {
+                SPRAY_LOG_WARN << "⚠️ 使用基础修复...";
+                shape = context->restartShape();
+                repairSuccess = repairImportedModel(1e-6, true, repairScope.Next());
                 if (repairSuccess) {
-                    std::cout << "✅ 基础模型修复完成" << std::endl;
-                } else {
-                    std::cout << "⚠️ 模型修复过程中出现问题，但模型仍可使用" << std::endl;
+                    SPRAY_LOG_INFO << "✅ 基础模型修复完成";
+                } else if (repairScope.More()) {
+                    // 全部失败：从缝合结果（没有时为原始模型）继续，不保留修复到一半的形状
+                    shape = context->resumeShape();
+                    SPRAY_LOG_WARN << "⚠️ 模型修复过程中出现问题，但模型仍可使用";
                 }
             }
         }
+        setRepairContext(nullptr);
+    }
+
+    if (!scope.More()) {
+        SPRAY_LOG_INFO << "⏹️ 已取消加载: " << filename;
+        shape = previousShape;
+        modelTransform = previousTransform;
+        return false;
+    }
+
+    // 写入BREP缓存：先按显示精度剖分，缓存文件连同三角剖分一起保存，再次打开时无需重新剖分
+    if (!cacheHit && !cacheKey.empty()) {
+        SPRAY_PROFILE_SCOPE("occ.loadStepFile.cacheStore");
+        BRepMesh_IncrementalMesh mesher(shape, OCC_MESH_DEFLECTION, Standard_False, 0.5, parallelMode);
+        if (shapeCache->store(cacheKey, shape, scope.Next())) {
+            SPRAY_LOG_INFO << "💾 已写入BREP缓存";
+        }
     }
 
     // 如果需要，将模型移动到原点
     if (moveToOrigin) {
-        std::cout << "📍 将模型移动到原点..." << std::endl;
+        SPRAY_LOG_INFO << "📍 将模型移动到原点...";
         this->moveShapeToOrigin();
-        std::cout << "✅ 模型已移动到原点" << std::endl;
+        SPRAY_LOG_INFO << "✅ 模型已移动到原点";
     }
 
     return true;
@@ -88,10 +204,48 @@ TopoDS_Shape OCCHandler::getShape() const {
     return shape;
 }
 
+// 设置是否启用并行处理
+void OCCHandler::setParallelMode(bool enabled) {
+    parallelMode = enabled;
+}
+
+// 是否启用了并行处理
+bool OCCHandler::isParallelMode() const {
+    return parallelMode;
+}
+
+// 设置是否启用遮挡裁剪结果缓存
+void OCCHandler::setOcclusionCacheEnabled(bool enabled) {
+    occlusionCacheEnabled = enabled;
+    if (!enabled) {
+        occlusionCache->clear();
+    }
+}
+
+// 清空遮挡裁剪结果缓存
+void OCCHandler::clearOcclusionCache() {
+    occlusionCache->clear();
+}
+
+// 面法向量服务
+std::shared_ptr<FaceNormalService> OCCHandler::getFaceNormalService() const {
+    return faceNormalService;
+}
+
+// 设置BREP缓存目录
+void OCCHandler::setShapeCacheDirectory(const std::string& directory) {
+    shapeCache->setDirectory(directory);
+}
+
+// 获取BREP缓存目录
+std::string OCCHandler::getShapeCacheDirectory() const {
+    return shapeCache->getDirectory();
+}
+
 // 移动模型到原点
 void OCCHandler::moveShapeToOrigin() {
     if (shape.IsNull()) {
-        std::cerr << "没有加载模型，无法移动到原点" << std::endl;
+        SPRAY_LOG_WARN << "没有加载模型，无法移动到原点";
         return;
     }
 
@@ -114,12 +268,13 @@ void OCCHandler::moveShapeToOrigin() {
 
     // 更新成员变量为平移后的形状
     shape = transformedShape;
+    modelTransform.PreMultiply(transformation);
 }
 
 // 绕指定坐标轴旋转90度
 void OCCHandler::rotate90(gp_Dir axis) {
     if (shape.IsNull()) {
-        std::cerr << "没有加载模型，无法旋转" << std::endl;
+        SPRAY_LOG_WARN << "没有加载模型，无法旋转";
         return;
     }
 
@@ -130,8 +285,9 @@ void OCCHandler::rotate90(gp_Dir axis) {
     // 应用变换
     BRepBuilderAPI_Transform transformer(shape, rotation);
     shape = transformer.Shape();
+    modelTransform.PreMultiply(rotation);
     
-    std::cout << "模型已绕指定轴旋转90度" << std::endl;
+    SPRAY_LOG_INFO << "模型已绕指定轴旋转90度";
 }
 
 // 打印TopoDS_Shape结构
@@ -269,7 +425,7 @@ TopTools_ListOfShape OCCHandler::extractAllShells(const TopoDS_Shape& sourceShap
     TopoDS_Shape shapeToUse = sourceShape.IsNull() ? shape : sourceShape;
     
     if (shapeToUse.IsNull()) {
-        std::cerr << "没有加载模型，无法提取shell" << std::endl;
+        SPRAY_LOG_WARN << "没有加载模型，无法提取shell";
         return shells;
     }
 
@@ -278,14 +434,14 @@ TopTools_ListOfShape OCCHandler::extractAllShells(const TopoDS_Shape& sourceShap
         shells.Append(shellExplorer.Current());
     }
 
-    std::cout << "从模型中提取了 " << shells.Extent() << " 个shell" << std::endl;
+    SPRAY_LOG_INFO << "从模型中提取了 " << shells.Extent() << " 个shell";
     return shells;
 }
 
 // 创建一个只包含指定shell的新形状
 TopoDS_Shape OCCHandler::createShapeFromShells(const TopTools_ListOfShape& shells) {
     if (shells.IsEmpty()) {
-        std::cerr << "shell列表为空，无法创建形状" << std::endl;
+        SPRAY_LOG_WARN << "shell列表为空，无法创建形状";
         return TopoDS_Shape();
     }
 
@@ -299,10 +455,10 @@ TopoDS_Shape OCCHandler::createShapeFromShells(const TopTools_ListOfShape& shell
             builder.Add(compound, it.Value());
         }
 
-        std::cout << "成功创建包含 " << shells.Extent() << " 个shell的形状" << std::endl;
+        SPRAY_LOG_INFO << "成功创建包含 " << shells.Extent() << " 个shell的形状";
         return compound;
     } catch (...) {
-        std::cerr << "❌ 创建shell形状时发生异常" << std::endl;
+        SPRAY_LOG_ERROR << "❌ 创建shell形状时发生异常";
         return TopoDS_Shape();
     }
 }
@@ -1,4 +1,7 @@
 #include "OCCHandler.h"
+#include "SprayLog.h"
+#include "SprayProfiler.h"
+#include "FaceNormalService.h"
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
 #include <TopoDS_Iterator.hxx>
@@ -12,10 +15,12 @@
 #include <BRepBuilderAPI_MakeFace.hxx>
 #include <BRepBuilderAPI_Sewing.hxx>
 #include <Geom_Surface.hxx>
+#include <Message_ProgressScope.hxx>
 #include <iostream>
 #include <map>
 #include <algorithm>
 #include <functional>
+#include <vector>
 
 // 提取形状中的所有面
 TopTools_ListOfShape OCCHandler::extractAllFaces(const TopoDS_Shape& sourceShape) {
@@ -25,7 +30,7 @@ TopTools_ListOfShape OCCHandler::extractAllFaces(const TopoDS_Shape& sourceShape
     TopoDS_Shape shapeToUse = sourceShape.IsNull() ? shape : sourceShape;
     
     if (shapeToUse.IsNull()) {
-        std::cerr << "没有加载模型，无法提取面" << std::endl;
+        SPRAY_LOG_WARN << "没有加载模型，无法提取面";
         return faces;
     }
 
@@ -53,85 +58,125 @@ TopTools_ListOfShape OCCHandler::extractAllFaces(const TopoDS_Shape& sourceShape
     // 开始处理形状
     processShape(shapeToUse);
 
-    std::cout << "从模型中提取了 " << faces.Extent() << " 个面" << std::endl;
+    SPRAY_LOG_INFO << "从模型中提取了 " << faces.Extent() << " 个面";
 
     return faces;
 }
 
-// 基于法向量方向提取面并创建新形状
-TopoDS_Shape OCCHandler::extractFacesByNormal(const gp_Dir& direction, double angleTolerance, bool returnExtracted) {
-    if (shape.IsNull()) {
-        std::cerr << "没有加载模型，无法提取面" << std::endl;
-        return TopoDS_Shape();
+// 计算当前模型所有面的法向量（经面法向量服务，已缓存的面直接复用），faces按遍历顺序输出；取消时返回false
+bool OCCHandler::computeFaceNormals(std::vector<TopoDS_Face>& faces, FaceNormalArrays& normals,
+                                    const Message_ProgressRange& range) const {
+    SPRAY_PROFILE_SCOPE("occ.computeFaceNormals");
+
+    faces.clear();
+    for (TopExp_Explorer faceExp(shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
+        faces.push_back(TopoDS::Face(faceExp.Current()));
     }
+    return faceNormalService->normals(faces, normals, parallelMode, range);
+}
 
-// 角度容差（从度转换为弧度）
-    double angleToleranceRad = angleTolerance * M_PI / 180.0;
-    double cosAngleTolerance = cos(angleToleranceRad);
+// 按一个方向分类：matches[i] = 法向量与方向的点积大于cosAngleTolerance（连续数组上的简单循环，可由编译器向量化）
+void OCCHandler::classifyFaceNormals(const FaceNormalArrays& normals, const gp_Dir& direction,
+                                     double cosAngleTolerance, unsigned char* matches) {
+    const size_t count = normals.x.size();
+    const double* nx = normals.x.data();
+    const double* ny = normals.y.data();
+    const double* nz = normals.z.data();
+    const unsigned char* valid = normals.valid.data();
+    const double dx = direction.X();
+    const double dy = direction.Y();
+    const double dz = direction.Z();
+    for (size_t i = 0; i < count; i++) {
+        double dot = nx[i] * dx + ny[i] * dy + nz[i] * dz;
+        matches[i] = static_cast<unsigned char>((dot > cosAngleTolerance) & (valid[i] != 0));
+    }
+}
 
-    // 创建两个列表，分别用于存储符合条件的面和不符合条件的面
-    TopTools_ListOfShape matchingFaces;
-    TopTools_ListOfShape nonMatchingFaces;
+// 按多个方向一次提取面：法向量只计算一次，各方向分类只是对连续数组的点积
+std::vector<TopoDS_Shape> OCCHandler::extractFacesByNormals(const std::vector<gp_Dir>& directions, double angleTolerance,
+                                                            const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("occ.extractFacesByNormals");
 
-    // 先提取所有面
-    TopTools_ListOfShape allFaces = extractAllFaces();
+    std::vector<TopoDS_Shape> results(directions.size());
+    if (shape.IsNull()) {
+        SPRAY_LOG_WARN << "没有加载模型，无法提取面";
+        return results;
+    }
 
-    // 遍历所有面，根据法向量进行分类
-    for (TopTools_ListIteratorOfListOfShape it(allFaces); it.More(); it.Next()) {
-        TopoDS_Face face = TopoDS::Face(it.Value());
+    std::vector<TopoDS_Face> allFaces;
+    FaceNormalArrays normals;
+    if (!computeFaceNormals(allFaces, normals, range)) {
+        SPRAY_LOG_INFO << "⏹️ 已取消面提取";
+        return std::vector<TopoDS_Shape>(directions.size());
+    }
 
-        // 计算面的法向量
-        BRepAdaptor_Surface surface(face);
-        gp_Dir faceNormal;
-        bool isPlane = (surface.GetType() == GeomAbs_Plane);
+    const double cosAngleTolerance = cos(angleTolerance * M_PI / 180.0);
+    std::vector<unsigned char> matches(allFaces.size());
+    BRep_Builder builder;
+    for (size_t d = 0; d < directions.size(); d++) {
+        classifyFaceNormals(normals, directions[d], cosAngleTolerance, matches.data());
 
-        if (isPlane) {
-            // 对于平面，直接获取法向量
-            gp_Pln plane = surface.Plane();
-            faceNormal = plane.Axis().Direction();
-        } else {
-            // 对于非平面，计算参数中点的法向量
-            double uMin, uMax, vMin, vMax;
-            uMin = surface.Surface().FirstUParameter();
-            uMax = surface.Surface().LastUParameter();
-            vMin = surface.Surface().FirstVParameter();
-            vMax = surface.Surface().LastVParameter();
-
-            double uMid = (uMin + uMax) / 2.0;
-            double vMid = (vMin + vMax) / 2.0;
-
-            gp_Pnt point;
-            gp_Vec d1u, d1v;
-            surface.D1(uMid, vMid, point, d1u, d1v);
-            gp_Vec normal = d1u.Crossed(d1v);
-            if (normal.Magnitude() > 1e-7) {
-                normal.Normalize();
-                faceNormal = gp_Dir(normal);
-            } else {
-                // 如果无法计算法向量，使用默认值并跳过此面
-                continue;
+        TopoDS_Compound compound;
+        builder.MakeCompound(compound);
+        int matchCount = 0;
+        for (size_t i = 0; i < allFaces.size(); i++) {
+            if (matches[i]) {
+                builder.Add(compound, allFaces[i]);
+                matchCount++;
             }
         }
-
-        // 考虑面的拓扑方向
-        if (face.Orientation() == TopAbs_REVERSED) {
-            faceNormal.Reverse();
+        if (matchCount > 0) {
+            results[d] = compound;
         }
+        SPRAY_LOG_INFO << "方向 (" << directions[d].X() << ", " << directions[d].Y() << ", " << directions[d].Z()
+                       << ") 找到 " << matchCount << " 个符合条件的面";
+    }
+    return results;
+}
+
+// 基于法向量方向提取面并创建新形状
+TopoDS_Shape OCCHandler::extractFacesByNormal(const gp_Dir& direction, double angleTolerance, bool returnExtracted,
+                                              const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("occ.extractFacesByNormal");
+
+    if (shape.IsNull()) {
+        SPRAY_LOG_WARN << "没有加载模型，无法提取面";
+        return TopoDS_Shape();
+    }
+
+    // 角度容差（从度转换为弧度）
+    double angleToleranceRad = angleTolerance * M_PI / 180.0;
+    double cosAngleTolerance = cos(angleToleranceRad);
 
-        // 计算面法向量与参考方向的点积
-        double dotProduct = faceNormal.Dot(direction);
+    // 并行计算所有面的法向量
+    std::vector<TopoDS_Face> allFaces;
+    FaceNormalArrays normals;
+    if (!computeFaceNormals(allFaces, normals, range)) {
+        SPRAY_LOG_INFO << "⏹️ 已取消面提取";
+        return TopoDS_Shape();
+    }
 
-        // 根据点积决定面是否符合条件
-        if (dotProduct > cosAngleTolerance) {
-            matchingFaces.Append(face);
+    // 根据法向量与参考方向的点积分类（无法计算法向量的面跳过）
+    std::vector<unsigned char> matches(allFaces.size());
+    classifyFaceNormals(normals, direction, cosAngleTolerance, matches.data());
+
+    // 创建两个列表，分别用于存储符合条件的面和不符合条件的面
+    TopTools_ListOfShape matchingFaces;
+    TopTools_ListOfShape nonMatchingFaces;
+    for (size_t i = 0; i < allFaces.size(); i++) {
+        if (!normals.valid[i]) {
+            continue;
+        }
+        if (matches[i]) {
+            matchingFaces.Append(allFaces[i]);
         } else {
-            nonMatchingFaces.Append(face);
+            nonMatchingFaces.Append(allFaces[i]);
         }
     }
 
     // 如果没有找到任何符合条件的面，输出警告
     if (matchingFaces.IsEmpty() && nonMatchingFaces.IsEmpty()) {
-        std::cerr << "模型中没有找到任何面" << std::endl;
+        SPRAY_LOG_WARN << "模型中没有找到任何面";
         return TopoDS_Shape();
     }
 
@@ -140,13 +185,13 @@ TopoDS_Shape OCCHandler::extractFacesByNormal(const gp_Dir& direction, double an
 
     // 如果没有符合条件的面，输出信息
     if (facesToUse.IsEmpty()) {
-        std::cerr << "没有" << (returnExtracted ? "符合" : "不符合") << "条件的面" << std::endl;
+        SPRAY_LOG_WARN << "没有" << (returnExtracted ? "符合" : "不符合") << "条件的面";
         return TopoDS_Shape();
     }
 
     // 输出提取的面数量
-    std::cout << "找到 " << facesToUse.Extent() << " 个"
-              << (returnExtracted ? "符合" : "不符合") << "条件的面" << std::endl;
+    SPRAY_LOG_INFO << "找到 " << facesToUse.Extent() << " 个"
+                   << (returnExtracted ? "符合" : "不符合") << "条件的面";
 
     // 创建包含这些面的新形状
     try {
@@ -160,22 +205,24 @@ TopoDS_Shape OCCHandler::extractFacesByNormal(const gp_Dir& direction, double an
 
         return compound;
     } catch (...) {
-        std::cerr << "❌ 创建面形状时发生异常" << std::endl;
+        SPRAY_LOG_ERROR << "❌ 创建面形状时发生异常";
         return TopoDS_Shape();
     }
 }
 
 // 按Z高度对面进行分层
 std::map<double, TopTools_ListOfShape> OCCHandler::groupFacesByHeight(const TopTools_ListOfShape& faces, double heightTolerance) const {
+    SPRAY_PROFILE_SCOPE("occ.groupFacesByHeight");
+
     std::map<double, TopTools_ListOfShape> layeredFaces;
 
     if (faces.IsEmpty()) {
-        std::cout << "⚠️ 输入的面列表为空" << std::endl;
+        SPRAY_LOG_WARN << "⚠️ 输入的面列表为空";
         return layeredFaces;
     }
 
-    std::cout << "🔄 开始按Z高度对 " << faces.Extent() << " 个面进行分层..." << std::endl;
-    std::cout << "📏 高度容差: " << heightTolerance << std::endl;
+    SPRAY_LOG_INFO << "🔄 开始按Z高度对 " << faces.Extent() << " 个面进行分层...";
+    SPRAY_LOG_INFO << "📏 高度容差: " << heightTolerance;
 
     // 遍历所有面，计算其Z高度并分组
     for (TopTools_ListIteratorOfListOfShape it(faces); it.More(); it.Next()) {
@@ -201,11 +248,11 @@ std::map<double, TopTools_ListOfShape> OCCHandler::groupFacesByHeight(const TopT
     }
 
     // 输出分层结果
-    std::cout << "📊 分层结果: 共 " << layeredFaces.size() << " 层" << std::endl;
+    SPRAY_LOG_INFO << "📊 分层结果: 共 " << layeredFaces.size() << " 层";
     int layerIndex = 1;
     for (const auto& pair : layeredFaces) {
-        std::cout << "   第 " << layerIndex << " 层 (Z=" << pair.first << "): " 
-                  << pair.second.Extent() << " 个面" << std::endl;
+        SPRAY_LOG_DEBUG << "   第 " << layerIndex << " 层 (Z=" << pair.first << "): "
+                        << pair.second.Extent() << " 个面";
         layerIndex++;
     }
 
@@ -222,13 +269,15 @@ double OCCHandler::calculateFaceHeight(const TopoDS_Face& face) const {
         
         return centroid.Z();
     } catch (...) {
-        std::cerr << "⚠️ 计算面高度时发生异常，返回默认值0" << std::endl;
+        SPRAY_LOG_WARN << "⚠️ 计算面高度时发生异常，返回默认值0";
         return 0.0;
     }
 }
 
 // 使用缝合算法将面组合成shell
 TopoDS_Shape OCCHandler::sewFacesToShells(const TopTools_ListOfShape& faces, double tolerance) const {
+    SPRAY_PROFILE_SCOPE("occ.sewFacesToShells");
+
     try {
         if (faces.IsEmpty()) {
             return TopoDS_Shape();
@@ -251,7 +300,7 @@ TopoDS_Shape OCCHandler::sewFacesToShells(const TopTools_ListOfShape& faces, dou
         TopoDS_Shape sewedShape = sewing.SewedShape();
 
         if (sewedShape.IsNull()) {
-            std::cout << "⚠️ 缝合失败，返回空形状" << std::endl;
+            SPRAY_LOG_WARN << "⚠️ 缝合失败，返回空形状";
             return TopoDS_Shape();
         }
 
@@ -265,16 +314,16 @@ TopoDS_Shape OCCHandler::sewFacesToShells(const TopTools_ListOfShape& faces, dou
             faceCount++;
         }
 
-        std::cout << "✅ 缝合完成: " << faces.Extent() << " 个面 → " 
-                  << shellCount << " 个shell, " << faceCount << " 个面" << std::endl;
+        SPRAY_LOG_INFO << "✅ 缝合完成: " << faces.Extent() << " 个面 → " 
+                       << shellCount << " 个shell, " << faceCount << " 个面";
 
         return sewedShape;
 
     } catch (const std::exception& e) {
-        std::cerr << "❌ 缝合过程中发生异常: " << e.what() << std::endl;
+        SPRAY_LOG_ERROR << "❌ 缝合过程中发生异常: " << e.what();
         return TopoDS_Shape();
     } catch (...) {
-        std::cerr << "❌ 缝合过程中发生未知异常" << std::endl;
+        SPRAY_LOG_ERROR << "❌ 缝合过程中发生未知异常";
         return TopoDS_Shape();
     }
 }
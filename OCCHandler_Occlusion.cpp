@@ -1,4 +1,6 @@
 #include "OCCHandler.h"
+#include "SprayLog.h"
+#include "SprayProfiler.h"
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
 #include <BRep_Builder.hxx>
@@ -15,13 +17,92 @@
 #include <map>
 #include <vector>
 #include <algorithm>
+#include <OSD_Parallel.hxx>
+#include <Message_ProgressScope.hxx>
+#include "OcclusionCache.h"
+
+// 遮挡计算中一个面的辅助信息
+struct OcclusionFaceInfo {
+    TopoDS_Shape face;     // 面
+    Bnd_Box box;           // 包围盒
+    OcclusionFaceKey key;  // 缓存标识（未启用缓存时为空）
+};
+
+// 收集面的包围盒与缓存标识
+static std::vector<OcclusionFaceInfo> collectFaceInfos(const TopTools_ListOfShape& faces, const OcclusionCache* cache) {
+    std::vector<OcclusionFaceInfo> infos;
+    infos.reserve(faces.Extent());
+    for (TopTools_ListIteratorOfListOfShape it(faces); it.More(); it.Next()) {
+        OcclusionFaceInfo info;
+        info.face = it.Value();
+        BRepBndLib::Add(info.face, info.box);
+        if (cache) {
+            info.key = cache->makeKey(info.face);
+        }
+        infos.push_back(info);
+    }
+    return infos;
+}
+
+// 判断两个包围盒在XY平面上是否相交（包围盒为空时保守地认为相交）
+static bool boxesOverlapInXY(const Bnd_Box& box1, const Bnd_Box& box2) {
+    if (box1.IsVoid() || box2.IsVoid()) {
+        return true;
+    }
+
+    Standard_Real xMin1, yMin1, zMin1, xMax1, yMax1, zMax1;
+    Standard_Real xMin2, yMin2, zMin2, xMax2, yMax2, zMax2;
+    box1.Get(xMin1, yMin1, zMin1, xMax1, yMax1, zMax1);
+    box2.Get(xMin2, yMin2, zMin2, xMax2, yMax2, zMax2);
+
+    return !(xMax1 < xMin2 || xMax2 < xMin1 || yMax1 < yMin2 || yMax2 < yMin1);
+}
+
+// 包围盒中心的Z坐标
+static double boxCenterZ(const Bnd_Box& box) {
+    if (box.IsVoid()) {
+        return 0.0;
+    }
+    Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+    box.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+    return (zMin + zMax) / 2.0;
+}
+
+// 执行布尔运算（可开启OCCT内部并行模式），未完成（含取消）时返回空形状
+// 各面的布尔运算并发执行，输入之间共享边和顶点（投影变换也不复制TShape），必须使用非破坏模式
+static TopoDS_Shape runBooleanOperation(BRepAlgoAPI_BooleanOperation& operation,
+                                        const TopoDS_Shape& object,
+                                        const TopoDS_Shape& tool,
+                                        bool runParallel,
+                                        const Message_ProgressRange& range = Message_ProgressRange()) {
+    TopTools_ListOfShape arguments;
+    TopTools_ListOfShape tools;
+    arguments.Append(object);
+    tools.Append(tool);
+
+    operation.SetArguments(arguments);
+    operation.SetTools(tools);
+    operation.SetNonDestructive(Standard_True);
+    operation.SetRunParallel(runParallel ? Standard_True : Standard_False);
+    SPRAY_COUNTER_ADD("occlusion.booleansAttempted", 1);
+    operation.Build(range);
+
+    if (!operation.IsDone()) {
+        SPRAY_COUNTER_ADD("occlusion.booleansFailed", 1);
+        return TopoDS_Shape();
+    }
+    return operation.Shape();
+}
 
 // 按高度分层并进行遮挡裁剪
-TopoDS_Shape OCCHandler::removeOccludedPortions(const TopoDS_Shape& extractedFaces, double heightTolerance) {
-    std::cout << "🔍 开始按高度分层并进行遮挡裁剪..." << std::endl;
+TopoDS_Shape OCCHandler::removeOccludedPortions(const TopoDS_Shape& extractedFaces, double heightTolerance,
+                                                const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("occ.removeOccludedPortions");
+
+    SPRAY_LOG_INFO << "🔍 开始按高度分层并进行遮挡裁剪...";
 
     if (extractedFaces.IsNull()) {
-        std::cerr << "⚠️ 输入的形状为空，无法处理遮挡" << std::endl;
+        SPRAY_LOG_WARN << "⚠️ 输入的形状为空，无法处理遮挡";
         return TopoDS_Shape();
     }
 
@@ -32,21 +113,22 @@ TopoDS_Shape OCCHandler::removeOccludedPortions(const TopoDS_Shape& extractedFac
     }
 
     if (allFaces.IsEmpty()) {
-        std::cerr << "⚠️ 没有找到可处理的面" << std::endl;
+        SPRAY_LOG_WARN << "⚠️ 没有找到可处理的面";
         return TopoDS_Shape();
     }
 
-    std::cout << "📊 输入面数量: " << allFaces.Extent() << std::endl;
+    SPRAY_LOG_INFO << "📊 输入面数量: " << allFaces.Extent();
+    SPRAY_COUNTER_ADD("occlusion.facesIn", allFaces.Extent());
 
     // 按高度分层
     std::map<double, TopTools_ListOfShape> layeredFaces = groupFacesByHeight(allFaces, heightTolerance);
 
     if (layeredFaces.empty()) {
-        std::cerr << "⚠️ 分层失败" << std::endl;
+        SPRAY_LOG_WARN << "⚠️ 分层失败";
         return TopoDS_Shape();
     }
 
-    std::cout << "📋 分层完成，共 " << layeredFaces.size() << " 层" << std::endl;
+    SPRAY_LOG_INFO << "📋 分层完成，共 " << layeredFaces.size() << " 层";
 
     // 将分层结果转换为向量，便于处理
     std::vector<std::pair<double, TopTools_ListOfShape>> layers(layeredFaces.begin(), layeredFaces.end());
@@ -56,19 +138,33 @@ TopoDS_Shape OCCHandler::removeOccludedPortions(const TopoDS_Shape& extractedFac
         return a.first > b.first; // 降序排列
     });
 
-    std::cout << "🔄 开始逐层遮挡处理..." << std::endl;
+    // 遮挡结果缓存：投影方向为世界Z轴，按当前模型整体变换换算到模型坐标系
+    OcclusionCache* cache = occlusionCacheEnabled ? occlusionCache.get() : nullptr;
+    if (cache) {
+        cache->beginRun(modelTransform, gp_Dir(0, 0, 1));
+    }
+
+    // 各层（处理后）面的XY包围盒与缓存标识，用于构建遮挡面签名
+    std::vector<std::vector<OcclusionFaceInfo>> layerInfos(layers.size());
+
+    SPRAY_LOG_INFO << "🔄 开始逐层遮挡处理..." << (parallelMode ? "（并行模式）" : "");
+
+    // 进度：逐层裁剪占大部分时间，跨层检查次之；取消时不写入缓存，直接返回空形状
+    Message_ProgressScope scope(range, "遮挡裁剪", 4);
+    Message_ProgressScope layerScope(scope.Next(3), "逐层裁剪", static_cast<Standard_Real>(layers.size()));
 
     // 逐层处理遮挡
-    for (size_t i = 0; i < layers.size(); i++) {
+    for (size_t i = 0; i < layers.size() && layerScope.More(); i++) {
+        Message_ProgressRange layerRange = layerScope.Next();
         double currentHeight = layers[i].first;
         TopTools_ListOfShape& currentLayerFaces = layers[i].second;
 
-        std::cout << "\n🎯 处理第 " << (i + 1) << " 层 (Z=" << currentHeight << "), "
-                  << currentLayerFaces.Extent() << " 个面" << std::endl;
+        SPRAY_LOG_DEBUG << "\n🎯 处理第 " << (i + 1) << " 层 (Z=" << currentHeight << "), "
+                        << currentLayerFaces.Extent() << " 个面";
 
-        // 首先处理同层内的重叠面
+        // 首先处理同层内的重叠面（结果依赖处理顺序，保持串行）
         if (currentLayerFaces.Extent() > 1) {
-            std::cout << "   🔍 处理同层内的重叠面..." << std::endl;
+            SPRAY_LOG_DEBUG << "   🔍 处理同层内的重叠面...";
             TopTools_ListOfShape processedSameLayerFaces;
 
             for (TopTools_ListIteratorOfListOfShape it1(currentLayerFaces); it1.More(); it1.Next()) {
@@ -90,145 +186,200 @@ TopoDS_Shape OCCHandler::removeOccludedPortions(const TopoDS_Shape& extractedFac
             }
 
             currentLayerFaces = processedSameLayerFaces;
-            std::cout << "     ✅ 同层重叠处理完成，剩余 " << currentLayerFaces.Extent() << " 个面" << std::endl;
+            SPRAY_LOG_DEBUG << "     ✅ 同层重叠处理完成，剩余 " << currentLayerFaces.Extent() << " 个面";
+        }
+
+        // 最高层不被任何面遮挡
+        if (i == 0) {
+            layerInfos[i] = collectFaceInfos(currentLayerFaces, cache);
+            continue;
         }
 
-        // 当前层的面需要被所有上层的面遮挡裁剪
-        for (size_t j = 0; j < i; j++) {
-            double upperHeight = layers[j].first;
-            const TopTools_ListOfShape& upperLayerFaces = layers[j].second;
-
-            std::cout << "   🔍 检查被第 " << (j + 1) << " 层 (Z=" << upperHeight << ") 的遮挡..." << std::endl;
-
-            // 对当前层的每个面进行遮挡检查和裁剪
-            TopTools_ListOfShape processedFaces;
-
-            for (TopTools_ListIteratorOfListOfShape currentIt(currentLayerFaces); currentIt.More(); currentIt.Next()) {
-                TopoDS_Face currentFace = TopoDS::Face(currentIt.Value());
-                TopoDS_Shape resultFace = currentFace;
-
-                // 检查当前面是否被上层的任何面遮挡
-                for (TopTools_ListIteratorOfListOfShape upperIt(upperLayerFaces); upperIt.More(); upperIt.Next()) {
-                    TopoDS_Face upperFace = TopoDS::Face(upperIt.Value());
-
-                    // 检查两个面是否在XY平面上重叠
-                    if (checkFaceOverlapInXY(resultFace, upperFace)) {
-                        // 如果重叠，进行布尔裁剪
-                        TopoDS_Shape projectedUpperFace = projectFaceToPlane(upperFace, currentHeight);
-
-                        if (!projectedUpperFace.IsNull()) {
-                            try {
-                                BRepAlgoAPI_Cut cutter(resultFace, projectedUpperFace);
-                                if (cutter.IsDone()) {
-                                    TopoDS_Shape cutResult = cutter.Shape();
-                                    if (!cutResult.IsNull()) {
-                                        resultFace = cutResult;
-                                    }
-                                }
-                            } catch (...) {
-                                std::cerr << "⚠️ 布尔裁剪操作失败，保持原面" << std::endl;
-                            }
+        SPRAY_LOG_DEBUG << "   🔍 检查被上方 " << i << " 层的遮挡...";
+
+        // 当前层的每个面互相独立：并发裁剪，结果写入各自槽位后按原顺序收集，保证输出确定
+        std::vector<OcclusionFaceInfo> faceInfos = collectFaceInfos(currentLayerFaces, cache);
+        const size_t faceCount = faceInfos.size();
+
+        std::vector<TopTools_ListOfShape> clippedFaces(faceCount);
+        std::vector<char> needsCut(faceCount, 1);
+        std::vector<std::vector<OcclusionFaceKey>> signatures(faceCount);
+        std::vector<TopTools_ListOfShape> occluders(faceCount);
+        std::vector<long long> heightOffsets(faceCount, 0);
+
+        // 先查缓存：遮挡面签名与投影高度都未变化的面直接复用上次的裁剪结果
+        if (cache) {
+            for (size_t k = 0; k < faceCount; k++) {
+                const OcclusionFaceInfo& info = faceInfos[k];
+                for (size_t j = 0; j < i; j++) {
+                    signatures[k].push_back(OcclusionCache::layerSeparator(static_cast<int>(j)));
+                    for (const OcclusionFaceInfo& upperInfo : layerInfos[j]) {
+                        if (boxesOverlapInXY(info.box, upperInfo.box)) {
+                            signatures[k].push_back(upperInfo.key);
+                            occluders[k].Append(upperInfo.face);
                         }
                     }
                 }
+                heightOffsets[k] = OcclusionCache::quantize(currentHeight - boxCenterZ(info.box));
 
-                // 如果裁剪后的面不为空，添加到处理结果中
-                if (!resultFace.IsNull()) {
-                    // 检查结果是否包含面
-                    bool hasFaces = false;
-                    for (TopExp_Explorer faceExp(resultFace, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
-                        processedFaces.Append(faceExp.Current());
-                        hasFaces = true;
-                    }
-
-                    if (!hasFaces) {
-                        std::cout << "     ❌ 面被完全遮挡，已移除" << std::endl;
-                    }
+                if (cache->findCutResult(info.key, signatures[k], heightOffsets[k], clippedFaces[k])) {
+                    needsCut[k] = 0;
                 }
             }
+        }
 
-            // 更新当前层的面列表
-            currentLayerFaces = processedFaces;
+        // 每个面的进度范围在主线程中预先分配，工作线程只推进自己的范围
+        Message_ProgressScope faceScope(layerRange, "面", static_cast<Standard_Real>(faceCount));
+        std::vector<Message_ProgressRange> faceRanges;
+        faceRanges.reserve(faceCount);
+        for (size_t k = 0; k < faceCount; k++) {
+            faceRanges.push_back(faceScope.Next());
+            if (!needsCut[k]) {
+                faceRanges.back().Close();
+            }
+        }
 
-            std::cout << "     ✅ 遮挡处理完成，剩余 " << currentLayerFaces.Extent() << " 个面" << std::endl;
+        OSD_Parallel::For(0, static_cast<int>(faceCount), [&](int k) {
+            if (needsCut[k] && !faceRanges[k].UserBreak()) {
+                clippedFaces[k] = cutFaceByUpperLayers(TopoDS::Face(faceInfos[k].face), layers, i, faceRanges[k]);
+            }
+        }, !parallelMode);
+
+        // 取消时本层结果不完整，不能写入缓存
+        if (!faceScope.More()) {
+            break;
+        }
+
+        // 更新当前层的面列表
+        TopTools_ListOfShape processedFaces;
+        int fullyOccludedCount = 0;
+        for (size_t k = 0; k < faceCount; k++) {
+            if (cache && needsCut[k]) {
+                cache->storeCutResult(faceInfos[k].key, faceInfos[k].face, signatures[k], occluders[k],
+                                      heightOffsets[k], clippedFaces[k]);
+            }
+            if (clippedFaces[k].IsEmpty()) {
+                fullyOccludedCount++;
+            }
+            processedFaces.Append(clippedFaces[k]);
+        }
+        currentLayerFaces = processedFaces;
+        layerInfos[i] = collectFaceInfos(currentLayerFaces, cache);
+
+        SPRAY_COUNTER_ADD("occlusion.facesFullyOccluded", fullyOccludedCount);
+        if (fullyOccludedCount > 0) {
+            SPRAY_LOG_DEBUG << "     ❌ " << fullyOccludedCount << " 个面被完全遮挡，已移除";
         }
+        SPRAY_LOG_DEBUG << "     ✅ 遮挡处理完成，剩余 " << currentLayerFaces.Extent() << " 个面";
+    }
+
+    if (!layerScope.More()) {
+        SPRAY_LOG_INFO << "⏹️ 已取消遮挡裁剪";
+        return TopoDS_Shape();
     }
 
     // 后处理：检查跨层遮挡
-    std::cout << "\n🔄 后处理：检查跨层遮挡..." << std::endl;
-    for (size_t i = 0; i < layers.size(); i++) {
-        double currentHeight = layers[i].first;
+    SPRAY_LOG_INFO << "\n🔄 后处理：检查跨层遮挡...";
+    Message_ProgressScope crossScope(scope.Next(), "跨层遮挡检查", static_cast<Standard_Real>(layers.size()));
+
+    // 所有更高层（已完成后处理）的面
+    TopTools_ListOfShape allHigherFaces;
+    std::vector<OcclusionFaceInfo> higherInfos;
+
+    for (size_t i = 0; i < layers.size() && crossScope.More(); i++) {
+        Message_ProgressRange layerRange = crossScope.Next();
         TopTools_ListOfShape& currentLayerFaces = layers[i].second;
+        const std::vector<OcclusionFaceInfo>& faceInfos = layerInfos[i];
 
         if (currentLayerFaces.IsEmpty()) continue;
 
-        // 收集所有更高层的面
-        TopTools_ListOfShape allHigherFaces;
-        for (size_t j = 0; j < i; j++) {
-            for (TopTools_ListIteratorOfListOfShape it(layers[j].second); it.More(); it.Next()) {
-                allHigherFaces.Append(it.Value());
-            }
-        }
-
         if (!allHigherFaces.IsEmpty()) {
-            std::cout << "   🎯 检查第 " << (i + 1) << " 层被 " << allHigherFaces.Extent() << " 个更高层面的跨层遮挡..." << std::endl;
-
-            TopTools_ListOfShape finalLayerFaces;
-            for (TopTools_ListIteratorOfListOfShape currentIt(currentLayerFaces); currentIt.More(); currentIt.Next()) {
-                TopoDS_Shape currentFace = currentIt.Value();
-                bool isCompletelyOccluded = false;
-
-                // 检查是否被任何更高层的面完全遮挡
-                for (TopTools_ListIteratorOfListOfShape higherIt(allHigherFaces); higherIt.More(); higherIt.Next()) {
-                    TopoDS_Shape higherFace = higherIt.Value();
-
-                    // 计算重叠程度
-                    if (checkFaceOverlapInXY(currentFace, higherFace)) {
-                        // 计算重叠面积比例
-                        try {
-                            TopoDS_Shape proj1 = projectFaceToPlane(currentFace, 0.0);
-                            TopoDS_Shape proj2 = projectFaceToPlane(higherFace, 0.0);
-
-                            if (!proj1.IsNull() && !proj2.IsNull()) {
-                                GProp_GProps props1, props2;
-                                BRepGProp::SurfaceProperties(proj1, props1);
-                                BRepGProp::SurfaceProperties(proj2, props2);
-
-                                BRepAlgoAPI_Common commonOp(proj1, proj2);
-                                if (commonOp.IsDone()) {
-                                    TopoDS_Shape intersection = commonOp.Shape();
-                                    if (!intersection.IsNull()) {
-                                        GProp_GProps intersectionProps;
-                                        BRepGProp::SurfaceProperties(intersection, intersectionProps);
-
-                                        double currentArea = props1.Mass();
-                                        double intersectionArea = intersectionProps.Mass();
-
-                                        // 如果当前面被遮挡超过80%，认为完全遮挡
-                                        if (intersectionArea > currentArea * 0.8) {
-                                            isCompletelyOccluded = true;
-                                            break;
-                                        }
-                                    }
-                                }
-                            }
-                        } catch (...) {
-                            // 忽略计算错误
+            SPRAY_LOG_DEBUG << "   🎯 检查第 " << (i + 1) << " 层被 " << allHigherFaces.Extent() << " 个更高层面的跨层遮挡...";
+
+            const size_t faceCount = faceInfos.size();
+            std::vector<char> occludedFlags(faceCount, 0);
+            std::vector<char> needsCheck(faceCount, 1);
+            std::vector<std::vector<OcclusionFaceKey>> signatures(faceCount);
+            std::vector<TopTools_ListOfShape> occluders(faceCount);
+
+            if (cache) {
+                for (size_t k = 0; k < faceCount; k++) {
+                    for (const OcclusionFaceInfo& higherInfo : higherInfos) {
+                        if (boxesOverlapInXY(faceInfos[k].box, higherInfo.box)) {
+                            signatures[k].push_back(higherInfo.key);
+                            occluders[k].Append(higherInfo.face);
                         }
                     }
+
+                    bool mostlyOccluded = false;
+                    if (cache->findCoverageResult(faceInfos[k].key, signatures[k], mostlyOccluded)) {
+                        occludedFlags[k] = mostlyOccluded ? 1 : 0;
+                        needsCheck[k] = 0;
+                    }
                 }
+            }
+
+            Message_ProgressScope faceScope(layerRange, "面", static_cast<Standard_Real>(faceCount));
+            std::vector<Message_ProgressRange> faceRanges;
+            faceRanges.reserve(faceCount);
+            for (size_t k = 0; k < faceCount; k++) {
+                faceRanges.push_back(faceScope.Next());
+                if (!needsCheck[k]) {
+                    faceRanges.back().Close();
+                }
+            }
 
-                if (!isCompletelyOccluded) {
-                    finalLayerFaces.Append(currentFace);
+            // 逐面并发判断是否被完全遮挡
+            OSD_Parallel::For(0, static_cast<int>(faceCount), [&](int k) {
+                if (needsCheck[k] && !faceRanges[k].UserBreak()) {
+                    occludedFlags[k] = isFaceMostlyOccluded(faceInfos[k].face, allHigherFaces, faceRanges[k]) ? 1 : 0;
+                }
+            }, !parallelMode);
+
+            if (!faceScope.More()) {
+                break;
+            }
+
+            TopTools_ListOfShape finalLayerFaces;
+            std::vector<OcclusionFaceInfo> finalInfos;
+            for (size_t k = 0; k < faceCount; k++) {
+                if (cache && needsCheck[k]) {
+                    cache->storeCoverageResult(faceInfos[k].key, faceInfos[k].face, signatures[k], occluders[k],
+                                               occludedFlags[k] != 0);
+                }
+                if (!occludedFlags[k]) {
+                    finalLayerFaces.Append(faceInfos[k].face);
+                    finalInfos.push_back(faceInfos[k]);
                 }
             }
 
             int removedCount = currentLayerFaces.Extent() - finalLayerFaces.Extent();
+            SPRAY_COUNTER_ADD("occlusion.facesPrunedCrossLayer", removedCount);
             if (removedCount > 0) {
-                std::cout << "     ❌ 移除了 " << removedCount << " 个被跨层遮挡的面" << std::endl;
+                SPRAY_LOG_DEBUG << "     ❌ 移除了 " << removedCount << " 个被跨层遮挡的面";
             }
             currentLayerFaces = finalLayerFaces;
+            layerInfos[i] = finalInfos;
         }
+
+        // 当前层处理完成后成为更低层的遮挡面
+        for (const OcclusionFaceInfo& info : layerInfos[i]) {
+            allHigherFaces.Append(info.face);
+            higherInfos.push_back(info);
+        }
+    }
+
+    if (!crossScope.More()) {
+        SPRAY_LOG_INFO << "⏹️ 已取消遮挡裁剪";
+        return TopoDS_Shape();
+    }
+
+    if (cache) {
+        int cacheHits = 0, cacheMisses = 0;
+        cache->endRun(cacheHits, cacheMisses);
+        SPRAY_COUNTER_ADD("occlusion.cacheHits", cacheHits);
+        SPRAY_COUNTER_ADD("occlusion.cacheMisses", cacheMisses);
+        SPRAY_LOG_INFO << "\n♻️ 遮挡缓存: 复用 " << cacheHits << " 个结果，重新计算 " << cacheMisses << " 个";
     }
 
     // 收集所有处理后的面
@@ -242,14 +393,14 @@ TopoDS_Shape OCCHandler::removeOccludedPortions(const TopoDS_Shape& extractedFac
         }
     }
 
-    std::cout << "\n📊 遮挡处理完成:" << std::endl;
-    std::cout << "   输入面数: " << allFaces.Extent() << std::endl;
-    std::cout << "   输出面数: " << totalProcessedFaces << std::endl;
-    std::cout << "   移除面数: " << (allFaces.Extent() - totalProcessedFaces) << std::endl;
+    SPRAY_LOG_INFO << "\n📊 遮挡处理完成:";
+    SPRAY_LOG_INFO << "   输入面数: " << allFaces.Extent();
+    SPRAY_LOG_INFO << "   输出面数: " << totalProcessedFaces;
+    SPRAY_LOG_INFO << "   移除面数: " << (allFaces.Extent() - totalProcessedFaces);
 
     // 创建最终的复合形状
     if (finalFaces.IsEmpty()) {
-        std::cerr << "⚠️ 所有面都被遮挡，返回空形状" << std::endl;
+        SPRAY_LOG_WARN << "⚠️ 所有面都被遮挡，返回空形状";
         return TopoDS_Shape();
     }
 
@@ -262,15 +413,128 @@ TopoDS_Shape OCCHandler::removeOccludedPortions(const TopoDS_Shape& extractedFac
             builder.Add(compound, it.Value());
         }
 
-        std::cout << "✅ 遮挡裁剪完成！" << std::endl;
+        SPRAY_LOG_INFO << "✅ 遮挡裁剪完成！";
         return compound;
 
     } catch (...) {
-        std::cerr << "❌ 创建最终形状时发生异常" << std::endl;
+        SPRAY_LOG_ERROR << "❌ 创建最终形状时发生异常";
         return TopoDS_Shape();
     }
 }
 
+// 用所有更高层的面依次裁剪单个面，返回裁剪后剩余的面片
+TopTools_ListOfShape OCCHandler::cutFaceByUpperLayers(const TopoDS_Face& face,
+                                                      const std::vector<std::pair<double, TopTools_ListOfShape>>& layers,
+                                                      size_t layerIndex,
+                                                      const Message_ProgressRange& range) const {
+    SPRAY_PROFILE_SCOPE("occ.cutFaceByUpperLayers");
+
+    Message_ProgressScope scope(range, nullptr, static_cast<Standard_Real>(layerIndex));
+
+    double currentHeight = layers[layerIndex].first;
+
+    TopTools_ListOfShape fragments;
+    fragments.Append(face);
+
+    // 逐个上层裁剪：上一层裁剪产生的面片继续被下一个上层裁剪
+    for (size_t j = 0; j < layerIndex && !fragments.IsEmpty() && scope.More(); j++) {
+        const TopTools_ListOfShape& upperLayerFaces = layers[j].second;
+        TopTools_ListOfShape nextFragments;
+
+        // 布尔运算次数事先未知，使用无限步数的作用域
+        Message_ProgressScope upperScope(scope.Next(), nullptr, 1, Standard_True);
+
+        for (TopTools_ListIteratorOfListOfShape fragmentIt(fragments); fragmentIt.More(); fragmentIt.Next()) {
+            TopoDS_Shape resultFace = fragmentIt.Value();
+
+            // 检查当前面是否被上层的任何面遮挡
+            for (TopTools_ListIteratorOfListOfShape upperIt(upperLayerFaces); upperIt.More() && upperScope.More(); upperIt.Next()) {
+                const TopoDS_Shape& upperFace = upperIt.Value();
+
+                // 检查两个面是否在XY平面上重叠
+                if (!checkFaceOverlapInXY(resultFace, upperFace)) {
+                    continue;
+                }
+
+                // 如果重叠，进行布尔裁剪
+                TopoDS_Shape projectedUpperFace = projectFaceToPlane(upperFace, currentHeight);
+                if (projectedUpperFace.IsNull()) {
+                    continue;
+                }
+
+                try {
+                    BRepAlgoAPI_Cut cutter;
+                    TopoDS_Shape cutResult = runBooleanOperation(cutter, resultFace, projectedUpperFace, parallelMode,
+                                                                 upperScope.Next());
+                    if (!cutResult.IsNull()) {
+                        resultFace = cutResult;
+                    }
+                } catch (...) {
+                    SPRAY_COUNTER_ADD("occlusion.booleansFailed", 1);
+                    SPRAY_LOG_EVERY_N(SprayLogLevel::Warn, 50) << "⚠️ 布尔裁剪操作失败，保持原面";
+                }
+            }
+
+            // 裁剪结果可能是多个面片，也可能已不含任何面（完全遮挡）
+            for (TopExp_Explorer faceExp(resultFace, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
+                nextFragments.Append(faceExp.Current());
+            }
+        }
+
+        fragments = nextFragments;
+    }
+
+    return fragments;
+}
+
+// 检查面是否被更高层的某个面遮挡超过80%
+bool OCCHandler::isFaceMostlyOccluded(const TopoDS_Shape& face, const TopTools_ListOfShape& higherFaces,
+                                      const Message_ProgressRange& range) const {
+    SPRAY_PROFILE_SCOPE("occ.isFaceMostlyOccluded");
+
+    Message_ProgressScope scope(range, nullptr, 1, Standard_True);
+    for (TopTools_ListIteratorOfListOfShape higherIt(higherFaces); higherIt.More() && scope.More(); higherIt.Next()) {
+        const TopoDS_Shape& higherFace = higherIt.Value();
+
+        // 计算重叠程度
+        if (!checkFaceOverlapInXY(face, higherFace)) {
+            continue;
+        }
+
+        // 计算重叠面积比例
+        try {
+            TopoDS_Shape proj1 = projectFaceToPlane(face, 0.0);
+            TopoDS_Shape proj2 = projectFaceToPlane(higherFace, 0.0);
+
+            if (proj1.IsNull() || proj2.IsNull()) {
+                continue;
+            }
+
+            GProp_GProps props1;
+            BRepGProp::SurfaceProperties(proj1, props1);
+
+            BRepAlgoAPI_Common commonOp;
+            TopoDS_Shape intersection = runBooleanOperation(commonOp, proj1, proj2, parallelMode, scope.Next());
+            if (!intersection.IsNull()) {
+                GProp_GProps intersectionProps;
+                BRepGProp::SurfaceProperties(intersection, intersectionProps);
+
+                double currentArea = props1.Mass();
+                double intersectionArea = intersectionProps.Mass();
+
+                // 如果当前面被遮挡超过80%，认为完全遮挡
+                if (intersectionArea > currentArea * 0.8) {
+                    return true;
+                }
+            }
+        } catch (...) {
+            // 忽略计算错误
+        }
+    }
+
+    return false;
+}
+
 // 检查两个面是否在XY平面上重叠
 bool OCCHandler::checkFaceOverlapInXY(const TopoDS_Shape& face1, const TopoDS_Shape& face2) const {
     try {
@@ -296,18 +560,16 @@ bool OCCHandler::checkFaceOverlapInXY(const TopoDS_Shape& face1, const TopoDS_Sh
 
         // 尝试计算交集
         try {
-            BRepAlgoAPI_Common commonOp(proj1, proj2);
-            if (commonOp.IsDone()) {
-                TopoDS_Shape intersection = commonOp.Shape();
-                if (!intersection.IsNull()) {
-                    GProp_GProps intersectionProps;
-                    BRepGProp::SurfaceProperties(intersection, intersectionProps);
-                    double intersectionArea = intersectionProps.Mass();
-                    
-                    // 如果交集面积大于较小面积的20%，认为有重叠
-                    double minArea = std::min(area1, area2);
-                    return (intersectionArea > minArea * 0.2);
-                }
+            BRepAlgoAPI_Common commonOp;
+            TopoDS_Shape intersection = runBooleanOperation(commonOp, proj1, proj2, parallelMode);
+            if (!intersection.IsNull()) {
+                GProp_GProps intersectionProps;
+                BRepGProp::SurfaceProperties(intersection, intersectionProps);
+                double intersectionArea = intersectionProps.Mass();
+
+                // 如果交集面积大于较小面积的20%，认为有重叠
+                double minArea = std::min(area1, area2);
+                return (intersectionArea > minArea * 0.2);
             }
         } catch (...) {
             // 如果布尔运算失败，使用边界盒检查
@@ -343,7 +605,7 @@ TopoDS_Shape OCCHandler::projectFaceToPlane(const TopoDS_Shape& face, double tar
         return transformer.Shape();
         
     } catch (...) {
-        std::cerr << "❌ 投影面到平面时发生异常" << std::endl;
+        SPRAY_LOG_ERROR << "❌ 投影面到平面时发生异常";
         return TopoDS_Shape();
     }
 }
@@ -374,7 +636,7 @@ TopoDS_Shape OCCHandler::moveShapeToPlane(const TopoDS_Shape& shape, double targ
         return transformer.Shape();
         
     } catch (...) {
-        std::cerr << "❌ 移动形状时发生异常" << std::endl;
+        SPRAY_LOG_ERROR << "❌ 移动形状时发生异常";
         return TopoDS_Shape();
     }
 }
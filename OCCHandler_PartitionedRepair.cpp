@@ -0,0 +1,259 @@
+#include "OCCHandler.h"
+#include "SprayLog.h"
+#include "SprayProfiler.h"
+#include <Bnd_Box.hxx>
+#include <Bnd_BoundSortBox.hxx>
+#include <Bnd_HArray1OfBox.hxx>
+#include <BRepBndLib.hxx>
+#include <BRep_Builder.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_TShape.hxx>
+#include <TColStd_ListOfInteger.hxx>
+#include <OSD_Parallel.hxx>
+#include <Message_ProgressScope.hxx>
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+// 并查集：合并必须一起修复的部分
+class RepairUnionFind {
+public:
+    explicit RepairUnionFind(size_t count) : parent(count) {
+        std::iota(parent.begin(), parent.end(), 0);
+    }
+
+    size_t find(size_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    void unite(size_t a, size_t b) {
+        a = find(a);
+        b = find(b);
+        if (a != b) {
+            parent[std::max(a, b)] = std::min(a, b);
+        }
+    }
+
+private:
+    std::vector<size_t> parent;
+};
+
+// 统计形状中的面数量
+static int countRepairFaces(const TopoDS_Shape& shape) {
+    int count = 0;
+    for (TopExp_Explorer exp(shape, TopAbs_FACE); exp.More(); exp.Next()) {
+        count++;
+    }
+    return count;
+}
+
+// 设置是否分区修复
+void OCCHandler::setPartitionedRepair(bool enabled) {
+    partitionedRepair = enabled;
+}
+
+// 是否分区修复
+bool OCCHandler::isPartitionedRepair() const {
+    return partitionedRepair;
+}
+
+// 将模型拆分为可以独立修复的部分：
+// - 每个实体单独一部分（实体之间不缝合）；
+// - 不属于实体的壳和不属于壳的面按包围盒（放大容差）相交聚类，可能缝合在一起的面总在同一部分；
+// - 共享面、边或顶点（同一TShape，如装配体中的多个实例、只在边上相接的壳）的部分合并，
+//   避免多个线程同时修改同一拓扑；
+// - 不属于面的线框、边和顶点不参与修复，放入untouched原样保留
+std::vector<TopoDS_Shape> OCCHandler::partitionForRepair(double tolerance, std::vector<TopoDS_Shape>& untouched) const {
+    untouched.clear();
+    for (TopExp_Explorer exp(shape, TopAbs_WIRE, TopAbs_FACE); exp.More(); exp.Next()) {
+        untouched.push_back(exp.Current());
+    }
+    for (TopExp_Explorer exp(shape, TopAbs_EDGE, TopAbs_WIRE); exp.More(); exp.Next()) {
+        untouched.push_back(exp.Current());
+    }
+    for (TopExp_Explorer exp(shape, TopAbs_VERTEX, TopAbs_EDGE); exp.More(); exp.Next()) {
+        untouched.push_back(exp.Current());
+    }
+
+    std::vector<TopoDS_Shape> units;
+    std::vector<bool> isSolid;
+    for (TopExp_Explorer exp(shape, TopAbs_SOLID); exp.More(); exp.Next()) {
+        units.push_back(exp.Current());
+        isSolid.push_back(true);
+    }
+    for (TopExp_Explorer exp(shape, TopAbs_SHELL, TopAbs_SOLID); exp.More(); exp.Next()) {
+        units.push_back(exp.Current());
+        isSolid.push_back(false);
+    }
+    for (TopExp_Explorer exp(shape, TopAbs_FACE, TopAbs_SHELL); exp.More(); exp.Next()) {
+        units.push_back(exp.Current());
+        isSolid.push_back(false);
+    }
+    if (units.size() <= 1) {
+        return units;
+    }
+
+    RepairUnionFind groups(units.size());
+
+    // 共享面、边或顶点的部分合并
+    std::unordered_map<const TopoDS_TShape*, size_t> owner;
+    for (TopAbs_ShapeEnum type : { TopAbs_FACE, TopAbs_EDGE, TopAbs_VERTEX }) {
+        for (size_t i = 0; i < units.size(); i++) {
+            for (TopExp_Explorer exp(units[i], type); exp.More(); exp.Next()) {
+                auto inserted = owner.emplace(exp.Current().TShape().get(), i);
+                if (!inserted.second) {
+                    groups.unite(inserted.first->second, i);
+                }
+            }
+        }
+    }
+
+    // 壳和散面按包围盒聚类
+    std::vector<size_t> looseUnits;
+    for (size_t i = 0; i < units.size(); i++) {
+        if (!isSolid[i]) {
+            looseUnits.push_back(i);
+        }
+    }
+    if (looseUnits.size() > 1) {
+        Handle(Bnd_HArray1OfBox) boxes = new Bnd_HArray1OfBox(1, static_cast<Standard_Integer>(looseUnits.size()));
+        Bnd_Box totalBox;
+        for (size_t k = 0; k < looseUnits.size(); k++) {
+            Bnd_Box box;
+            BRepBndLib::Add(units[looseUnits[k]], box);
+            box.Enlarge(tolerance);
+            boxes->SetValue(static_cast<Standard_Integer>(k + 1), box);
+            totalBox.Add(box);
+        }
+
+        Bnd_BoundSortBox sorter;
+        sorter.Initialize(totalBox, boxes);
+        for (size_t k = 0; k < looseUnits.size(); k++) {
+            const TColStd_ListOfInteger& hits = sorter.Compare(boxes->Value(static_cast<Standard_Integer>(k + 1)));
+            for (TColStd_ListOfInteger::Iterator it(hits); it.More(); it.Next()) {
+                groups.unite(looseUnits[k], looseUnits[static_cast<size_t>(it.Value() - 1)]);
+            }
+        }
+    }
+
+    // 按并查集结果组装各部分
+    std::vector<TopoDS_Shape> partitions;
+    std::vector<int> partitionOf(units.size(), -1);
+    std::vector<std::vector<size_t>> members;
+    for (size_t i = 0; i < units.size(); i++) {
+        size_t root = groups.find(i);
+        if (partitionOf[root] < 0) {
+            partitionOf[root] = static_cast<int>(members.size());
+            members.emplace_back();
+        }
+        members[partitionOf[root]].push_back(i);
+    }
+
+    BRep_Builder builder;
+    for (const std::vector<size_t>& group : members) {
+        if (group.size() == 1) {
+            partitions.push_back(units[group.front()]);
+            continue;
+        }
+        TopoDS_Compound compound;
+        builder.MakeCompound(compound);
+        for (size_t i : group) {
+            builder.Add(compound, units[i]);
+        }
+        partitions.push_back(compound);
+    }
+    return partitions;
+}
+
+// 分区并行修复：每部分在独立的处理器中执行同一修复流程，结果按原顺序组成复合体（不属于面的子形状原样附加）。
+// 只有一个部分时返回false（不处理），由调用方按原流程修复整个模型
+bool OCCHandler::repairPartitioned(const char* name, double tolerance, bool verbose, const PartRepairFunction& repair,
+                                   const Message_ProgressRange& range, bool& succeeded) {
+    SPRAY_PROFILE_SCOPE("occ.repairPartitioned");
+
+    std::vector<TopoDS_Shape> untouched;
+    std::vector<TopoDS_Shape> partitions = partitionForRepair(tolerance, untouched);
+    if (partitions.size() <= 1) {
+        return false;
+    }
+
+    const size_t partCount = partitions.size();
+    SPRAY_COUNTER_ADD("repair.partitions", static_cast<long long>(partCount));
+    if (verbose) {
+        SPRAY_LOG_INFO << "🧩 " << name << "：模型拆分为 " << partCount << " 个部分并行修复";
+    }
+
+    // 面数多的部分先开始，减少最后只剩一个大部分在执行的时间
+    std::vector<int> faceCounts(partCount);
+    for (size_t k = 0; k < partCount; k++) {
+        faceCounts[k] = countRepairFaces(partitions[k]);
+    }
+    std::vector<size_t> order(partCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return faceCounts[a] > faceCounts[b]; });
+
+    // 每部分的进度范围在主线程中预先分配（按面数加权）
+    Message_ProgressScope scope(range, name, static_cast<Standard_Real>(
+        std::accumulate(faceCounts.begin(), faceCounts.end(), 0) + static_cast<int>(partCount)));
+    std::vector<Message_ProgressRange> partRanges;
+    partRanges.reserve(partCount);
+    for (size_t k = 0; k < partCount; k++) {
+        partRanges.push_back(scope.Next(faceCounts[k] + 1));
+    }
+
+    std::vector<TopoDS_Shape> repaired(partCount);
+    std::vector<char> partSucceeded(partCount, 0);
+    OSD_Parallel::For(0, static_cast<int>(partCount), [&](int n) {
+        size_t k = order[n];
+        if (partRanges[k].UserBreak()) {
+            return;
+        }
+        OCCHandler part;
+        part.shape = partitions[k];
+        part.setParallelMode(false);
+        partSucceeded[k] = repair(part, partRanges[k]) ? 1 : 0;
+        repaired[k] = partSucceeded[k] ? part.shape : partitions[k];
+    }, !parallelMode);
+
+    if (!scope.More()) {
+        succeeded = false;
+        return true;
+    }
+
+    TopoDS_Compound compound;
+    BRep_Builder builder;
+    builder.MakeCompound(compound);
+    int successCount = 0;
+    for (size_t k = 0; k < partCount; k++) {
+        if (!repaired[k].IsNull()) {
+            builder.Add(compound, repaired[k]);
+        }
+        successCount += partSucceeded[k];
+    }
+    for (const TopoDS_Shape& leftover : untouched) {
+        builder.Add(compound, leftover);
+    }
+
+    // 修复失败的部分保留原形状；全部失败时视为修复失败，模型保持不变
+    succeeded = successCount > 0;
+    if (succeeded) {
+        shape = compound;
+    }
+    SPRAY_COUNTER_ADD("repair.partitionsFailed", static_cast<long long>(partCount) - successCount);
+    if (verbose) {
+        if (successCount == static_cast<int>(partCount)) {
+            SPRAY_LOG_INFO << "✅ " << name << "：" << partCount << " 个部分全部修复完成";
+        } else {
+            SPRAY_LOG_WARN << "⚠️ " << name << "：" << (partCount - successCount) << "/" << partCount
+                           << " 个部分修复失败，保留原形状";
+        }
+    }
+    return true;
+}
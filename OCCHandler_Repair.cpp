@@ -1,6 +1,8 @@
 #include "OCCHandler.h"
+#include "SprayLog.h"
+#include "SprayProfiler.h"
 #include <BRepCheck_Analyzer.hxx>
-#include <BRepBuilderAPI_Sewing.hxx>
+#include <BRepTools_ReShape.hxx>
 #include <ShapeFix_Shape.hxx>
 #include <ShapeFix_Wire.hxx>
 #include <ShapeFix_Face.hxx>
@@ -42,78 +44,100 @@
 #include <ShapeBuild_ReShape.hxx>
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
+#include <Message_ProgressScope.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopLoc_Location.hxx>
+#include <OSD_Parallel.hxx>
 #include <iostream>
+#include <numeric>
+#include <vector>
 
 // STEP导入后模型修复函数
-bool OCCHandler::repairImportedModel(double tolerance, bool verbose) {
+bool OCCHandler::repairImportedModel(double tolerance, bool verbose, const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("occ.repairImportedModel");
+
     if (shape.IsNull()) {
         if (verbose) {
-            std::cerr << "❌ 没有加载的模型，无法进行修复" << std::endl;
+            SPRAY_LOG_ERROR << "❌ 没有加载的模型，无法进行修复";
         }
         return false;
     }
 
+    // 分区修复：各部分并行执行下面的同一流程
+    bool partitionedResult = false;
+    if (partitionedRepair && repairPartitioned("基础修复", tolerance, verbose,
+            [tolerance](OCCHandler& part, const Message_ProgressRange& partRange) {
+                return part.repairImportedModel(tolerance, false, partRange);
+            }, range, partitionedResult)) {
+        return partitionedResult;
+    }
+
     if (verbose) {
-        std::cout << "🔧 开始STEP模型修复..." << std::endl;
-        std::cout << "📏 使用容差: " << tolerance << std::endl;
+        SPRAY_LOG_INFO << "🔧 开始STEP模型修复...";
+        SPRAY_LOG_INFO << "📏 使用容差: " << tolerance;
     }
 
+    // 进度：缝合、形状修复
+    Message_ProgressScope scope(range, "基础修复", 2);
+
     try {
         // 步骤1: 模型有效性检查
         if (verbose) {
-            std::cout << "\n📋 步骤1: 模型有效性检查..." << std::endl;
+            SPRAY_LOG_INFO << "\n📋 步骤1: 模型有效性检查...";
         }
         
-        BRepCheck_Analyzer analyzer(shape);
-        bool isValid = analyzer.IsValid();
+        // 后备修复时复用修复上下文中对原始模型的诊断
+        const RepairDiagnosis* reusedDiagnosis = trackedRepairDiagnosis();
+        bool isValid = reusedDiagnosis != nullptr ? reusedDiagnosis->valid : BRepCheck_Analyzer(shape).IsValid();
         
         if (verbose) {
             if (isValid) {
-                std::cout << "✅ 模型基本有效" << std::endl;
+                SPRAY_LOG_INFO << "✅ 模型基本有效";
             } else {
-                std::cout << "⚠️ 模型存在问题，需要修复" << std::endl;
+                SPRAY_LOG_WARN << "⚠️ 模型存在问题，需要修复";
             }
         }
 
         // 步骤2: 缝合修复（最重要的修复步骤）
         if (verbose) {
-            std::cout << "\n🧵 步骤2: 缝合修复..." << std::endl;
+            SPRAY_LOG_INFO << "\n🧵 步骤2: 缝合修复...";
         }
         
-        BRepBuilderAPI_Sewing sewing(tolerance);
-        sewing.SetTolerance(tolerance);
-        sewing.SetFaceMode(Standard_True);
-        sewing.SetFloatingEdgesMode(Standard_True);
-        sewing.SetNonManifoldMode(Standard_False);
-        
-        // 添加所有面到缝合器
-        int faceCount = 0;
-        for (TopExp_Explorer faceExp(shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
-            sewing.Add(faceExp.Current());
-            faceCount++;
-        }
-        
-        if (verbose) {
-            std::cout << "   处理 " << faceCount << " 个面..." << std::endl;
-        }
-        
-        sewing.Perform();
-        TopoDS_Shape sewedShape = sewing.SewedShape();
-        
-        if (!sewedShape.IsNull()) {
-            shape = sewedShape;
+        if (resumeSewingFromContext(tolerance)) {
+            scope.Next();
             if (verbose) {
-                std::cout << "✅ 缝合修复成功" << std::endl;
+                SPRAY_LOG_INFO << "♻️ 复用修复上下文中的缝合结果";
             }
         } else {
+            // 缝合所有面
+            int faceCount = 0;
+            Handle(BRepTools_ReShape) sewingHistory;
+            TopoDS_Shape sewedShape = sewAllFaces(tolerance, faceCount, sewingHistory, scope.Next());
+            if (!scope.More()) {
+                return false;
+            }
+
             if (verbose) {
-                std::cout << "⚠️ 缝合修复失败，保持原形状" << std::endl;
+                SPRAY_LOG_INFO << "   处理 " << faceCount << " 个面...";
+            }
+
+            if (!sewedShape.IsNull()) {
+                recordSewingInContext(tolerance, shape, sewedShape, sewingHistory);
+                shape = sewedShape;
+                if (verbose) {
+                    SPRAY_LOG_INFO << "✅ 缝合修复成功";
+                }
+            } else {
+                if (verbose) {
+                    SPRAY_LOG_WARN << "⚠️ 缝合修复失败，保持原形状";
+                }
             }
         }
 
         // 步骤3: 基本形状修复
         if (verbose) {
-            std::cout << "\n🛠️ 步骤3: 基本形状修复..." << std::endl;
+            SPRAY_LOG_INFO << "\n🛠️ 步骤3: 基本形状修复...";
         }
         
         Handle(ShapeFix_Shape) shapeFixer = new ShapeFix_Shape();
@@ -123,25 +147,28 @@ bool OCCHandler::repairImportedModel(double tolerance, bool verbose) {
         shapeFixer->SetMinTolerance(tolerance * 0.1);
         
         // 执行修复
-        bool fixResult = shapeFixer->Perform();
+        bool fixResult = shapeFixer->Perform(scope.Next());
+        if (!scope.More()) {
+            return false;
+        }
         
         if (fixResult) {
             TopoDS_Shape fixedShape = shapeFixer->Shape();
             if (!fixedShape.IsNull()) {
                 shape = fixedShape;
                 if (verbose) {
-                    std::cout << "✅ 形状修复成功" << std::endl;
+                    SPRAY_LOG_INFO << "✅ 形状修复成功";
                 }
             }
         } else {
             if (verbose) {
-                std::cout << "⚠️ 形状修复未完全成功，但继续处理" << std::endl;
+                SPRAY_LOG_WARN << "⚠️ 形状修复未完全成功，但继续处理";
             }
         }
 
         // 步骤4: 验证修复结果
         if (verbose) {
-            std::cout << "\n✔️ 步骤4: 修复结果验证..." << std::endl;
+            SPRAY_LOG_INFO << "\n✔️ 步骤4: 修复结果验证...";
         }
         
         BRepCheck_Analyzer finalAnalyzer(shape);
@@ -154,22 +181,22 @@ bool OCCHandler::repairImportedModel(double tolerance, bool verbose) {
         }
         
         if (verbose) {
-            std::cout << "📊 修复结果:" << std::endl;
-            std::cout << "   最终面数量: " << finalFaceCount << std::endl;
-            std::cout << "   模型有效性: " << (finalValid ? "✅" : "⚠️") << std::endl;
-            std::cout << "✅ 模型修复完成" << std::endl;
+            SPRAY_LOG_INFO << "📊 修复结果:";
+            SPRAY_LOG_INFO << "   最终面数量: " << finalFaceCount;
+            SPRAY_LOG_INFO << "   模型有效性: " << (finalValid ? "✅" : "⚠️");
+            SPRAY_LOG_INFO << "✅ 模型修复完成";
         }
 
         return true;
 
     } catch (const std::exception& e) {
         if (verbose) {
-            std::cerr << "❌ 修复过程中发生异常: " << e.what() << std::endl;
+            SPRAY_LOG_ERROR << "❌ 修复过程中发生异常: " << e.what();
         }
         return false;
     } catch (...) {
         if (verbose) {
-            std::cerr << "❌ 修复过程中发生未知异常" << std::endl;
+            SPRAY_LOG_ERROR << "❌ 修复过程中发生未知异常";
         }
         return false;
     }
@@ -177,22 +204,24 @@ bool OCCHandler::repairImportedModel(double tolerance, bool verbose) {
 
 // 修复小面和小边
 bool OCCHandler::fixSmallFacesAndEdges(double tolerance, bool verbose) {
+    SPRAY_PROFILE_SCOPE("occ.fixSmallFacesAndEdges");
+
     if (shape.IsNull()) {
         if (verbose) {
-            std::cerr << "❌ 没有加载的模型，无法进行修复" << std::endl;
+            SPRAY_LOG_ERROR << "❌ 没有加载的模型，无法进行修复";
         }
         return false;
     }
 
     if (verbose) {
-        std::cout << "🔬 开始修复小面和小边..." << std::endl;
-        std::cout << "📏 使用容差: " << tolerance << std::endl;
+        SPRAY_LOG_INFO << "🔬 开始修复小面和小边...";
+        SPRAY_LOG_INFO << "📏 使用容差: " << tolerance;
     }
 
     try {
         // 步骤1: 检测和统计小面
         if (verbose) {
-            std::cout << "\n🔍 步骤1: 检测小面..." << std::endl;
+            SPRAY_LOG_INFO << "\n🔍 步骤1: 检测小面...";
         }
         
         ShapeAnalysis_CheckSmallFace smallFaceChecker;
@@ -212,15 +241,15 @@ bool OCCHandler::fixSmallFacesAndEdges(double tolerance, bool verbose) {
         }
         
         if (verbose) {
-            std::cout << "   总面数: " << totalFaceCount << std::endl;
-            std::cout << "   点状小面: " << spotFaceCount << std::endl;
-            std::cout << "   条状小面: " << stripFaceCount << std::endl;
+            SPRAY_LOG_INFO << "   总面数: " << totalFaceCount;
+            SPRAY_LOG_INFO << "   点状小面: " << spotFaceCount;
+            SPRAY_LOG_INFO << "   条状小面: " << stripFaceCount;
         }
 
         // 步骤2: 修复小面
         if (spotFaceCount > 0 || stripFaceCount > 0) {
             if (verbose) {
-                std::cout << "\n🛠️ 步骤2: 修复小面..." << std::endl;
+                SPRAY_LOG_INFO << "\n🛠️ 步骤2: 修复小面...";
             }
             
             Handle(ShapeFix_FixSmallFace) smallFaceFixer = new ShapeFix_FixSmallFace();
@@ -233,18 +262,18 @@ bool OCCHandler::fixSmallFacesAndEdges(double tolerance, bool verbose) {
             if (!fixedShape.IsNull()) {
                 shape = fixedShape;
                 if (verbose) {
-                    std::cout << "✅ 小面修复完成" << std::endl;
+                    SPRAY_LOG_INFO << "✅ 小面修复完成";
                 }
             }
         } else {
             if (verbose) {
-                std::cout << "✅ 未发现需要修复的小面" << std::endl;
+                SPRAY_LOG_INFO << "✅ 未发现需要修复的小面";
             }
         }
 
         // 步骤3: 检测和修复小边
         if (verbose) {
-            std::cout << "\n📏 步骤3: 检测和修复小边..." << std::endl;
+            SPRAY_LOG_INFO << "\n📏 步骤3: 检测和修复小边...";
         }
         
         Handle(ShapeFix_Wireframe) wireframeFixer = new ShapeFix_Wireframe(shape);
@@ -261,7 +290,7 @@ bool OCCHandler::fixSmallFacesAndEdges(double tolerance, bool verbose) {
         if (!edgeFixedShape.IsNull()) {
             shape = edgeFixedShape;
             if (verbose) {
-                std::cout << "✅ 小边修复完成" << std::endl;
+                SPRAY_LOG_INFO << "✅ 小边修复完成";
             }
         }
 
@@ -269,156 +298,224 @@ bool OCCHandler::fixSmallFacesAndEdges(double tolerance, bool verbose) {
 
     } catch (const std::exception& e) {
         if (verbose) {
-            std::cerr << "❌ 小面小边修复过程中发生异常: " << e.what() << std::endl;
+            SPRAY_LOG_ERROR << "❌ 小面小边修复过程中发生异常: " << e.what();
         }
         return false;
     } catch (...) {
         if (verbose) {
-            std::cerr << "❌ 小面小边修复过程中发生未知异常" << std::endl;
+            SPRAY_LOG_ERROR << "❌ 小面小边修复过程中发生未知异常";
         }
         return false;
     }
 }
 
+// 检查单个线框是否存在顺序、连接、小边或自相交问题
+static bool wireHasProblems(const TopoDS_Wire& wire, const TopoDS_Face& face, double tolerance) {
+    ShapeAnalysis_Wire wireAnalyzer(wire, face, tolerance);
+    return wireAnalyzer.CheckOrder() || wireAnalyzer.CheckConnected() ||
+           wireAnalyzer.CheckSmall(tolerance) || wireAnalyzer.CheckSelfIntersection();
+}
+
+// 修复单个线框，有修改时返回true并给出修复后的线框
+static bool fixWireOnFace(const TopoDS_Wire& wire, const TopoDS_Face& face, double tolerance, TopoDS_Wire& fixedWire) {
+    ShapeAnalysis_Wire wireAnalyzer(wire, face, tolerance);
+    ShapeFix_Wire wireFixer(wire, face, tolerance);
+
+    bool needsFix = false;
+
+    // 修复边顺序
+    if (wireAnalyzer.CheckOrder()) {
+        wireFixer.FixReorder();
+        needsFix = true;
+    }
+
+    // 修复连接性
+    if (wireAnalyzer.CheckConnected()) {
+        wireFixer.FixConnected();
+        needsFix = true;
+    }
+
+    // 修复小边
+    if (wireAnalyzer.CheckSmall(tolerance)) {
+        Standard_Boolean lockVertex = Standard_True;
+        if (wireFixer.FixSmall(lockVertex, tolerance)) {
+            needsFix = true;
+        }
+    }
+
+    // 修复自相交
+    if (wireAnalyzer.CheckSelfIntersection()) {
+        if (wireFixer.FixSelfIntersection()) {
+            needsFix = true;
+        }
+    }
+
+    // 修复缺失的边
+    if (wireFixer.FixLacking(false)) {
+        needsFix = true;
+    }
+
+    if (needsFix) {
+        fixedWire = wireFixer.Wire();
+    }
+    return needsFix;
+}
+
+// 按共享顶点对面贪心着色，返回各颜色的面序号（从0开始）；同一颜色的面没有公共顶点
+// 冲突按TShape判断（顶点和面都去掉位置）：实例化的面或带不同位置的顶点共享同一TShape，也不能同时修复
+static std::vector<std::vector<int>> colorFacesBySharedVertices(const TopTools_IndexedMapOfShape& faces) {
+    const int faceCount = faces.Extent();
+
+    // 去掉位置的顶点/面 → 引用它的面序号
+    TopTools_IndexedMapOfShape conflictKeys;
+    std::vector<std::vector<int>> keyFaces;
+    std::vector<std::vector<int>> faceKeys(faceCount);
+    auto addKey = [&](const TopoDS_Shape& subShape, int k) {
+        int key = conflictKeys.Add(subShape.Located(TopLoc_Location())) - 1;
+        if (key == static_cast<int>(keyFaces.size())) {
+            keyFaces.emplace_back();
+        }
+        if (keyFaces[key].empty() || keyFaces[key].back() != k) {
+            keyFaces[key].push_back(k);
+            faceKeys[k].push_back(key);
+        }
+    };
+    for (int k = 0; k < faceCount; k++) {
+        addKey(faces(k + 1), k);
+        for (TopExp_Explorer vertexExp(faces(k + 1), TopAbs_VERTEX); vertexExp.More(); vertexExp.Next()) {
+            addKey(vertexExp.Current(), k);
+        }
+    }
+
+    std::vector<int> colors(faceCount, -1);
+    std::vector<std::vector<int>> batches;
+    std::vector<int> usedMark;
+    for (int k = 0; k < faceCount; k++) {
+        // 标记相邻面已占用的颜色
+        usedMark.assign(batches.size() + 1, -1);
+        for (int key : faceKeys[k]) {
+            for (int neighbour : keyFaces[key]) {
+                if (neighbour != k && colors[neighbour] >= 0) {
+                    usedMark[colors[neighbour]] = k;
+                }
+            }
+        }
+
+        int color = 0;
+        while (usedMark[color] == k) {
+            color++;
+        }
+        if (color == static_cast<int>(batches.size())) {
+            batches.emplace_back();
+        }
+        colors[k] = color;
+        batches[color].push_back(k);
+    }
+    return batches;
+}
+
 // 修复线框问题
 bool OCCHandler::fixWireframeIssues(double tolerance, bool verbose) {
+    SPRAY_PROFILE_SCOPE("occ.fixWireframeIssues");
+
     if (shape.IsNull()) {
         if (verbose) {
-            std::cerr << "❌ 没有加载的模型，无法进行修复" << std::endl;
+            SPRAY_LOG_ERROR << "❌ 没有加载的模型，无法进行修复";
         }
         return false;
     }
 
     if (verbose) {
-        std::cout << "🔧 开始修复线框问题..." << std::endl;
-        std::cout << "📏 使用容差: " << tolerance << std::endl;
+        SPRAY_LOG_INFO << "🔧 开始修复线框问题...";
+        SPRAY_LOG_INFO << "📏 使用容差: " << tolerance;
     }
 
     try {
-        // 步骤1: 分析线框问题
+        // 步骤1: 分析线框问题（只读，各面并行）
         if (verbose) {
-            std::cout << "\n🔍 步骤1: 分析线框问题..." << std::endl;
+            SPRAY_LOG_INFO << "\n🔍 步骤1: 分析线框问题...";
         }
 
-        int totalWireCount = 0;
-        int problematicWireCount = 0;
-
-        for (TopExp_Explorer faceExp(shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
-            TopoDS_Face face = TopoDS::Face(faceExp.Current());
+        TopTools_IndexedMapOfShape faces;
+        TopExp::MapShapes(shape, TopAbs_FACE, faces);
+        const int faceCount = faces.Extent();
 
+        std::vector<int> faceWireCounts(faceCount, 0);
+        std::vector<int> faceProblemCounts(faceCount, 0);
+        OSD_Parallel::For(0, faceCount, [&](int k) {
+            TopoDS_Face face = TopoDS::Face(faces(k + 1));
             for (TopExp_Explorer wireExp(face, TopAbs_WIRE); wireExp.More(); wireExp.Next()) {
-                totalWireCount++;
-                TopoDS_Wire wire = TopoDS::Wire(wireExp.Current());
-
-                ShapeAnalysis_Wire wireAnalyzer(wire, face, tolerance);
-
-                bool hasProblems = false;
-
-                // 检查边顺序
-                if (wireAnalyzer.CheckOrder()) {
-                    hasProblems = true;
-                }
-
-                // 检查连接性
-                if (wireAnalyzer.CheckConnected()) {
-                    hasProblems = true;
-                }
-
-                // 检查小边
-                if (wireAnalyzer.CheckSmall(tolerance)) {
-                    hasProblems = true;
-                }
-
-                // 检查自相交
-                if (wireAnalyzer.CheckSelfIntersection()) {
-                    hasProblems = true;
-                }
-
-                if (hasProblems) {
-                    problematicWireCount++;
+                faceWireCounts[k]++;
+                if (wireHasProblems(TopoDS::Wire(wireExp.Current()), face, tolerance)) {
+                    faceProblemCounts[k]++;
                 }
             }
+        }, !parallelMode);
+
+        int totalWireCount = 0;
+        int problematicWireCount = 0;
+        for (int k = 0; k < faceCount; k++) {
+            totalWireCount += faceWireCounts[k];
+            problematicWireCount += faceProblemCounts[k];
         }
 
         if (verbose) {
-            std::cout << "   总线框数: " << totalWireCount << std::endl;
-            std::cout << "   问题线框数: " << problematicWireCount << std::endl;
+            SPRAY_LOG_INFO << "   总线框数: " << totalWireCount;
+            SPRAY_LOG_INFO << "   问题线框数: " << problematicWireCount;
         }
 
         // 步骤2: 修复线框问题
         if (problematicWireCount > 0) {
             if (verbose) {
-                std::cout << "\n🛠️ 步骤2: 修复线框问题..." << std::endl;
+                SPRAY_LOG_INFO << "\n🛠️ 步骤2: 修复线框问题...";
             }
 
-            // 创建重塑工具
-            Handle(ShapeBuild_ReShape) reshapeContext = new ShapeBuild_ReShape();
-            reshapeContext->Apply(shape);
-
-            int fixedWireCount = 0;
-
-            for (TopExp_Explorer faceExp(shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
-                TopoDS_Face face = TopoDS::Face(faceExp.Current());
-
-                for (TopExp_Explorer wireExp(face, TopAbs_WIRE); wireExp.More(); wireExp.Next()) {
-                    TopoDS_Wire wire = TopoDS::Wire(wireExp.Current());
-
-                    ShapeAnalysis_Wire wireAnalyzer(wire, face, tolerance);
-                    ShapeFix_Wire wireFixer(wire, face, tolerance);
-
-                    bool needsFix = false;
-
-                    // 修复边顺序
-                    if (wireAnalyzer.CheckOrder()) {
-                        wireFixer.FixReorder();
-                        needsFix = true;
-                    }
-
-                    // 修复连接性
-                    if (wireAnalyzer.CheckConnected()) {
-                        wireFixer.FixConnected();
-                        needsFix = true;
-                    }
-
-                    // 修复小边
-                    if (wireAnalyzer.CheckSmall(tolerance)) {
-                        Standard_Boolean lockVertex = Standard_True;
-                        if (wireFixer.FixSmall(lockVertex, tolerance)) {
-                            needsFix = true;
-                        }
-                    }
-
-                    // 修复自相交
-                    if (wireAnalyzer.CheckSelfIntersection()) {
-                        if (wireFixer.FixSelfIntersection()) {
-                            needsFix = true;
+            // 修复会更新共享边和顶点的容差，相邻的面不能同时修复：按共享顶点着色，
+            // 同一颜色的面互不相邻，逐个颜色并行修复。替换关系先按面收集，最后一次性应用
+            std::vector<std::vector<std::pair<TopoDS_Wire, TopoDS_Wire>>> faceReplacements(faceCount);
+            std::vector<std::vector<int>> batches;
+            if (parallelMode) {
+                batches = colorFacesBySharedVertices(faces);
+            } else {
+                batches.emplace_back(faceCount);
+                std::iota(batches.front().begin(), batches.front().end(), 0);
+            }
+            SPRAY_COUNTER_ADD("repair.wireFixBatches", static_cast<long long>(batches.size()));
+
+            for (const std::vector<int>& batch : batches) {
+                OSD_Parallel::For(0, static_cast<int>(batch.size()), [&](int n) {
+                    int k = batch[n];
+                    TopoDS_Face face = TopoDS::Face(faces(k + 1));
+                    for (TopExp_Explorer wireExp(face, TopAbs_WIRE); wireExp.More(); wireExp.Next()) {
+                        TopoDS_Wire wire = TopoDS::Wire(wireExp.Current());
+                        TopoDS_Wire fixedWire;
+                        if (fixWireOnFace(wire, face, tolerance, fixedWire)) {
+                            faceReplacements[k].emplace_back(wire, fixedWire);
                         }
                     }
+                }, !parallelMode);
+            }
 
-                    // 修复缺失的边
-                    if (wireFixer.FixLacking(false)) {
-                        needsFix = true;
-                    }
-
-                    if (needsFix) {
-                        fixedWireCount++;
-                        TopoDS_Wire fixedWire = wireFixer.Wire();
-                        reshapeContext->Replace(wire, fixedWire);
-                    }
+            // 创建重塑工具并应用全部替换
+            Handle(ShapeBuild_ReShape) reshapeContext = new ShapeBuild_ReShape();
+            int fixedWireCount = 0;
+            for (const auto& replacements : faceReplacements) {
+                for (const auto& replacement : replacements) {
+                    reshapeContext->Replace(replacement.first, replacement.second);
+                    fixedWireCount++;
                 }
             }
 
-            // 应用修复
             TopoDS_Shape wireframeFixedShape = reshapeContext->Apply(shape);
             if (!wireframeFixedShape.IsNull()) {
                 shape = wireframeFixedShape;
                 if (verbose) {
-                    std::cout << "✅ 修复了 " << fixedWireCount << " 个线框" << std::endl;
+                    SPRAY_LOG_INFO << "✅ 修复了 " << fixedWireCount << " 个线框";
                 }
             }
         } else {
             if (verbose) {
-                std::cout << "✅ 未发现需要修复的线框问题" << std::endl;
+                SPRAY_LOG_INFO << "✅ 未发现需要修复的线框问题";
             }
         }
 
@@ -426,12 +523,12 @@ bool OCCHandler::fixWireframeIssues(double tolerance, bool verbose) {
 
     } catch (const std::exception& e) {
         if (verbose) {
-            std::cerr << "❌ 线框修复过程中发生异常: " << e.what() << std::endl;
+            SPRAY_LOG_ERROR << "❌ 线框修复过程中发生异常: " << e.what();
         }
         return false;
     } catch (...) {
         if (verbose) {
-            std::cerr << "❌ 线框修复过程中发生未知异常" << std::endl;
+            SPRAY_LOG_ERROR << "❌ 线框修复过程中发生未知异常";
         }
         return false;
     }
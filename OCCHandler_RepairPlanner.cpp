@@ -0,0 +1,354 @@
+#include "OCCHandler.h"
+#include "SprayLog.h"
+#include "SprayProfiler.h"
+#include "RepairContext.h"
+#include <BRepCheck_Analyzer.hxx>
+#include <BRepTools_ReShape.hxx>
+#include <ShapeFix_Shape.hxx>
+#include <ShapeFix_ShapeTolerance.hxx>
+#include <ShapeAnalysis.hxx>
+#include <ShapeAnalysis_FreeBounds.hxx>
+#include <ShapeAnalysis_ShapeContents.hxx>
+#include <ShapeAnalysis_ShapeTolerance.hxx>
+#include <ShapeUpgrade_RemoveInternalWires.hxx>
+#include <ShapeExtend_Status.hxx>
+#include <TopTools_HSequenceOfShape.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <Message_ProgressScope.hxx>
+#include <Standard_Failure.hxx>
+#include <chrono>
+
+// 各修复操作的进度权重
+static const int PLAN_WEIGHT_SEWING = 3;
+static const int PLAN_WEIGHT_SHAPE_FIX = 2;
+static const int PLAN_WEIGHT_INTERNAL_WIRES = 1;
+static const int PLAN_WEIGHT_TOLERANCE = 1;
+
+// 统计复合体中的线框数量
+static int countWires(const TopoDS_Shape& wires) {
+    int count = 0;
+    for (TopExp_Explorer exp(wires, TopAbs_WIRE); exp.More(); exp.Next()) {
+        count++;
+    }
+    return count;
+}
+
+// 统计复合体中的边数量
+static int countEdges(const TopoDS_Shape& wires) {
+    int count = 0;
+    for (TopExp_Explorer exp(wires, TopAbs_EDGE); exp.More(); exp.Next()) {
+        count++;
+    }
+    return count;
+}
+
+// 统计面积小于minArea的内环（与ShapeUpgrade_RemoveInternalWires的判定一致）
+static int countSmallInnerWires(const TopoDS_Shape& shape, double minArea) {
+    int count = 0;
+    for (TopExp_Explorer faceExp(shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
+        TopoDS_Face face = TopoDS::Face(faceExp.Current());
+        TopoDS_Wire outerWire = ShapeAnalysis::OuterWire(face);
+        for (TopExp_Explorer wireExp(face, TopAbs_WIRE); wireExp.More(); wireExp.Next()) {
+            TopoDS_Wire wire = TopoDS::Wire(wireExp.Current());
+            if (!wire.IsSame(outerWire) && ShapeAnalysis::ContourArea(wire) < minArea) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+// 是否不需要任何修复操作
+bool RepairDiagnosis::isClean() const {
+    return !needsSewing && !needsShapeFix && !needsInternalWireRemoval && !needsToleranceLimit;
+}
+
+// 修复前的快速诊断：有效性、拓扑内容、自由边界与容差统计，并据此决定需要执行的修复操作
+RepairDiagnosis OCCHandler::diagnoseForRepair(double tolerance) const {
+    SPRAY_PROFILE_SCOPE("occ.diagnoseForRepair");
+
+    RepairDiagnosis diagnosis;
+    if (shape.IsNull()) {
+        return diagnosis;
+    }
+
+    BRepCheck_Analyzer analyzer(shape);
+    diagnosis.valid = analyzer.IsValid();
+
+    ShapeAnalysis_ShapeContents contents;
+    contents.Perform(shape);
+    diagnosis.solidCount = contents.NbSolids();
+    diagnosis.faceCount = contents.NbFaces();
+    diagnosis.wireCount = contents.NbWires();
+    diagnosis.freeFaceCount = contents.NbFreeFaces();
+    if (diagnosis.wireCount > diagnosis.faceCount) {
+        diagnosis.smallInnerWireCount = countSmallInnerWires(shape, tolerance * tolerance);
+    }
+    for (TopExp_Explorer exp(shape, TopAbs_SHELL, TopAbs_SOLID); exp.More(); exp.Next()) {
+        diagnosis.freeShellCount++;
+    }
+
+    ShapeAnalysis_FreeBounds freeBounds(shape);
+    diagnosis.closedFreeBoundCount = countWires(freeBounds.GetClosedWires());
+    diagnosis.openFreeBoundCount = countWires(freeBounds.GetOpenWires());
+    diagnosis.freeEdgeCount = countEdges(freeBounds.GetClosedWires()) + countEdges(freeBounds.GetOpenWires());
+
+    // 按修复容差缝合后再统计自由边界：缝合能连接的边会从自由边界中消失（没有自由边时无需计算）
+    diagnosis.sewnFreeBoundCount = diagnosis.closedFreeBoundCount + diagnosis.openFreeBoundCount;
+    diagnosis.sewnFreeEdgeCount = diagnosis.freeEdgeCount;
+    if (diagnosis.freeEdgeCount > 0) {
+        ShapeAnalysis_FreeBounds sewnFreeBounds(shape, tolerance);
+        diagnosis.sewnFreeBoundCount = countWires(sewnFreeBounds.GetClosedWires()) +
+                                       countWires(sewnFreeBounds.GetOpenWires());
+        diagnosis.sewnFreeEdgeCount = countEdges(sewnFreeBounds.GetClosedWires()) +
+                                      countEdges(sewnFreeBounds.GetOpenWires());
+    }
+
+    ShapeAnalysis_ShapeTolerance toleranceAnalyzer;
+    diagnosis.maxTolerance = toleranceAnalyzer.Tolerance(shape, 1);
+    diagnosis.averageTolerance = toleranceAnalyzer.Tolerance(shape, 0);
+    Handle(TopTools_HSequenceOfShape) overTolerance = toleranceAnalyzer.OverTolerance(shape, tolerance * 100);
+    diagnosis.overToleranceCount = overTolerance.IsNull() ? 0 : overTolerance->Length();
+
+    // 缝合：按修复容差缝合会连接自由边（缝合前后自由边界或自由边数量不同），
+    // 包括未缝合的散面、独立的壳之间以及同一个壳内未共享边的面
+    diagnosis.needsSewing =
+        diagnosis.sewnFreeBoundCount != diagnosis.closedFreeBoundCount + diagnosis.openFreeBoundCount ||
+        diagnosis.sewnFreeEdgeCount != diagnosis.freeEdgeCount;
+    // 形状修复：BRepCheck判定无效
+    diagnosis.needsShapeFix = !diagnosis.valid;
+    // 内部线框：存在会被移除的微小内环（普通的孔不算）
+    diagnosis.needsInternalWireRemoval = diagnosis.smallInnerWireCount > 0;
+    // 容差限制：存在超过容差上限的子形状
+    diagnosis.needsToleranceLimit = diagnosis.overToleranceCount > 0;
+    return diagnosis;
+}
+
+// 设置修复上下文
+void OCCHandler::setRepairContext(const std::shared_ptr<RepairContext>& context) {
+    repairContext = context;
+}
+
+// 获取修复上下文
+std::shared_ptr<RepairContext> OCCHandler::getRepairContext() const {
+    return repairContext;
+}
+
+// 当前模型可用的上下文诊断结果（当前模型为原始模型或其缝合结果时有效）
+const RepairDiagnosis* OCCHandler::trackedRepairDiagnosis() const {
+    if (repairContext && repairContext->hasDiagnosis() && repairContext->isTracked(shape)) {
+        return &repairContext->diagnosis();
+    }
+    return nullptr;
+}
+
+// 从上下文继续缝合：已按相同容差缝合过原始模型时直接使用缝合结果
+bool OCCHandler::resumeSewingFromContext(double tolerance) {
+    TopoDS_Shape sewed;
+    if (!repairContext || !repairContext->isTracked(shape) || !repairContext->findSewing(tolerance, sewed)) {
+        return false;
+    }
+    shape = sewed;
+    SPRAY_COUNTER_ADD("repair.sewingReused", 1);
+    return true;
+}
+
+// 在上下文中记录对原始模型的缝合结果
+void OCCHandler::recordSewingInContext(double tolerance, const TopoDS_Shape& before, const TopoDS_Shape& sewed,
+                                       const Handle(BRepTools_ReShape)& history) {
+    if (repairContext && before.IsSame(repairContext->pristine())) {
+        repairContext->storeSewing(tolerance, sewed, history);
+    }
+}
+
+// 最近一次计划修复的诊断与各操作耗时
+const RepairPlanReport& OCCHandler::getLastRepairReport() const {
+    return lastRepairReport;
+}
+
+// 按诊断结果只执行需要的修复操作
+bool OCCHandler::repairWithPlan(double tolerance, bool verbose, const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("occ.repairWithPlan");
+
+    lastRepairReport = RepairPlanReport();
+    if (shape.IsNull()) {
+        if (verbose) {
+            SPRAY_LOG_ERROR << "❌ 没有加载的模型，无法进行修复";
+        }
+        return false;
+    }
+
+    // 原始模型只诊断一次，结果保存在修复上下文中
+    RepairDiagnosis diagnosis;
+    bool fromPristine = repairContext && shape.IsSame(repairContext->pristine());
+    if (fromPristine && repairContext->hasDiagnosis()) {
+        diagnosis = repairContext->diagnosis();
+    } else {
+        diagnosis = diagnoseForRepair(tolerance);
+        if (fromPristine) {
+            repairContext->setDiagnosis(diagnosis);
+        }
+    }
+    lastRepairReport.diagnosis = diagnosis;
+    if (verbose) {
+        SPRAY_LOG_INFO << "🩺 修复诊断: 有效性 " << (diagnosis.valid ? "✅" : "❌")
+                       << "，实体 " << diagnosis.solidCount << "，独立壳 " << diagnosis.freeShellCount
+                       << "，散面 " << diagnosis.freeFaceCount << "，自由边界 "
+                       << diagnosis.closedFreeBoundCount + diagnosis.openFreeBoundCount
+                       << "（缝合后 " << diagnosis.sewnFreeBoundCount << "）"
+                       << "，最大容差 " << diagnosis.maxTolerance;
+    }
+
+    if (diagnosis.isClean()) {
+        SPRAY_COUNTER_ADD("repair.skippedClean", 1);
+        if (verbose) {
+            SPRAY_LOG_INFO << "✅ 模型无需修复，跳过全部修复操作";
+        }
+        return true;
+    }
+
+    // 分区修复：各部分分别诊断并执行各自需要的操作
+    bool partitionedResult = false;
+    if (partitionedRepair && repairPartitioned("计划修复", tolerance, verbose,
+            [tolerance](OCCHandler& part, const Message_ProgressRange& partRange) {
+                return part.repairWithPlan(tolerance, false, partRange);
+            }, range, partitionedResult)) {
+        return partitionedResult;
+    }
+
+    int totalWeight = (diagnosis.needsSewing ? PLAN_WEIGHT_SEWING : 0) +
+                      (diagnosis.needsShapeFix ? PLAN_WEIGHT_SHAPE_FIX : 0) +
+                      (diagnosis.needsInternalWireRemoval ? PLAN_WEIGHT_INTERNAL_WIRES : 0) +
+                      (diagnosis.needsToleranceLimit ? PLAN_WEIGHT_TOLERANCE : 0);
+    Message_ProgressScope scope(range, "计划修复", totalWeight);
+
+    // 记录单个操作的耗时
+    auto recordOperator = [&](const char* name, std::chrono::steady_clock::time_point start, bool changed) {
+        RepairOperatorRun run;
+        run.name = name;
+        run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        run.changed = changed;
+        lastRepairReport.operators.push_back(run);
+        if (verbose) {
+            SPRAY_LOG_INFO << "   ⏱️ " << name << ": " << run.seconds * 1000.0 << " ms"
+                           << (changed ? "" : "（无变化）");
+        }
+    };
+
+    TopoDS_Shape originalShape = shape;
+    try {
+        bool needsShapeFix = diagnosis.needsShapeFix;
+
+        if (diagnosis.needsSewing && resumeSewingFromContext(tolerance)) {
+            scope.Next(PLAN_WEIGHT_SEWING);
+            if (verbose) {
+                SPRAY_LOG_INFO << "   ♻️ 复用修复上下文中的缝合结果";
+            }
+            if (!needsShapeFix) {
+                needsShapeFix = !BRepCheck_Analyzer(shape).IsValid();
+            }
+        } else if (diagnosis.needsSewing) {
+            SPRAY_PROFILE_SCOPE("occ.repairWithPlan.sewing");
+            auto start = std::chrono::steady_clock::now();
+            int faceCount = 0;
+            Handle(BRepTools_ReShape) sewingHistory;
+            TopoDS_Shape sewedShape = sewAllFaces(tolerance, faceCount, sewingHistory, scope.Next(PLAN_WEIGHT_SEWING));
+            if (!scope.More()) {
+                shape = originalShape;
+                return false;
+            }
+            bool changed = !sewedShape.IsNull() && !sewedShape.IsSame(shape);
+            if (changed) {
+                recordSewingInContext(tolerance, shape, sewedShape, sewingHistory);
+                shape = sewedShape;
+                // 缝合可能改变有效性，只在原本有效时重新检查
+                if (!needsShapeFix) {
+                    needsShapeFix = !BRepCheck_Analyzer(shape).IsValid();
+                }
+            }
+            recordOperator("缝合", start, changed);
+        }
+
+        if (needsShapeFix) {
+            SPRAY_PROFILE_SCOPE("occ.repairWithPlan.shapeFix");
+            auto start = std::chrono::steady_clock::now();
+            Handle(ShapeFix_Shape) shapeFixer = new ShapeFix_Shape();
+            shapeFixer->Init(shape);
+            shapeFixer->SetPrecision(tolerance);
+            shapeFixer->SetMaxTolerance(tolerance * 100);
+            shapeFixer->SetMinTolerance(tolerance * 0.01);
+            bool changed = shapeFixer->Perform(scope.Next(PLAN_WEIGHT_SHAPE_FIX));
+            if (!scope.More()) {
+                shape = originalShape;
+                return false;
+            }
+            if (changed && !shapeFixer->Shape().IsNull()) {
+                shape = shapeFixer->Shape();
+            }
+            recordOperator("形状修复", start, changed);
+        }
+
+        if (diagnosis.needsInternalWireRemoval) {
+            SPRAY_PROFILE_SCOPE("occ.repairWithPlan.internalWires");
+            auto start = std::chrono::steady_clock::now();
+            Handle(ShapeUpgrade_RemoveInternalWires) wireRemover = new ShapeUpgrade_RemoveInternalWires(shape);
+            wireRemover->MinArea() = tolerance * tolerance;
+            wireRemover->RemoveFaceMode() = Standard_False;
+            wireRemover->Perform();
+            bool changed = wireRemover->Status(ShapeExtend_DONE1) && !wireRemover->GetResult().IsNull();
+            if (changed) {
+                shape = wireRemover->GetResult();
+            }
+            scope.Next(PLAN_WEIGHT_INTERNAL_WIRES);
+            recordOperator("移除内部线框", start, changed);
+        }
+
+        if (diagnosis.needsToleranceLimit) {
+            SPRAY_PROFILE_SCOPE("occ.repairWithPlan.tolerance");
+            auto start = std::chrono::steady_clock::now();
+            // LimitTolerance直接修改TShape，在副本上执行，仍然有效时才采用
+            BRepBuilderAPI_Copy copier(shape);
+            TopoDS_Shape limitedShape = copier.Shape();
+            ShapeFix_ShapeTolerance toleranceFixer;
+            bool changed = toleranceFixer.LimitTolerance(limitedShape, tolerance * 0.01, tolerance * 100);
+            if (changed) {
+                if (BRepCheck_Analyzer(limitedShape).IsValid()) {
+                    shape = limitedShape;
+                } else {
+                    changed = false;
+                    if (verbose) {
+                        SPRAY_LOG_WARN << "⚠️ 限制容差后模型无效，保留原容差";
+                    }
+                }
+            }
+            scope.Next(PLAN_WEIGHT_TOLERANCE);
+            recordOperator("限制容差", start, changed);
+        }
+
+        if (!scope.More()) {
+            shape = originalShape;
+            return false;
+        }
+        SPRAY_COUNTER_ADD("repair.plannedOperators", static_cast<long long>(lastRepairReport.operators.size()));
+        return true;
+
+    } catch (const Standard_Failure& e) {
+        if (verbose) {
+            SPRAY_LOG_ERROR << "❌ 计划修复过程中发生异常: " << e.GetMessageString();
+        }
+    } catch (const std::exception& e) {
+        if (verbose) {
+            SPRAY_LOG_ERROR << "❌ 计划修复过程中发生异常: " << e.what();
+        }
+    } catch (...) {
+        if (verbose) {
+            SPRAY_LOG_ERROR << "❌ 计划修复过程中发生未知异常";
+        }
+    }
+
+    // 异常时恢复修复前的模型，后备修复从原始状态开始
+    shape = originalShape;
+    return false;
+}
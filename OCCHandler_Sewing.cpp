@@ -0,0 +1,316 @@
+#include "OCCHandler.h"
+#include "SprayLog.h"
+#include "SprayProfiler.h"
+#include <BRepBuilderAPI_Sewing.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepTools_ReShape.hxx>
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <Bnd_Box.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Shell.hxx>
+#include <OSD_Parallel.hxx>
+#include <Message_ProgressScope.hxx>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// 面数少于该值时直接整体缝合（分块的额外开销不值得）
+static const int SPATIAL_SEWING_MIN_FACES = 2000;
+
+// 每个网格单元的目标面数
+static const int SPATIAL_SEWING_FACES_PER_CELL = 500;
+
+// 创建与原流程设置相同的缝合器
+static void configureSewing(BRepBuilderAPI_Sewing& sewing, double tolerance) {
+    sewing.SetTolerance(tolerance);
+    sewing.SetFaceMode(Standard_True);
+    sewing.SetFloatingEdgesMode(Standard_True);
+    sewing.SetNonManifoldMode(Standard_False);
+}
+
+// 按包围盒各轴的实际尺寸确定网格单元大小：单元总数约为targetCells，
+// 比单元还短的轴（扁平或细长的模型）只分一层，其余单元分给较长的轴
+static double spatialCellSize(const double extent[3], int targetCells, double tolerance) {
+    bool active[3];
+    for (int axis = 0; axis < 3; axis++) {
+        active[axis] = extent[axis] > tolerance;
+    }
+    double cellSize = std::max(*std::max_element(extent, extent + 3), tolerance);
+    for (int pass = 0; pass < 3; pass++) {
+        double product = 1.0;
+        int activeCount = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            if (active[axis]) {
+                product *= extent[axis];
+                activeCount++;
+            }
+        }
+        if (activeCount == 0) {
+            break;
+        }
+        cellSize = std::pow(product / targetCells, 1.0 / activeCount);
+        bool dropped = false;
+        for (int axis = 0; axis < 3; axis++) {
+            if (active[axis] && extent[axis] < cellSize) {
+                active[axis] = false;
+                dropped = true;
+            }
+        }
+        if (!dropped) {
+            break;
+        }
+    }
+    return std::max(cellSize, tolerance);
+}
+
+// 带有自由边（只属于一个面，退化边除外）的面
+static void collectBoundaryFaces(const TopoDS_Shape& part, std::vector<TopoDS_Shape>& boundaryFaces) {
+    TopTools_IndexedDataMapOfShapeListOfShape edgeFaces;
+    TopExp::MapShapesAndAncestors(part, TopAbs_EDGE, TopAbs_FACE, edgeFaces);
+    for (TopExp_Explorer faceExp(part, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
+        for (TopExp_Explorer edgeExp(faceExp.Current(), TopAbs_EDGE); edgeExp.More(); edgeExp.Next()) {
+            const TopoDS_Edge& edge = TopoDS::Edge(edgeExp.Current());
+            const TopTools_ListOfShape* ancestors = edgeFaces.Seek(edge);
+            if (!BRep_Tool::Degenerated(edge) && ancestors && ancestors->Extent() < 2) {
+                boundaryFaces.push_back(faceExp.Current());
+                break;
+            }
+        }
+    }
+}
+
+// 按共享边把面重新组成壳（每个连通部分一个壳，单独的面直接放入复合体）
+static TopoDS_Shape groupFacesIntoShells(const TopoDS_Shape& faces, long long& freeEdgeCount) {
+    TopTools_IndexedMapOfShape faceMap;
+    TopExp::MapShapes(faces, TopAbs_FACE, faceMap);
+    TopTools_IndexedDataMapOfShapeListOfShape edgeFaces;
+    TopExp::MapShapesAndAncestors(faces, TopAbs_EDGE, TopAbs_FACE, edgeFaces);
+
+    freeEdgeCount = 0;
+    for (int e = 1; e <= edgeFaces.Extent(); e++) {
+        if (edgeFaces(e).Extent() < 2 && !BRep_Tool::Degenerated(TopoDS::Edge(edgeFaces.FindKey(e)))) {
+            freeEdgeCount++;
+        }
+    }
+
+    BRep_Builder builder;
+    TopoDS_Compound result;
+    builder.MakeCompound(result);
+    std::vector<char> visited(faceMap.Extent() + 1, 0);
+    std::vector<int> stack;
+    for (int start = 1; start <= faceMap.Extent(); start++) {
+        if (visited[start]) {
+            continue;
+        }
+        std::vector<int> component;
+        visited[start] = 1;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            const int f = stack.back();
+            stack.pop_back();
+            component.push_back(f);
+            for (TopExp_Explorer edgeExp(faceMap(f), TopAbs_EDGE); edgeExp.More(); edgeExp.Next()) {
+                const TopTools_ListOfShape* neighbours = edgeFaces.Seek(edgeExp.Current());
+                if (!neighbours) continue;
+                for (TopTools_ListOfShape::Iterator it(*neighbours); it.More(); it.Next()) {
+                    const int n = faceMap.FindIndex(it.Value());
+                    if (n > 0 && !visited[n]) {
+                        visited[n] = 1;
+                        stack.push_back(n);
+                    }
+                }
+            }
+        }
+        if (component.size() == 1) {
+            builder.Add(result, faceMap(component.front()));
+            continue;
+        }
+        TopoDS_Shell shell;
+        builder.MakeShell(shell);
+        for (int f : component) {
+            builder.Add(shell, faceMap(f));
+        }
+        builder.Add(result, shell);
+    }
+    return result;
+}
+
+// 设置是否空间分区缝合
+void OCCHandler::setSpatialSewing(bool enabled) {
+    spatialSewing = enabled;
+}
+
+// 是否空间分区缝合
+bool OCCHandler::isSpatialSewing() const {
+    return spatialSewing;
+}
+
+// 缝合当前模型的全部面。
+// 面数较多且开启空间分区缝合时：按放大容差后的包围盒中心把面分到网格中（单元大小按各轴尺寸确定），
+// 各单元的面复制后并行预缝合（复制断开单元之间共享的边和顶点，避免多个线程同时修改同一拓扑）。
+// 全局缝合只加入预缝合后仍带自由边的面（单元边界和模型边界上的面），把缝合记录的替换应用到全部预缝合结果，
+// 再按共享边重新组成壳；壳内朝向不一致时由之后的形状修复处理
+TopoDS_Shape OCCHandler::sewAllFaces(double tolerance, int& faceCount, Handle(BRepTools_ReShape)& history,
+                                     const Message_ProgressRange& range) const {
+    SPRAY_PROFILE_SCOPE("occ.sewAllFaces");
+
+    std::vector<TopoDS_Shape> faces;
+    for (TopExp_Explorer faceExp(shape, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
+        faces.push_back(faceExp.Current());
+    }
+    faceCount = static_cast<int>(faces.size());
+    history.Nullify();
+
+    if (!spatialSewing || faceCount < SPATIAL_SEWING_MIN_FACES) {
+        BRepBuilderAPI_Sewing sewing(tolerance);
+        configureSewing(sewing, tolerance);
+        for (const TopoDS_Shape& face : faces) {
+            sewing.Add(face);
+        }
+        Message_ProgressScope scope(range, "缝合", 1);
+        sewing.Perform(scope.Next());
+        if (!scope.More()) {
+            return TopoDS_Shape();
+        }
+        history = sewing.GetContext();
+        return sewing.SewedShape();
+    }
+
+    // 计算各面包围盒与网格尺寸
+    std::vector<Bnd_Box> boxes(faces.size());
+    Bnd_Box totalBox;
+    for (size_t i = 0; i < faces.size(); i++) {
+        BRepBndLib::Add(faces[i], boxes[i]);
+        boxes[i].Enlarge(tolerance);
+        totalBox.Add(boxes[i]);
+    }
+    if (totalBox.IsVoid()) {
+        return TopoDS_Shape();
+    }
+
+    double xmin, ymin, zmin, xmax, ymax, zmax;
+    totalBox.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+    const double extent[3] = { xmax - xmin, ymax - ymin, zmax - zmin };
+    const int targetCells = std::max(1, static_cast<int>(std::ceil(
+        static_cast<double>(faceCount) / SPATIAL_SEWING_FACES_PER_CELL)));
+    const double cellSize = spatialCellSize(extent, targetCells, tolerance);
+    int dims[3];
+    for (int axis = 0; axis < 3; axis++) {
+        dims[axis] = std::max(1, static_cast<int>(std::ceil(extent[axis] / cellSize)));
+    }
+
+    // 按包围盒中心分桶
+    std::vector<std::vector<int>> cells(static_cast<size_t>(dims[0]) * dims[1] * dims[2]);
+    for (size_t i = 0; i < faces.size(); i++) {
+        double bx0, by0, bz0, bx1, by1, bz1;
+        boxes[i].Get(bx0, by0, bz0, bx1, by1, bz1);
+        const double center[3] = { (bx0 + bx1) * 0.5 - xmin, (by0 + by1) * 0.5 - ymin, (bz0 + bz1) * 0.5 - zmin };
+        int cell[3];
+        for (int axis = 0; axis < 3; axis++) {
+            cell[axis] = std::min(dims[axis] - 1, std::max(0, static_cast<int>(center[axis] / cellSize)));
+        }
+        cells[(static_cast<size_t>(cell[2]) * dims[1] + cell[1]) * dims[0] + cell[0]].push_back(static_cast<int>(i));
+    }
+
+    std::vector<std::vector<int>> buckets;
+    for (std::vector<int>& cell : cells) {
+        if (!cell.empty()) {
+            buckets.push_back(std::move(cell));
+        }
+    }
+    // 面多的单元先开始
+    std::stable_sort(buckets.begin(), buckets.end(),
+                     [](const std::vector<int>& a, const std::vector<int>& b) { return a.size() > b.size(); });
+
+    SPRAY_COUNTER_ADD("sewing.spatialBuckets", static_cast<long long>(buckets.size()));
+    SPRAY_LOG_DEBUG << "🧵 空间分区缝合: " << faceCount << " 个面分为 " << buckets.size() << " 个单元（网格 "
+                    << dims[0] << "x" << dims[1] << "x" << dims[2] << "）";
+
+    // 各单元与全局缝合的进度范围在主线程中预先分配（按面数加权）
+    Message_ProgressScope scope(range, "空间分区缝合", 2.0 * faceCount);
+    std::vector<Message_ProgressRange> bucketRanges;
+    bucketRanges.reserve(buckets.size());
+    for (const std::vector<int>& bucket : buckets) {
+        bucketRanges.push_back(scope.Next(static_cast<Standard_Real>(bucket.size())));
+    }
+    Message_ProgressRange globalRange = scope.Next(faceCount);
+
+    std::vector<TopoDS_Shape> presewn(buckets.size());
+    std::vector<std::vector<TopoDS_Shape>> boundaryFaces(buckets.size());
+    OSD_Parallel::For(0, static_cast<int>(buckets.size()), [&](int k) {
+        if (bucketRanges[k].UserBreak()) {
+            return;
+        }
+        BRep_Builder builder;
+        TopoDS_Compound bucketFaces;
+        builder.MakeCompound(bucketFaces);
+        for (int i : buckets[k]) {
+            builder.Add(bucketFaces, faces[i]);
+        }
+
+        try {
+            BRepBuilderAPI_Copy copier(bucketFaces, Standard_True, Standard_False);
+            TopoDS_Shape copied = copier.Shape();
+            presewn[k] = copied;
+
+            BRepBuilderAPI_Sewing sewing(tolerance);
+            configureSewing(sewing, tolerance);
+            for (TopExp_Explorer faceExp(copied, TopAbs_FACE); faceExp.More(); faceExp.Next()) {
+                sewing.Add(faceExp.Current());
+            }
+            sewing.Perform(bucketRanges[k]);
+            TopoDS_Shape sewed = sewing.SewedShape();
+            if (!sewed.IsNull()) {
+                presewn[k] = sewed;
+            }
+        } catch (...) {
+            // 预缝合失败的单元保留复制的散面，由全局缝合处理
+        }
+        if (!presewn[k].IsNull()) {
+            collectBoundaryFaces(presewn[k], boundaryFaces[k]);
+        }
+    }, !parallelMode);
+
+    if (!scope.More()) {
+        return TopoDS_Shape();
+    }
+
+    // 全局缝合：只加入带自由边的面，连接单元之间的边界
+    BRepBuilderAPI_Sewing sewing(tolerance);
+    configureSewing(sewing, tolerance);
+    long long boundaryFaceCount = 0;
+    for (const std::vector<TopoDS_Shape>& bucketBoundary : boundaryFaces) {
+        for (const TopoDS_Shape& face : bucketBoundary) {
+            sewing.Add(face);
+        }
+        boundaryFaceCount += static_cast<long long>(bucketBoundary.size());
+    }
+    sewing.Perform(globalRange);
+    if (!scope.More()) {
+        return TopoDS_Shape();
+    }
+    SPRAY_COUNTER_ADD("sewing.spatialBoundaryFaces", boundaryFaceCount);
+
+    // 缝合对边和面的替换应用到全部预缝合结果，内部的面随之连接到缝合后的边
+    BRep_Builder builder;
+    TopoDS_Compound allParts;
+    builder.MakeCompound(allParts);
+    for (const TopoDS_Shape& part : presewn) {
+        if (!part.IsNull()) {
+            builder.Add(allParts, part);
+        }
+    }
+    TopoDS_Shape sewedParts = sewing.GetContext()->Apply(allParts);
+
+    long long freeEdgeCount = 0;
+    TopoDS_Shape result = groupFacesIntoShells(sewedParts, freeEdgeCount);
+    SPRAY_COUNTER_ADD("sewing.spatialFreeEdges", freeEdgeCount);
+    return result;
+}
@@ -1,4 +1,6 @@
 #include "OCCHandler.h"
+#include "SprayLog.h"
+#include "SprayProfiler.h"
 #include <BRepCheck_Analyzer.hxx>
 #include <ShapeAnalysis_Wire.hxx>
 #include <ShapeAnalysis_Edge.hxx>
@@ -17,33 +19,35 @@
 
 // 形状验证和分析
 bool OCCHandler::validateAndAnalyzeShape(bool verbose) {
+    SPRAY_PROFILE_SCOPE("occ.validateAndAnalyzeShape");
+
     if (shape.IsNull()) {
         if (verbose) {
-            std::cerr << "❌ 没有加载的模型，无法进行验证" << std::endl;
+            SPRAY_LOG_ERROR << "❌ 没有加载的模型，无法进行验证";
         }
         return false;
     }
 
     if (verbose) {
-        std::cout << "🔍 开始形状验证和分析..." << std::endl;
+        SPRAY_LOG_INFO << "🔍 开始形状验证和分析...";
     }
 
     try {
         // 基本有效性检查
         if (verbose) {
-            std::cout << "\n📋 基本有效性检查..." << std::endl;
+            SPRAY_LOG_INFO << "\n📋 基本有效性检查...";
         }
         
         BRepCheck_Analyzer analyzer(shape);
         bool isValid = analyzer.IsValid();
         
         if (verbose) {
-            std::cout << "   基本有效性: " << (isValid ? "✅ 有效" : "❌ 无效") << std::endl;
+            SPRAY_LOG_INFO << "   基本有效性: " << (isValid ? "✅ 有效" : "❌ 无效");
         }
 
         // 容差分析
         if (verbose) {
-            std::cout << "\n📐 容差分析..." << std::endl;
+            SPRAY_LOG_INFO << "\n📐 容差分析...";
         }
         
         ShapeAnalysis_ShapeTolerance toleranceAnalyzer;
@@ -56,30 +60,30 @@ bool OCCHandler::validateAndAnalyzeShape(bool verbose) {
         Standard_Real maxFaceTol = toleranceAnalyzer.Tolerance(shape, 1, TopAbs_FACE);
         
         if (verbose) {
-            std::cout << "   整体平均容差: " << avgTolerance << std::endl;
-            std::cout << "   整体最大容差: " << maxTolerance << std::endl;
-            std::cout << "   整体最小容差: " << minTolerance << std::endl;
-            std::cout << "   顶点最大容差: " << maxVertexTol << std::endl;
-            std::cout << "   边最大容差: " << maxEdgeTol << std::endl;
-            std::cout << "   面最大容差: " << maxFaceTol << std::endl;
+            SPRAY_LOG_INFO << "   整体平均容差: " << avgTolerance;
+            SPRAY_LOG_INFO << "   整体最大容差: " << maxTolerance;
+            SPRAY_LOG_INFO << "   整体最小容差: " << minTolerance;
+            SPRAY_LOG_INFO << "   顶点最大容差: " << maxVertexTol;
+            SPRAY_LOG_INFO << "   边最大容差: " << maxEdgeTol;
+            SPRAY_LOG_INFO << "   面最大容差: " << maxFaceTol;
         }
 
         // 几何内容分析
         if (verbose) {
-            std::cout << "\n🔬 几何内容分析..." << std::endl;
+            SPRAY_LOG_INFO << "\n🔬 几何内容分析...";
         }
         
         ShapeAnalysis_ShapeContents contentAnalyzer;
         contentAnalyzer.Perform(shape);
         
         if (verbose) {
-            std::cout << "   自由曲线数量: " << contentAnalyzer.NbFreeEdges() << std::endl;
-            std::cout << "   共享边数量: " << contentAnalyzer.NbSharedEdges() << std::endl;
+            SPRAY_LOG_INFO << "   自由曲线数量: " << contentAnalyzer.NbFreeEdges();
+            SPRAY_LOG_INFO << "   共享边数量: " << contentAnalyzer.NbSharedEdges();
         }
 
         // 自由边界分析
         if (verbose) {
-            std::cout << "\n🔗 自由边界分析..." << std::endl;
+            SPRAY_LOG_INFO << "\n🔗 自由边界分析...";
         }
         
         ShapeAnalysis_FreeBounds freeBoundsAnalyzer(shape);
@@ -91,13 +95,13 @@ bool OCCHandler::validateAndAnalyzeShape(bool verbose) {
         for (TopExp_Explorer exp(openWires, TopAbs_WIRE); exp.More(); exp.Next()) openWireCount++;
         
         if (verbose) {
-            std::cout << "   封闭自由边界: " << closedWireCount << std::endl;
-            std::cout << "   开放自由边界: " << openWireCount << std::endl;
+            SPRAY_LOG_INFO << "   封闭自由边界: " << closedWireCount;
+            SPRAY_LOG_INFO << "   开放自由边界: " << openWireCount;
         }
 
         // 小面检查
         if (verbose) {
-            std::cout << "\n🔬 小面检查..." << std::endl;
+            SPRAY_LOG_INFO << "\n🔬 小面检查...";
         }
         
         ShapeAnalysis_CheckSmallFace smallFaceChecker;
@@ -117,13 +121,13 @@ bool OCCHandler::validateAndAnalyzeShape(bool verbose) {
         }
         
         if (verbose) {
-            std::cout << "   点状小面: " << spotFaceCount << std::endl;
-            std::cout << "   条状小面: " << stripFaceCount << std::endl;
+            SPRAY_LOG_INFO << "   点状小面: " << spotFaceCount;
+            SPRAY_LOG_INFO << "   条状小面: " << stripFaceCount;
         }
 
         // 边分析
         if (verbose) {
-            std::cout << "\n📏 边分析..." << std::endl;
+            SPRAY_LOG_INFO << "\n📏 边分析...";
         }
         
         ShapeAnalysis_Edge edgeAnalyzer;
@@ -144,13 +148,13 @@ bool OCCHandler::validateAndAnalyzeShape(bool verbose) {
         }
         
         if (verbose) {
-            std::cout << "   缺少3D曲线的边: " << edgesWithoutCurve3d << std::endl;
-            std::cout << "   SameParameter问题的边: " << edgesWithSameParameterIssues << std::endl;
+            SPRAY_LOG_INFO << "   缺少3D曲线的边: " << edgesWithoutCurve3d;
+            SPRAY_LOG_INFO << "   SameParameter问题的边: " << edgesWithSameParameterIssues;
         }
 
         // 壳分析
         if (verbose) {
-            std::cout << "\n🐚 壳分析..." << std::endl;
+            SPRAY_LOG_INFO << "\n🐚 壳分析...";
         }
 
         int shellCount = 0;
@@ -171,13 +175,13 @@ bool OCCHandler::validateAndAnalyzeShape(bool verbose) {
         }
 
         if (verbose) {
-            std::cout << "   壳总数: " << shellCount << std::endl;
-            std::cout << "   无效壳数: " << invalidShellCount << std::endl;
+            SPRAY_LOG_INFO << "   壳总数: " << shellCount;
+            SPRAY_LOG_INFO << "   无效壳数: " << invalidShellCount;
         }
 
         // 总体统计
         if (verbose) {
-            std::cout << "\n📊 总体统计..." << std::endl;
+            SPRAY_LOG_INFO << "\n📊 总体统计...";
         }
         
         int solidCount = 0, faceCount = 0, wireCount = 0, edgeCount = 0, vertexCount = 0;
@@ -188,17 +192,17 @@ bool OCCHandler::validateAndAnalyzeShape(bool verbose) {
         for (TopExp_Explorer exp(shape, TopAbs_VERTEX); exp.More(); exp.Next()) vertexCount++;
         
         if (verbose) {
-            std::cout << "   实体: " << solidCount << std::endl;
-            std::cout << "   壳: " << shellCount << std::endl;
-            std::cout << "   面: " << faceCount << std::endl;
-            std::cout << "   线框: " << wireCount << std::endl;
-            std::cout << "   边: " << edgeCount << std::endl;
-            std::cout << "   顶点: " << vertexCount << std::endl;
+            SPRAY_LOG_INFO << "   实体: " << solidCount;
+            SPRAY_LOG_INFO << "   壳: " << shellCount;
+            SPRAY_LOG_INFO << "   面: " << faceCount;
+            SPRAY_LOG_INFO << "   线框: " << wireCount;
+            SPRAY_LOG_INFO << "   边: " << edgeCount;
+            SPRAY_LOG_INFO << "   顶点: " << vertexCount;
         }
 
         // 边界盒信息
         if (verbose) {
-            std::cout << "\n📦 边界盒信息..." << std::endl;
+            SPRAY_LOG_INFO << "\n📦 边界盒信息...";
         }
         
         Bnd_Box boundingBox;
@@ -207,14 +211,14 @@ bool OCCHandler::validateAndAnalyzeShape(bool verbose) {
         boundingBox.Get(xMin, yMin, zMin, xMax, yMax, zMax);
         
         if (verbose) {
-            std::cout << "   X范围: [" << xMin << ", " << xMax << "] (长度: " << (xMax - xMin) << ")" << std::endl;
-            std::cout << "   Y范围: [" << yMin << ", " << yMax << "] (长度: " << (yMax - yMin) << ")" << std::endl;
-            std::cout << "   Z范围: [" << zMin << ", " << zMax << "] (长度: " << (zMax - zMin) << ")" << std::endl;
+            SPRAY_LOG_INFO << "   X范围: [" << xMin << ", " << xMax << "] (长度: " << (xMax - xMin) << ")";
+            SPRAY_LOG_INFO << "   Y范围: [" << yMin << ", " << yMax << "] (长度: " << (yMax - yMin) << ")";
+            SPRAY_LOG_INFO << "   Z范围: [" << zMin << ", " << zMax << "] (长度: " << (zMax - zMin) << ")";
         }
 
         // 质量评估
         if (verbose) {
-            std::cout << "\n⭐ 质量评估..." << std::endl;
+            SPRAY_LOG_INFO << "\n⭐ 质量评估...";
         }
         
         bool highQuality = isValid && 
@@ -225,25 +229,25 @@ bool OCCHandler::validateAndAnalyzeShape(bool verbose) {
         
         if (verbose) {
             if (highQuality) {
-                std::cout << "🏆 模型质量: 优秀 - 适合高精度喷涂轨迹生成" << std::endl;
+                SPRAY_LOG_INFO << "🏆 模型质量: 优秀 - 适合高精度喷涂轨迹生成";
             } else if (isValid) {
-                std::cout << "👍 模型质量: 良好 - 适合一般喷涂轨迹生成" << std::endl;
+                SPRAY_LOG_INFO << "👍 模型质量: 良好 - 适合一般喷涂轨迹生成";
             } else {
-                std::cout << "⚠️ 模型质量: 需要修复 - 建议先进行修复再生成轨迹" << std::endl;
+                SPRAY_LOG_WARN << "⚠️ 模型质量: 需要修复 - 建议先进行修复再生成轨迹";
             }
-            std::cout << "✅ 形状验证和分析完成！" << std::endl;
+            SPRAY_LOG_INFO << "✅ 形状验证和分析完成！";
         }
 
         return isValid;
 
     } catch (const std::exception& e) {
         if (verbose) {
-            std::cerr << "❌ 验证分析过程中发生异常: " << e.what() << std::endl;
+            SPRAY_LOG_ERROR << "❌ 验证分析过程中发生异常: " << e.what();
         }
         return false;
     } catch (...) {
         if (verbose) {
-            std::cerr << "❌ 验证分析过程中发生未知异常" << std::endl;
+            SPRAY_LOG_ERROR << "❌ 验证分析过程中发生未知异常";
         }
         return false;
     }
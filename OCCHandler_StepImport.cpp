@@ -0,0 +1,329 @@
+#include "OCCHandler.h"
+#include "SprayLog.h"
+#include "SprayProfiler.h"
+#include <STEPControl_Reader.hxx>
+#include <StepData_StepModel.hxx>
+#include <StepBasic_Product.hxx>
+#include <StepBasic_ProductDefinition.hxx>
+#include <StepBasic_ProductDefinitionFormation.hxx>
+#include <StepRepr_PropertyDefinition.hxx>
+#include <StepShape_ShapeDefinitionRepresentation.hxx>
+#include <TCollection_HAsciiString.hxx>
+#include <XSControl_WorkSession.hxx>
+#include <Message_ProgressScope.hxx>
+#include <OSD_Parallel.hxx>
+#include <Standard_Failure.hxx>
+#include <Standard_Version.hxx>
+#include <BRep_Builder.hxx>
+#include <BRepBndLib.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <IFSelect_ReturnStatus.hxx>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <vector>
+
+// 并行转换要求的最低OCCT版本：7.8之前转换仍依赖全局状态（Interface_Static参数、单位上下文），
+// 共享同一个StepModel的多个会话同时转换会产生数据竞争
+#define SPRAY_PARALLEL_STEP_TRANSFER_MIN_OCC_VERSION 0x070800
+
+// 最慢的根实体输出数量
+static const size_t SLOWEST_ROOTS_REPORTED = 5;
+
+// 获取STEP根实体对应的产品名称，无法获取时返回空字符串
+static std::string stepProductName(const Handle(Standard_Transient)& entity) {
+    Handle(StepBasic_ProductDefinition) productDefinition = Handle(StepBasic_ProductDefinition)::DownCast(entity);
+
+    Handle(StepShape_ShapeDefinitionRepresentation) shapeRepresentation =
+        Handle(StepShape_ShapeDefinitionRepresentation)::DownCast(entity);
+    if (productDefinition.IsNull() && !shapeRepresentation.IsNull()) {
+        Handle(StepRepr_PropertyDefinition) property = shapeRepresentation->Definition().PropertyDefinition();
+        if (!property.IsNull()) {
+            productDefinition = property->Definition().ProductDefinition();
+        }
+    }
+
+    if (!productDefinition.IsNull() && !productDefinition->Formation().IsNull()) {
+        Handle(StepBasic_Product) product = productDefinition->Formation()->OfProduct();
+        if (!product.IsNull() && !product->Name().IsNull() && product->Name()->Length() > 0) {
+            return product->Name()->ToCString();
+        }
+    }
+    return std::string();
+}
+
+// 获取STEP实体的标签（如 #123）
+static std::string stepEntityLabel(const Handle(StepData_StepModel)& model, const Handle(Standard_Transient)& entity) {
+    Handle(TCollection_HAsciiString) label = model->StringLabel(entity);
+    return label.IsNull() ? std::string() : std::string(label->ToCString());
+}
+
+// 获取STEP根实体的显示名称：产品名称，无法获取时为实体类型与标签
+static std::string stepRootName(const Handle(StepData_StepModel)& model, const Handle(Standard_Transient)& entity) {
+    std::string name = stepProductName(entity);
+    if (!name.empty()) {
+        return name;
+    }
+    name = entity.IsNull() ? "?" : entity->DynamicType()->Name();
+    std::string label = stepEntityLabel(model, entity);
+    if (!label.empty()) {
+        name += " " + label;
+    }
+    return name;
+}
+
+// 包围盒是否完全在区域内
+static bool isBoxInside(const Bnd_Box& box, const Bnd_Box& region) {
+    Standard_Real xmin, ymin, zmin, xmax, ymax, zmax;
+    box.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+    return !region.IsOut(gp_Pnt(xmin, ymin, zmin)) && !region.IsOut(gp_Pnt(xmax, ymax, zmax));
+}
+
+// 选择范围的缓存标签（加载全部时为空，与未选择时的缓存键一致）
+std::string StepLoadSelection::tag() const {
+    std::ostringstream stream;
+    if (!rootIndices.empty()) {
+        stream << ";roots=";
+        for (size_t i = 0; i < rootIndices.size(); i++) {
+            stream << (i > 0 ? "," : "") << rootIndices[i];
+        }
+    }
+    if (useRegion && !region.IsVoid()) {
+        Standard_Real xmin, ymin, zmin, xmax, ymax, zmax;
+        region.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+        stream << ";region=" << xmin << "," << ymin << "," << zmin << "," << xmax << "," << ymax << "," << zmax;
+    }
+    return stream.str();
+}
+
+// 列出STEP文件的根实体（只读取文件，不转换几何）
+bool OCCHandler::listStepProducts(const std::string& filename, std::vector<StepProductInfo>& products) const {
+    SPRAY_PROFILE_SCOPE("occ.listStepProducts");
+    products.clear();
+
+    STEPControl_Reader reader;
+    if (reader.ReadFile(filename.c_str()) != IFSelect_RetDone) {
+        SPRAY_LOG_WARN << "STEP文件加载失败: " << filename;
+        return false;
+    }
+
+    Handle(StepData_StepModel) model = reader.StepModel();
+    const int rootCount = reader.NbRootsForTransfer();
+    products.reserve(rootCount);
+    for (int i = 1; i <= rootCount; i++) {
+        Handle(Standard_Transient) root = reader.RootForTransfer(i);
+        StepProductInfo info;
+        info.rootIndex = i;
+        info.name = stepProductName(root);
+        info.entityType = root.IsNull() ? "?" : root->DynamicType()->Name();
+        info.label = stepEntityLabel(model, root);
+        products.push_back(info);
+    }
+    return true;
+}
+
+// 只加载指定的根实体
+bool OCCHandler::loadStepProducts(const std::string& filename, const std::vector<int>& rootIndices,
+                                  bool moveToOrigin, bool autoRepair, const Message_ProgressRange& range) {
+    StepLoadSelection selection;
+    selection.rootIndices = rootIndices;
+    return loadStepSelection(filename, selection, moveToOrigin, autoRepair, range);
+}
+
+// 只加载与关注区域相交的部分
+bool OCCHandler::loadStepRegion(const std::string& filename, const Bnd_Box& region,
+                                bool moveToOrigin, bool autoRepair, const Message_ProgressRange& range) {
+    StepLoadSelection selection;
+    selection.useRegion = true;
+    selection.region = region;
+    return loadStepSelection(filename, selection, moveToOrigin, autoRepair, range);
+}
+
+// 转换根实体（全部或指定的根实体），按设置选择串行或并行
+bool OCCHandler::transferStepRoots(STEPControl_Reader& reader, const std::vector<int>& rootIndices,
+                                   TopoDS_Shape& result, const Message_ProgressRange& range) {
+    const int rootCount = reader.NbRootsForTransfer();
+    for (int index : rootIndices) {
+        if (index < 1 || index > rootCount) {
+            SPRAY_LOG_WARN << "⚠️ 根实体序号超出范围: " << index << "（共 " << rootCount << " 个）";
+            return false;
+        }
+    }
+
+    if (parallelImport) {
+#if OCC_VERSION_HEX >= SPRAY_PARALLEL_STEP_TRANSFER_MIN_OCC_VERSION
+        return transferStepRootsParallel(reader, rootIndices, result, range);
+#else
+        SPRAY_LOG_WARN << "⚠️ 并行转换STEP根实体需要OCCT 7.8及以上（当前 " << OCC_VERSION_COMPLETE << "），改为串行转换";
+#endif
+    }
+
+    if (rootIndices.empty()) {
+        reader.TransferRoots(range);
+    } else {
+        Message_ProgressScope scope(range, "转换根实体", static_cast<Standard_Real>(rootIndices.size()));
+        for (size_t i = 0; i < rootIndices.size() && scope.More(); i++) {
+            reader.TransferRoot(rootIndices[i], scope.Next());
+        }
+        SPRAY_LOG_INFO << "📦 已转换 " << rootIndices.size() << "/" << rootCount << " 个根实体";
+    }
+    result = reader.OneShape();
+    return !result.IsNull();
+}
+
+// 按关注区域筛选：完全在区域外的部分丢弃；与区域部分相交的复合体（装配体）逐个子形状筛选，
+// 其余形状整体保留（子形状带有装配体中的位置）
+TopoDS_Shape OCCHandler::filterShapeByRegion(const TopoDS_Shape& source, const Bnd_Box& region) const {
+    Bnd_Box box;
+    BRepBndLib::Add(source, box);
+    if (box.IsVoid() || box.IsOut(region)) {
+        SPRAY_COUNTER_ADD("load.regionShapesDropped", 1);
+        return TopoDS_Shape();
+    }
+    if (source.ShapeType() != TopAbs_COMPOUND || isBoxInside(box, region)) {
+        return source;
+    }
+
+    TopoDS_Compound compound;
+    BRep_Builder builder;
+    builder.MakeCompound(compound);
+    int keptCount = 0;
+    for (TopoDS_Iterator it(source); it.More(); it.Next()) {
+        TopoDS_Shape child = filterShapeByRegion(it.Value(), region);
+        if (!child.IsNull()) {
+            builder.Add(compound, child);
+            keptCount++;
+        }
+    }
+    return keptCount > 0 ? TopoDS_Shape(compound) : TopoDS_Shape();
+}
+
+// 设置是否并行转换STEP根实体
+void OCCHandler::setParallelImport(bool enabled) {
+    parallelImport = enabled;
+}
+
+// 是否并行转换STEP根实体
+bool OCCHandler::isParallelImport() const {
+    return parallelImport;
+}
+
+// 最近一次并行转换的各根实体耗时
+const std::vector<StepRootTiming>& OCCHandler::getStepRootTimings() const {
+    return stepRootTimings;
+}
+
+// 并行转换STEP根实体：模型只读取一次，每个工作线程使用独立的会话，结果按根实体顺序组成复合体
+bool OCCHandler::transferStepRootsParallel(STEPControl_Reader& reader, const std::vector<int>& rootIndices,
+                                           TopoDS_Shape& result, const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("occ.loadStepFile.transferParallel");
+    stepRootTimings.clear();
+
+    Handle(StepData_StepModel) model = reader.StepModel();
+    std::vector<int> selected = rootIndices;
+    if (selected.empty()) {
+        for (int i = 1; i <= reader.NbRootsForTransfer(); i++) {
+            selected.push_back(i);
+        }
+    }
+    const int rootCount = static_cast<int>(selected.size());
+    if (model.IsNull() || rootCount <= 0) {
+        return false;
+    }
+
+    // 根实体列表在主线程中取出，工作线程只读
+    std::vector<Handle(Standard_Transient)> roots(rootCount);
+    for (int i = 0; i < rootCount; i++) {
+        roots[i] = reader.RootForTransfer(selected[i]);
+    }
+
+    // 每个根实体的进度范围在主线程中预先分配
+    Message_ProgressScope scope(range, "转换根实体", static_cast<Standard_Real>(rootCount));
+    std::vector<Message_ProgressRange> rootRanges;
+    rootRanges.reserve(rootCount);
+    for (int i = 0; i < rootCount; i++) {
+        rootRanges.push_back(scope.Next());
+    }
+
+    std::vector<TopTools_ListOfShape> rootShapes(rootCount);
+    std::vector<StepRootTiming> timings(rootCount);
+    std::atomic<int> nextRoot(0);
+    const int workerCount = std::max(1, std::min(rootCount, OSD_Parallel::NbLogicalProcessors()));
+
+    SPRAY_LOG_INFO << "🧵 并行转换 " << rootCount << " 个根实体（" << workerCount << " 个线程）";
+
+    // 转换过程中的实体-形状映射保存在会话中，不能跨线程共享；工作线程按顺序领取下一个根实体，
+    // 大小不均的子装配体也能分摊到各线程
+    OSD_Parallel::For(0, workerCount, [&](int) {
+        STEPControl_Reader workerReader(new XSControl_WorkSession(), Standard_False);
+        workerReader.WS()->SetModel(model, Standard_False);
+
+        for (int i = nextRoot++; i < rootCount; i = nextRoot++) {
+            StepRootTiming& timing = timings[i];
+            timing.rootIndex = selected[i];
+            timing.name = stepRootName(model, roots[i]);
+            if (rootRanges[i].UserBreak()) {
+                continue;
+            }
+
+            SPRAY_PROFILE_SCOPE("occ.loadStepFile.transferRoot");
+            auto start = std::chrono::steady_clock::now();
+            int shapesBefore = workerReader.NbShapes();
+            try {
+                workerReader.TransferEntity(roots[i], rootRanges[i]);
+            } catch (const Standard_Failure& e) {
+                SPRAY_LOG_WARN << "⚠️ 根实体 " << timing.rootIndex << " (" << timing.name << ") 转换失败: "
+                               << e.GetMessageString();
+            } catch (...) {
+                SPRAY_LOG_WARN << "⚠️ 根实体 " << timing.rootIndex << " (" << timing.name << ") 转换失败";
+            }
+            for (int s = shapesBefore + 1; s <= workerReader.NbShapes(); s++) {
+                rootShapes[i].Append(workerReader.Shape(s));
+            }
+            timing.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            timing.shapeCount = rootShapes[i].Extent();
+        }
+    }, workerCount == 1);
+
+    if (!scope.More()) {
+        return false;
+    }
+
+    // 按根实体顺序组装（与 OneShape 一致：只有一个形状时直接返回该形状）
+    TopoDS_Compound compound;
+    BRep_Builder builder;
+    builder.MakeCompound(compound);
+    int shapeCount = 0;
+    TopoDS_Shape singleShape;
+    for (const TopTools_ListOfShape& shapes : rootShapes) {
+        for (TopTools_ListOfShape::Iterator it(shapes); it.More(); it.Next()) {
+            builder.Add(compound, it.Value());
+            singleShape = it.Value();
+            shapeCount++;
+        }
+    }
+    if (shapeCount == 0) {
+        return false;
+    }
+    result = shapeCount == 1 ? singleShape : TopoDS_Shape(compound);
+
+    SPRAY_COUNTER_ADD("load.stepRoots", rootCount);
+    for (const StepRootTiming& timing : timings) {
+        SPRAY_LOG_DEBUG << "   根实体 " << timing.rootIndex << " (" << timing.name << "): "
+                        << timing.seconds << " 秒, " << timing.shapeCount << " 个形状";
+    }
+
+    // 报告最慢的根实体，便于定位转换缓慢的子装配体
+    stepRootTimings = timings;
+    std::vector<StepRootTiming> slowest = timings;
+    std::sort(slowest.begin(), slowest.end(),
+              [](const StepRootTiming& a, const StepRootTiming& b) { return a.seconds > b.seconds; });
+    slowest.resize(std::min(slowest.size(), SLOWEST_ROOTS_REPORTED));
+    SPRAY_LOG_INFO << "⏱️ 转换最慢的根实体:";
+    for (const StepRootTiming& timing : slowest) {
+        SPRAY_LOG_INFO << "   #" << timing.rootIndex << " " << timing.name << ": " << timing.seconds << " 秒";
+    }
+    return true;
+}
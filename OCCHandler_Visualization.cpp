@@ -1,8 +1,13 @@
 #include "OCCHandler.h"
+#include "SprayLog.h"
+#include "SprayProfiler.h"
+#include "FaceNormalService.h"
 #include <BRep_Tool.hxx>
 #include <BRepTools.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
+#include <TopExp.hxx>
 #include <TopExp_Explorer.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
 #include <Poly_Triangulation.hxx>
 #include <TopoDS.hxx>
 #include <TopoDS_Face.hxx>
@@ -12,6 +17,8 @@
 #include <TColgp_Array1OfPnt.hxx>
 #include <Poly_Array1OfTriangle.hxx>
 #include <Poly_Triangle.hxx>
+#include <Poly_PolygonOnTriangulation.hxx>
+#include <Poly_Polygon3D.hxx>
 #include <vtkSmartPointer.h>
 #include <vtkPoints.h>
 #include <vtkCellArray.h>
@@ -34,8 +41,10 @@ vtkSmartPointer<vtkPolyData> OCCHandler::shapeToPolyData() const {
 
 // TopoDS_Shape转vtkPolyData（带参数）
 vtkSmartPointer<vtkPolyData> OCCHandler::shapeToPolyData(const TopoDS_Shape& shape) const {
+    SPRAY_PROFILE_SCOPE("occ.shapeToPolyData");
+
     // 对形状进行三角剖分
-    BRepMesh_IncrementalMesh mesher(shape, 0.5);
+    BRepMesh_IncrementalMesh mesher(shape, OCC_MESH_DEFLECTION);
     auto polyData = vtkSmartPointer<vtkPolyData>::New();
     auto points = vtkSmartPointer<vtkPoints>::New();
     auto triangles = vtkSmartPointer<vtkCellArray>::New();
@@ -161,69 +170,101 @@ vtkSmartPointer<vtkPolyData> OCCHandler::shapeToPolyData(const TopoDS_Shape& sha
     return polyData;
 }
 
-// 计算shell的主法向量方向
-gp_Dir OCCHandler::calculateShellMainNormal(const TopoDS_Shell& shell) const {
-    if (shell.IsNull()) {
-        std::cerr << "⚠️ Shell为空，返回默认法向量" << std::endl;
-        return gp_Dir(0, 0, 1);
-    }
+// B-rep边转vtkPolyData折线（无默认参数）
+vtkSmartPointer<vtkPolyData> OCCHandler::shapeEdgesToPolyData() const {
+    return shapeEdgesToPolyData(shape);
+}
 
-    gp_Vec averageNormal(0, 0, 0);
-    double totalArea = 0.0;
+// B-rep边转vtkPolyData折线（带参数）
+// 每条边只输出一次：优先取相邻面三角剖分上的边多边形（与面网格的节点完全重合），
+// 没有相邻面的自由边取边自身的3D多边形。剖分与shapeToPolyData相同，已剖分时不会重复计算
+vtkSmartPointer<vtkPolyData> OCCHandler::shapeEdgesToPolyData(const TopoDS_Shape& shape) const {
+    SPRAY_PROFILE_SCOPE("occ.shapeEdgesToPolyData");
 
-    // 遍历shell中的所有面
-    for (TopExp_Explorer faceExplorer(shell, TopAbs_FACE); faceExplorer.More(); faceExplorer.Next()) {
-        TopoDS_Face face = TopoDS::Face(faceExplorer.Current());
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+    if (shape.IsNull()) {
+        return polyData;
+    }
 
-        double area = 0.0;
-        gp_Vec geometricNormal;
+    BRepMesh_IncrementalMesh mesher(shape, OCC_MESH_DEFLECTION);
+    auto points = vtkSmartPointer<vtkPoints>::New();
+    auto lines = vtkSmartPointer<vtkCellArray>::New();
 
-        try {
-            // 计算面的面积
-            GProp_GProps props;
-            BRepGProp::SurfaceProperties(face, props);
-            area = props.Mass();
+    TopTools_IndexedDataMapOfShapeListOfShape edgeFaces;
+    TopExp::MapShapesAndUniqueAncestors(shape, TopAbs_EDGE, TopAbs_FACE, edgeFaces);
 
-            if (area < 1e-10) {
-                continue; // 跳过面积过小的面
-            }
+    for (int i = 1; i <= edgeFaces.Extent(); i++) {
+        const TopoDS_Edge& edge = TopoDS::Edge(edgeFaces.FindKey(i));
+        if (BRep_Tool::Degenerated(edge)) {
+            continue;
+        }
 
-            // 计算面的几何法向量
-            BRepAdaptor_Surface surfaceAdaptor(face);
+        // 在相邻面的三角剖分上查找边多边形
+        std::vector<gp_Pnt> edgePoints;
+        for (TopTools_ListIteratorOfListOfShape faceIt(edgeFaces(i)); faceIt.More() && edgePoints.empty(); faceIt.Next()) {
+            TopLoc_Location loc;
+            Handle(Poly_Triangulation) tri = BRep_Tool::Triangulation(TopoDS::Face(faceIt.Value()), loc);
+            if (tri.IsNull()) {
+                continue;
+            }
+            Handle(Poly_PolygonOnTriangulation) polygon = BRep_Tool::PolygonOnTriangulation(edge, tri, loc);
+            if (polygon.IsNull()) {
+                continue;
+            }
+            const gp_Trsf& trsf = loc.Transformation();
+            for (int n = 1; n <= polygon->NbNodes(); n++) {
+                edgePoints.push_back(tri->Node(polygon->Node(n)).Transformed(trsf));
+            }
+        }
 
-            // 获取面的参数范围
-            Standard_Real uMin, uMax, vMin, vMax;
-            BRepTools::UVBounds(face, uMin, uMax, vMin, vMax);
+        // 自由边使用3D多边形
+        if (edgePoints.empty()) {
+            TopLoc_Location loc;
+            Handle(Poly_Polygon3D) polygon = BRep_Tool::Polygon3D(edge, loc);
+            if (!polygon.IsNull()) {
+                const gp_Trsf& trsf = loc.Transformation();
+                for (int n = 1; n <= polygon->NbNodes(); n++) {
+                    edgePoints.push_back(polygon->Nodes().Value(n).Transformed(trsf));
+                }
+            }
+        }
 
-            // 在面的中心点计算法向量
-            Standard_Real uMid = (uMin + uMax) / 2.0;
-            Standard_Real vMid = (vMin + vMax) / 2.0;
+        if (edgePoints.size() < 2) {
+            continue;
+        }
+        lines->InsertNextCell(static_cast<vtkIdType>(edgePoints.size()));
+        for (const gp_Pnt& p : edgePoints) {
+            lines->InsertCellPoint(points->InsertNextPoint(p.X(), p.Y(), p.Z()));
+        }
+    }
 
-            gp_Pnt point;
-            gp_Vec du, dv;
-            surfaceAdaptor.D1(uMid, vMid, point, du, dv);
+    polyData->SetPoints(points);
+    polyData->SetLines(lines);
+    SPRAY_COUNTER_ADD("edges.polylines", static_cast<long long>(lines->GetNumberOfCells()));
+    return polyData;
+}
 
-            // 计算几何法向量（du × dv）
-            geometricNormal = du.Crossed(dv);
-            if (geometricNormal.Magnitude() < 1e-10) {
-                continue; // 跳过法向量计算失败的面
-            }
+// 计算shell的主法向量方向
+gp_Dir OCCHandler::calculateShellMainNormal(const TopoDS_Shell& shell) const {
+    if (shell.IsNull()) {
+        SPRAY_LOG_WARN << "⚠️ Shell为空，返回默认法向量";
+        return gp_Dir(0, 0, 1);
+    }
 
-            geometricNormal.Normalize();
-        } catch (...) {
-            continue; // 跳过计算失败的面
-        }
+    gp_Vec averageNormal(0, 0, 0);
+    double totalArea = 0.0;
 
-        // 考虑面的拓扑方向，创建最终的法向量
-        gp_Vec finalNormal(geometricNormal.X(), geometricNormal.Y(), geometricNormal.Z());
+    // 遍历shell中的所有面，按面积加权累加面法向量（经面法向量服务，已缓存的面直接复用）
+    for (TopExp_Explorer faceExplorer(shell, TopAbs_FACE); faceExplorer.More(); faceExplorer.Next()) {
+        TopoDS_Face face = TopoDS::Face(faceExplorer.Current());
 
-        // 如果面的方向是反向的，则反转法向量
-        if (face.Orientation() == TopAbs_REVERSED) {
-            finalNormal.Reverse();
+        gp_Dir faceNormal;
+        double area = 0.0;
+        if (!faceNormalService->normalAndArea(face, faceNormal, area) || area < 1e-10) {
+            continue; // 跳过面积过小或法向量计算失败的面
         }
 
-        // 使用面积作为权重，累加面的法向量
-        averageNormal += finalNormal * area;
+        averageNormal += gp_Vec(faceNormal) * area;
         totalArea += area;
     }
 
@@ -5,10 +5,15 @@
 set(OCCHANDLER_SOURCES
     # 核心功能模块
     OCCHandler_Core.cpp
+    OCCHandler_StepImport.cpp
     
     # 修复功能模块
     OCCHandler_Repair.cpp
     OCCHandler_AdvancedRepair.cpp
+    OCCHandler_PartitionedRepair.cpp
+    OCCHandler_RepairPlanner.cpp
+    OCCHandler_Sewing.cpp
+    RepairContext.cpp
     
     # 面处理模块
     OCCHandler_FaceProcessing.cpp
@@ -21,21 +26,48 @@ set(OCCHANDLER_SOURCES
     
     # 遮挡处理模块
     OCCHandler_Occlusion.cpp
+    OcclusionCache.cpp
+    FaceNormalService.cpp
+
+    # 模型缓存
+    ShapeCache.cpp
+
+    # 性能埋点
+    SprayProfiler.cpp
+
+    # 日志
+    SprayLog.cpp
 )
 
 # OCCHandler头文件
 set(OCCHANDLER_HEADERS
     OCCHandler.h
+    OcclusionCache.h
+    FaceNormalService.h
+    ShapeCache.h
+    RepairContext.h
+    SprayProfiler.h
+    SprayLog.h
 )
 
 # 模块说明
 # OCCHandler_Core.cpp           - 核心功能：构造函数、STEP加载、基本操作
+# OCCHandler_StepImport.cpp     - STEP导入：并行转换根实体
 # OCCHandler_Repair.cpp         - 基础修复：基本修复、小面小边修复、线框修复
 # OCCHandler_AdvancedRepair.cpp - 高级修复：增强修复、喷涂轨迹优化修复
+# OCCHandler_PartitionedRepair.cpp - 分区修复：按实体/壳/空间簇拆分后并行修复
+# OCCHandler_RepairPlanner.cpp  - 计划修复：诊断后只执行需要的修复操作
+# OCCHandler_Sewing.cpp         - 缝合：空间分区并行预缝合与全局缝合
+# RepairContext.cpp             - 修复上下文：后备修复链共享诊断、缝合结果与原始快照
 # OCCHandler_FaceProcessing.cpp - 面处理：面提取、分层、缝合
 # OCCHandler_ShapeAnalysis.cpp  - 形状分析：验证、分析、质量评估
 # OCCHandler_Visualization.cpp  - 可视化：VTK转换、法向量计算
 # OCCHandler_Occlusion.cpp      - 遮挡处理：遮挡检测、布尔裁剪
+# OcclusionCache.cpp            - 遮挡缓存：逐面裁剪结果复用（增量重算）
+# FaceNormalService.cpp         - 面法向量服务：按TShape缓存面积加权法向量，批量并行计算
+# ShapeCache.cpp                - 模型缓存：修复后模型的二进制BREP磁盘缓存（按文件内容与修复参数）
+# SprayProfiler.cpp             - 性能埋点：阶段计时、计数器、JSON/Chrome Trace报告
+# SprayLog.cpp                  - 日志：编译期/运行时级别、异步批量输出、按调用点限流
 
 # 使用方法：
 # 在主CMakeLists.txt中包含此文件：
@@ -0,0 +1,196 @@
+#include "OcclusionCache.h"
+#include <TopoDS_TShape.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopTools_ListIteratorOfListOfShape.hxx>
+#include <cmath>
+#include <functional>
+
+// 缓存项在最近多少次计算中未被使用后淘汰
+static const int OCCLUSION_CACHE_MAX_IDLE_RUNS = 8;
+
+// OcclusionFaceKey的哈希函数
+size_t OcclusionFaceKeyHasher::operator()(const OcclusionFaceKey& key) const {
+    size_t seed = std::hash<const void*>()(key.tshape);
+    seed ^= std::hash<int>()(key.orientation) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    for (long long value : key.location) {
+        seed ^= std::hash<long long>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+// 构造函数
+OcclusionCache::OcclusionCache() : directionKey{0, 0, 0}, runCounter(0), hits(0), misses(0) {
+}
+
+// 开始一次遮挡计算
+void OcclusionCache::beginRun(const gp_Trsf& modelTransform, const gp_Dir& projectionDirection) {
+    modelToWorld = modelTransform;
+    worldToModel = modelTransform.Inverted();
+
+    // 投影方向换算到模型坐标系：绕投影方向旋转或整体平移后方向不变，缓存可继续命中
+    gp_Dir modelDirection = projectionDirection.Transformed(worldToModel);
+    directionKey = { quantize(modelDirection.X()), quantize(modelDirection.Y()), quantize(modelDirection.Z()) };
+
+    runCounter++;
+    hits = 0;
+    misses = 0;
+}
+
+// 结束本次计算
+void OcclusionCache::endRun(int& hitCount, int& missCount) {
+    hitCount = hits;
+    missCount = misses;
+
+    // 淘汰长期未使用的缓存项，避免反复编辑后缓存无限增长
+    for (auto* cache : { &cutCache, &coverageCache }) {
+        for (auto dirIt = cache->begin(); dirIt != cache->end();) {
+            EntryMap& entries = dirIt->second;
+            for (auto it = entries.begin(); it != entries.end();) {
+                if (runCounter - it->second.lastUsedRun > OCCLUSION_CACHE_MAX_IDLE_RUNS) {
+                    it = entries.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            if (entries.empty()) {
+                dirIt = cache->erase(dirIt);
+            } else {
+                ++dirIt;
+            }
+        }
+    }
+}
+
+// 计算面的缓存标识
+OcclusionFaceKey OcclusionCache::makeKey(const TopoDS_Shape& face) const {
+    OcclusionFaceKey key;
+    key.tshape = face.TShape().get();
+    key.orientation = static_cast<int>(face.Orientation());
+
+    // 面在模型坐标系下的位置：世界位置左乘模型整体变换的逆
+    gp_Trsf modelLocation = worldToModel.Multiplied(face.Location().Transformation());
+    int index = 0;
+    for (int row = 1; row <= 3; row++) {
+        for (int col = 1; col <= 4; col++) {
+            key.location[index++] = quantize(modelLocation.Value(row, col));
+        }
+    }
+    return key;
+}
+
+// 查找逐面裁剪结果
+bool OcclusionCache::findCutResult(const OcclusionFaceKey& key,
+                                   const std::vector<OcclusionFaceKey>& signature,
+                                   long long heightOffset,
+                                   TopTools_ListOfShape& fragments) {
+    EntryMap& entries = cutEntries();
+    auto it = entries.find(key);
+    if (it == entries.end() || it->second.heightOffset != heightOffset || it->second.signature != signature) {
+        misses++;
+        return false;
+    }
+
+    // 缓存结果保存在模型坐标系下，换算回当前世界坐标系
+    fragments.Clear();
+    TopLoc_Location toWorld(modelToWorld);
+    for (TopTools_ListIteratorOfListOfShape fragmentIt(it->second.fragments); fragmentIt.More(); fragmentIt.Next()) {
+        fragments.Append(fragmentIt.Value().Moved(toWorld));
+    }
+
+    it->second.lastUsedRun = runCounter;
+    hits++;
+    return true;
+}
+
+// 保存逐面裁剪结果
+void OcclusionCache::storeCutResult(const OcclusionFaceKey& key,
+                                    const TopoDS_Shape& face,
+                                    const std::vector<OcclusionFaceKey>& signature,
+                                    const TopTools_ListOfShape& occluders,
+                                    long long heightOffset,
+                                    const TopTools_ListOfShape& fragments) {
+    Entry& entry = cutEntries()[key];
+    entry.face = face;
+    entry.signature = signature;
+    entry.occluders = occluders;
+    entry.heightOffset = heightOffset;
+    entry.lastUsedRun = runCounter;
+
+    entry.fragments.Clear();
+    TopLoc_Location toModel(worldToModel);
+    for (TopTools_ListIteratorOfListOfShape fragmentIt(fragments); fragmentIt.More(); fragmentIt.Next()) {
+        entry.fragments.Append(fragmentIt.Value().Moved(toModel));
+    }
+}
+
+// 查找跨层遮挡判定结果
+bool OcclusionCache::findCoverageResult(const OcclusionFaceKey& key,
+                                        const std::vector<OcclusionFaceKey>& signature,
+                                        bool& mostlyOccluded) {
+    EntryMap& entries = coverageEntries();
+    auto it = entries.find(key);
+    if (it == entries.end() || it->second.signature != signature) {
+        misses++;
+        return false;
+    }
+
+    mostlyOccluded = it->second.mostlyOccluded;
+    it->second.lastUsedRun = runCounter;
+    hits++;
+    return true;
+}
+
+// 保存跨层遮挡判定结果
+void OcclusionCache::storeCoverageResult(const OcclusionFaceKey& key,
+                                         const TopoDS_Shape& face,
+                                         const std::vector<OcclusionFaceKey>& signature,
+                                         const TopTools_ListOfShape& occluders,
+                                         bool mostlyOccluded) {
+    Entry& entry = coverageEntries()[key];
+    entry.face = face;
+    entry.signature = signature;
+    entry.occluders = occluders;
+    entry.mostlyOccluded = mostlyOccluded;
+    entry.lastUsedRun = runCounter;
+}
+
+// 清空所有缓存项
+void OcclusionCache::clear() {
+    cutCache.clear();
+    coverageCache.clear();
+}
+
+// 缓存项总数
+size_t OcclusionCache::size() const {
+    size_t total = 0;
+    for (const auto& dirEntries : cutCache) {
+        total += dirEntries.second.size();
+    }
+    for (const auto& dirEntries : coverageCache) {
+        total += dirEntries.second.size();
+    }
+    return total;
+}
+
+// 将长度/坐标量化为整数
+long long OcclusionCache::quantize(double value) {
+    return std::llround(value * 1e6);
+}
+
+// 遮挡面签名中的层分隔标记
+OcclusionFaceKey OcclusionCache::layerSeparator(int layerIndex) {
+    OcclusionFaceKey separator;
+    separator.tshape = nullptr;
+    separator.orientation = -1 - layerIndex;
+    return separator;
+}
+
+// 当前投影方向下的逐面裁剪缓存表
+OcclusionCache::EntryMap& OcclusionCache::cutEntries() {
+    return cutCache[directionKey];
+}
+
+// 当前投影方向下的跨层遮挡缓存表
+OcclusionCache::EntryMap& OcclusionCache::coverageEntries() {
+    return coverageCache[directionKey];
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <TopoDS_Shape.hxx>
+#include <TopTools_ListOfShape.hxx>
+#include <gp_Trsf.hxx>
+#include <gp_Dir.hxx>
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+// 遮挡缓存中面的标识：TShape + 拓扑方向 + 模型坐标系下的位置（量化）
+// 模型整体旋转/平移不会改变该标识
+struct OcclusionFaceKey {
+    const void* tshape = nullptr;          // 底层TShape地址（nullptr用作层分隔标记）
+    int orientation = 0;                   // 拓扑方向
+    std::array<long long, 12> location{};  // 模型坐标系下位置矩阵的量化值
+
+    bool operator==(const OcclusionFaceKey& other) const {
+        return tshape == other.tshape && orientation == other.orientation && location == other.location;
+    }
+    bool operator!=(const OcclusionFaceKey& other) const {
+        return !(*this == other);
+    }
+};
+
+// OcclusionFaceKey的哈希函数
+struct OcclusionFaceKeyHasher {
+    size_t operator()(const OcclusionFaceKey& key) const;
+};
+
+// 遮挡裁剪结果缓存
+// 按面标识和投影方向（模型坐标系下）保存逐面裁剪结果。每个结果附带“遮挡面签名”，
+// 即当时在XY平面上与该面包围盒相交的所有上层面；只有签名一致时才复用结果，
+// 因此修改后只有与变化面在XY上相交的面会被重新裁剪。
+class OcclusionCache {
+public:
+    OcclusionCache();
+
+    // 开始一次遮挡计算：记录当前模型整体变换和投影方向（世界坐标系）
+    void beginRun(const gp_Trsf& modelTransform, const gp_Dir& projectionDirection);
+
+    // 结束本次计算：淘汰最近若干次计算都未使用的缓存项，并返回本次命中/未命中次数
+    void endRun(int& hitCount, int& missCount);
+
+    // 计算面的缓存标识（需在beginRun之后调用）
+    OcclusionFaceKey makeKey(const TopoDS_Shape& face) const;
+
+    // 查找逐面裁剪结果，命中时fragments为世界坐标系下的面片
+    bool findCutResult(const OcclusionFaceKey& key,
+                       const std::vector<OcclusionFaceKey>& signature,
+                       long long heightOffset,
+                       TopTools_ListOfShape& fragments);
+
+    // 保存逐面裁剪结果（fragments为世界坐标系下的面片，occluders为签名对应的遮挡面）
+    void storeCutResult(const OcclusionFaceKey& key,
+                        const TopoDS_Shape& face,
+                        const std::vector<OcclusionFaceKey>& signature,
+                        const TopTools_ListOfShape& occluders,
+                        long long heightOffset,
+                        const TopTools_ListOfShape& fragments);
+
+    // 查找跨层遮挡判定结果
+    bool findCoverageResult(const OcclusionFaceKey& key,
+                            const std::vector<OcclusionFaceKey>& signature,
+                            bool& mostlyOccluded);
+
+    // 保存跨层遮挡判定结果
+    void storeCoverageResult(const OcclusionFaceKey& key,
+                             const TopoDS_Shape& face,
+                             const std::vector<OcclusionFaceKey>& signature,
+                             const TopTools_ListOfShape& occluders,
+                             bool mostlyOccluded);
+
+    // 清空所有缓存项
+    void clear();
+
+    // 缓存项总数
+    size_t size() const;
+
+    // 将长度/坐标量化为整数（精度1e-6）
+    static long long quantize(double value);
+
+    // 遮挡面签名中的层分隔标记
+    static OcclusionFaceKey layerSeparator(int layerIndex);
+
+private:
+    // 一个面的缓存项
+    struct Entry {
+        TopoDS_Shape face;                       // 持有原始面，保证TShape地址在缓存期间不被复用
+        std::vector<OcclusionFaceKey> signature; // 遮挡面签名
+        TopTools_ListOfShape occluders;          // 签名对应的遮挡面（同样用于保持TShape地址有效）
+        long long heightOffset = 0;              // 投影平面相对面高度的偏移（量化）
+        TopTools_ListOfShape fragments;          // 模型坐标系下的裁剪结果
+        bool mostlyOccluded = false;             // 跨层遮挡判定结果
+        int lastUsedRun = 0;                     // 最近一次使用的计算序号
+    };
+
+    typedef std::unordered_map<OcclusionFaceKey, Entry, OcclusionFaceKeyHasher> EntryMap;
+    typedef std::array<long long, 3> DirectionKey;
+
+    // 当前投影方向下的缓存表
+    EntryMap& cutEntries();
+    EntryMap& coverageEntries();
+
+    std::map<DirectionKey, EntryMap> cutCache;      // 投影方向 -> 逐面裁剪结果
+    std::map<DirectionKey, EntryMap> coverageCache; // 投影方向 -> 跨层遮挡判定结果
+
+    gp_Trsf worldToModel;       // 世界坐标系 -> 模型坐标系
+    gp_Trsf modelToWorld;       // 模型坐标系 -> 世界坐标系
+    DirectionKey directionKey;  // 当前投影方向（模型坐标系，量化）
+    int runCounter;             // 计算序号
+    int hits;                   // 本次命中次数
+    int misses;                 // 本次未命中次数
+};
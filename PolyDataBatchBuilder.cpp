@@ -0,0 +1,166 @@
+#include "PolyDataBatchBuilder.h"
+#include "SprayProfiler.h"
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPointData.h>
+
+// 构造函数
+PolyDataBatchBuilder::PolyDataBatchBuilder(CellType cellType, bool singlePrecision)
+    : cellType(cellType), singlePrecision(singlePrecision), withNormals(false), withColors(false),
+      pointOffsets(1, 0), pointData(nullptr), normalData(nullptr), colorData(nullptr) {
+}
+
+// 输出法向量数组
+void PolyDataBatchBuilder::enableNormals() {
+    withNormals = true;
+}
+
+// 添加一个点标量数组
+int PolyDataBatchBuilder::addScalarArray(const std::string& name) {
+    scalarNames.push_back(name);
+    return static_cast<int>(scalarNames.size()) - 1;
+}
+
+// 输出RGB颜色数组
+void PolyDataBatchBuilder::enableColors() {
+    withColors = true;
+}
+
+// 设置批次数量
+void PolyDataBatchBuilder::setBatchCount(size_t count) {
+    pointOffsets.assign(count + 1, 0);
+}
+
+// 登记批次的点数（暂存在下一项中，allocate时转为前缀和）
+void PolyDataBatchBuilder::setBatchPointCount(size_t batch, vtkIdType pointCount) {
+    pointOffsets[batch + 1] = pointCount;
+}
+
+// 按精度创建数据数组
+vtkSmartPointer<vtkDataArray> PolyDataBatchBuilder::createArray(int components, vtkIdType tuples) const {
+    vtkSmartPointer<vtkDataArray> array;
+    if (singlePrecision) {
+        array = vtkSmartPointer<vtkFloatArray>::New();
+    } else {
+        array = vtkSmartPointer<vtkDoubleArray>::New();
+    }
+    array->SetNumberOfComponents(components);
+    array->SetNumberOfTuples(tuples);
+    return array;
+}
+
+// 计算偏移并分配全部数组
+void PolyDataBatchBuilder::allocate() {
+    for (size_t batch = 1; batch < pointOffsets.size(); batch++) {
+        pointOffsets[batch] += pointOffsets[batch - 1];
+    }
+    const vtkIdType pointCount = pointOffsets.back();
+
+    points = createArray(3, pointCount);
+    pointData = points->GetVoidPointer(0);
+
+    if (withNormals) {
+        normals = createArray(3, pointCount);
+        normals->SetName("Normals");
+        normalData = normals->GetVoidPointer(0);
+    }
+
+    scalars.clear();
+    scalarData.clear();
+    for (const std::string& name : scalarNames) {
+        vtkSmartPointer<vtkDataArray> array = createArray(1, pointCount);
+        array->SetName(name.c_str());
+        scalarData.push_back(array->GetVoidPointer(0));
+        scalars.push_back(array);
+    }
+
+    if (withColors) {
+        colors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+        colors->SetNumberOfComponents(3);
+        colors->SetName("Colors");
+        colors->SetNumberOfTuples(pointCount);
+        colorData = colors->GetPointer(0);
+    }
+}
+
+// 生成单元并组装PolyData
+vtkSmartPointer<vtkPolyData> PolyDataBatchBuilder::build() {
+    SPRAY_PROFILE_SCOPE("vtk.batchBuild");
+
+    const size_t batchCount = pointOffsets.size() - 1;
+    const vtkIdType pointCount = pointOffsets.back();
+
+    // 单元的offsets：折线模式每个至少2个点的批次一个单元，四边形模式每4个点一个单元
+    auto offsetArray = vtkSmartPointer<vtkIdTypeArray>::New();
+    auto connectivityArray = vtkSmartPointer<vtkIdTypeArray>::New();
+    if (cellType == PolyLines) {
+        vtkIdType cellCount = 0;
+        for (size_t batch = 0; batch < batchCount; batch++) {
+            if (batchPointCount(batch) >= 2) {
+                cellCount++;
+            }
+        }
+        offsetArray->SetNumberOfValues(cellCount + 1);
+        vtkIdType cell = 0;
+        vtkIdType connectivitySize = 0;
+        for (size_t batch = 0; batch < batchCount; batch++) {
+            const vtkIdType count = batchPointCount(batch);
+            if (count >= 2) {
+                offsetArray->SetValue(cell++, connectivitySize);
+                connectivitySize += count;
+            }
+        }
+        offsetArray->SetValue(cellCount, connectivitySize);
+
+        // 折线的点就是各批次的连续点，只需跳过不成线的批次
+        connectivityArray->SetNumberOfValues(connectivitySize);
+        vtkIdType* connectivity = connectivityArray->GetPointer(0);
+        vtkIdType position = 0;
+        for (size_t batch = 0; batch < batchCount; batch++) {
+            if (batchPointCount(batch) >= 2) {
+                for (vtkIdType id = pointOffsets[batch]; id < pointOffsets[batch + 1]; id++) {
+                    connectivity[position++] = id;
+                }
+            }
+        }
+    } else {
+        const vtkIdType cellCount = pointCount / 4;
+        offsetArray->SetNumberOfValues(cellCount + 1);
+        connectivityArray->SetNumberOfValues(cellCount * 4);
+        vtkIdType* offsets = offsetArray->GetPointer(0);
+        vtkIdType* connectivity = connectivityArray->GetPointer(0);
+        for (vtkIdType cell = 0; cell <= cellCount; cell++) {
+            offsets[cell] = cell * 4;
+        }
+        for (vtkIdType id = 0; id < cellCount * 4; id++) {
+            connectivity[id] = id;
+        }
+    }
+
+    auto cells = vtkSmartPointer<vtkCellArray>::New();
+    cells->SetData(offsetArray, connectivityArray);
+
+    auto vtkPointsObject = vtkSmartPointer<vtkPoints>::New();
+    vtkPointsObject->SetData(points);
+
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(vtkPointsObject);
+    if (cellType == PolyLines) {
+        polyData->SetLines(cells);
+    } else {
+        polyData->SetPolys(cells);
+    }
+    for (const vtkSmartPointer<vtkDataArray>& array : scalars) {
+        polyData->GetPointData()->AddArray(array);
+    }
+    if (withNormals) {
+        polyData->GetPointData()->SetNormals(normals);
+    }
+    if (withColors) {
+        polyData->GetPointData()->SetScalars(colors);
+    }
+    return polyData;
+}
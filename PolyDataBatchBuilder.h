@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkDataArray.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkType.h>
+#include <OSD_Parallel.hxx>
+#include <string>
+#include <vector>
+
+// 折线/四边形批量构造器（路径、轨迹、切割平面等可视化数据共用）
+//
+// 每个批次是一段连续的点（一条路径、一条轨迹或一个平面）。用法分三步：
+//   1. setBatchCount() 与 setBatchPointCount() 登记批次数量和各批次的点数；
+//   2. allocate() 计算偏移并一次性分配点坐标、法向量、标量、颜色和单元数组；
+//   3. 在 forEachBatch() 中按批次写入点属性（不同批次的区间互不重叠，并行执行），最后 build()。
+// 折线模式下每个至少有2个点的批次生成一个折线单元；四边形模式下每4个连续点生成一个四边形单元。
+// 单元使用offsets+connectivity布局直接写入。可选单精度输出（点坐标、法向量、标量），上传GPU的数据量减半。
+class PolyDataBatchBuilder {
+public:
+    // 单元类型
+    enum CellType {
+        PolyLines,  // 每个批次一条折线（少于2个点的批次只输出点）
+        Quads       // 每4个连续点一个四边形（批次点数应为4的倍数）
+    };
+
+    PolyDataBatchBuilder(CellType cellType, bool singlePrecision = false);
+
+    // 输出法向量数组（名称为"Normals"，设为点数据的法向量）
+    void enableNormals();
+
+    // 添加一个点标量数组，返回数组序号
+    int addScalarArray(const std::string& name);
+
+    // 输出RGB颜色数组（名称为"Colors"，设为点数据的标量，VTK直接按颜色渲染）
+    void enableColors();
+
+    // 设置批次数量（全部点数清零）
+    void setBatchCount(size_t count);
+
+    // 登记批次的点数
+    void setBatchPointCount(size_t batch, vtkIdType pointCount);
+
+    // 计算偏移并分配全部数组
+    void allocate();
+
+    // 批次的第一个点序号与点数（allocate之后有效）
+    vtkIdType batchBegin(size_t batch) const { return pointOffsets[batch]; }
+    vtkIdType batchPointCount(size_t batch) const { return pointOffsets[batch + 1] - pointOffsets[batch]; }
+
+    // 写入点属性（i为全局点序号；不同线程写入不同批次时无需同步）
+    void setPoint(vtkIdType i, double x, double y, double z) { write3(pointData, i, x, y, z); }
+    void setNormal(vtkIdType i, double x, double y, double z) { write3(normalData, i, x, y, z); }
+    void setScalar(int array, vtkIdType i, double value) {
+        if (singlePrecision) {
+            static_cast<float*>(scalarData[array])[i] = static_cast<float>(value);
+        } else {
+            static_cast<double*>(scalarData[array])[i] = value;
+        }
+    }
+    void setColor(vtkIdType i, unsigned char r, unsigned char g, unsigned char b) {
+        colorData[3 * i] = r;
+        colorData[3 * i + 1] = g;
+        colorData[3 * i + 2] = b;
+    }
+
+    // 对每个批次调用 fill(batch)（并行）
+    template <typename Function>
+    void forEachBatch(const Function& fill);
+
+    // 生成单元并组装PolyData
+    vtkSmartPointer<vtkPolyData> build();
+
+private:
+    // 按精度写入3分量数据
+    void write3(void* data, vtkIdType i, double x, double y, double z) {
+        if (singlePrecision) {
+            float* values = static_cast<float*>(data) + 3 * i;
+            values[0] = static_cast<float>(x);
+            values[1] = static_cast<float>(y);
+            values[2] = static_cast<float>(z);
+        } else {
+            double* values = static_cast<double*>(data) + 3 * i;
+            values[0] = x;
+            values[1] = y;
+            values[2] = z;
+        }
+    }
+
+    // 按精度创建数据数组
+    vtkSmartPointer<vtkDataArray> createArray(int components, vtkIdType tuples) const;
+
+    CellType cellType;                                    // 单元类型
+    bool singlePrecision;                                 // 是否单精度输出
+    bool withNormals;                                     // 是否输出法向量
+    bool withColors;                                      // 是否输出颜色
+    std::vector<std::string> scalarNames;                 // 标量数组名称
+    std::vector<vtkIdType> pointOffsets;                  // 各批次的点偏移（批次数+1项）
+
+    vtkSmartPointer<vtkDataArray> points;                 // 点坐标
+    vtkSmartPointer<vtkDataArray> normals;                // 法向量
+    std::vector<vtkSmartPointer<vtkDataArray>> scalars;   // 标量数组
+    vtkSmartPointer<vtkUnsignedCharArray> colors;         // 颜色
+    void* pointData;                                      // 点坐标的原始指针
+    void* normalData;                                     // 法向量的原始指针
+    std::vector<void*> scalarData;                        // 标量数组的原始指针
+    unsigned char* colorData;                             // 颜色的原始指针
+};
+
+// 对每个批次调用 fill(batch)（并行）
+template <typename Function>
+void PolyDataBatchBuilder::forEachBatch(const Function& fill) {
+    OSD_Parallel::For(0, static_cast<int>(pointOffsets.size() - 1),
+                      [&fill](int batch) { fill(static_cast<size_t>(batch)); });
+}
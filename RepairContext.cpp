@@ -0,0 +1,86 @@
+#include "RepairContext.h"
+#include <BRepBuilderAPI_Copy.hxx>
+
+// 构造函数：立即保存原始模型的深拷贝，之后的修复原地修改original也不影响快照
+RepairContext::RepairContext(const TopoDS_Shape& original)
+    : pristineSnapshot(deepCopy(original)), pristineShape(original), diagnosed(false), sewingTolerance(-1.0) {
+}
+
+// 深拷贝
+TopoDS_Shape RepairContext::deepCopy(const TopoDS_Shape& shape) {
+    if (shape.IsNull()) {
+        return shape;
+    }
+    BRepBuilderAPI_Copy copier(shape, Standard_True, Standard_True);
+    return copier.Shape();
+}
+
+// 当前代表原始模型的形状
+const TopoDS_Shape& RepairContext::pristine() const {
+    return pristineShape;
+}
+
+// 是否是原始模型或其缝合结果
+bool RepairContext::isTracked(const TopoDS_Shape& shape) const {
+    if (shape.IsNull()) {
+        return false;
+    }
+    return shape.IsSame(pristineShape) || (!sewedShape.IsNull() && shape.IsSame(sewedShape));
+}
+
+// 是否已诊断
+bool RepairContext::hasDiagnosis() const {
+    return diagnosed;
+}
+
+// 原始模型的诊断结果
+const RepairDiagnosis& RepairContext::diagnosis() const {
+    return pristineDiagnosis;
+}
+
+// 保存原始模型的诊断结果
+void RepairContext::setDiagnosis(const RepairDiagnosis& diagnosis) {
+    pristineDiagnosis = diagnosis;
+    diagnosed = true;
+}
+
+// 查找可复用的缝合结果（上一次使用者可能已原地修改了交出的形状，每次返回新副本）
+bool RepairContext::findSewing(double tolerance, TopoDS_Shape& sewed) {
+    if (sewedSnapshot.IsNull() || sewingTolerance != tolerance) {
+        return false;
+    }
+    sewedShape = deepCopy(sewedSnapshot);
+    sewed = sewedShape;
+    return true;
+}
+
+// 保存缝合结果：只保留最近一次
+void RepairContext::storeSewing(double tolerance, const TopoDS_Shape& sewed, const Handle(BRepTools_ReShape)& sewingHistory) {
+    if (sewed.IsNull()) {
+        return;
+    }
+    sewingTolerance = tolerance;
+    sewedSnapshot = deepCopy(sewed);
+    sewedShape = sewed;
+    history = sewingHistory;
+}
+
+// 缝合历史
+const Handle(BRepTools_ReShape)& RepairContext::sewingHistory() const {
+    return history;
+}
+
+// 原始模型的新副本
+TopoDS_Shape RepairContext::restartShape() {
+    pristineShape = deepCopy(pristineSnapshot);
+    return pristineShape;
+}
+
+// 修复全部失败时使用的模型
+TopoDS_Shape RepairContext::resumeShape() {
+    if (sewedSnapshot.IsNull()) {
+        return restartShape();
+    }
+    sewedShape = deepCopy(sewedSnapshot);
+    return sewedShape;
+}
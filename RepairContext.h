@@ -0,0 +1,59 @@
+#pragma once
+
+#include <TopoDS_Shape.hxx>
+#include <BRepTools_ReShape.hxx>
+#include "OCCHandler.h"
+
+// 修复后备链共享的上下文
+//
+// loadStepFile 依次尝试计划修复、增强修复、基础修复。没有上下文时，每个后备修复都从上一步修改过的模型
+// 重新开始，并重复自己的有效性检查和对全部面的缝合。上下文保存：
+//   - 原始模型的深拷贝（ShapeFix、LimitTolerance等会原地修改TShape，快照本身从不交给修复流程，
+//     后备修复和修复全部失败时都从它的新副本开始）；
+//   - 对原始模型的诊断结果（后备修复不再重复BRepCheck和自由边界分析）；
+//   - 缝合结果的深拷贝与缝合历史（BRepTools_ReShape，将原始子形状映射到缝合时得到的子形状）。
+// 按相同容差缝合过时，后备修复从缝合结果的副本继续，只执行各自不同的形状修复步骤。
+class RepairContext {
+public:
+    explicit RepairContext(const TopoDS_Shape& original);
+
+    // 当前代表原始模型的形状（构造时传入的模型，或restartShape()最近返回的副本）
+    const TopoDS_Shape& pristine() const;
+
+    // 是否是原始模型或其缝合结果（只有这时上下文中的记录才适用于当前模型）
+    bool isTracked(const TopoDS_Shape& shape) const;
+
+    // 对原始模型的诊断结果
+    bool hasDiagnosis() const;
+    const RepairDiagnosis& diagnosis() const;
+    void setDiagnosis(const RepairDiagnosis& diagnosis);
+
+    // 查找可复用的缝合结果：已按相同容差缝合过原始模型时返回缝合结果的新副本
+    // （较粗容差的结果不复用，后备修复以更小容差重新缝合正是为了得到不同的结果）
+    bool findSewing(double tolerance, TopoDS_Shape& sewed);
+
+    // 保存对原始模型的缝合结果（保存深拷贝）与缝合历史
+    void storeSewing(double tolerance, const TopoDS_Shape& sewed, const Handle(BRepTools_ReShape)& history);
+
+    // 缝合历史（未缝合或空间分区缝合时为空；映射到缝合时的结果，而不是之后返回的副本）
+    const Handle(BRepTools_ReShape)& sewingHistory() const;
+
+    // 原始模型的新副本，后备修复从这里重新开始
+    TopoDS_Shape restartShape();
+
+    // 修复全部失败时使用的模型：有缝合结果时为缝合结果的新副本，否则为原始模型的新副本
+    TopoDS_Shape resumeShape();
+
+private:
+    // 深拷贝（拓扑与几何）
+    static TopoDS_Shape deepCopy(const TopoDS_Shape& shape);
+
+    TopoDS_Shape pristineSnapshot;           // 原始模型的深拷贝（不交给修复流程）
+    TopoDS_Shape pristineShape;              // 当前代表原始模型的形状
+    bool diagnosed;                          // 是否已诊断
+    RepairDiagnosis pristineDiagnosis;       // 原始模型的诊断结果
+    double sewingTolerance;                  // 缝合容差（未缝合时为负）
+    TopoDS_Shape sewedSnapshot;              // 缝合结果的深拷贝
+    TopoDS_Shape sewedShape;                 // 当前代表缝合结果的形状
+    Handle(BRepTools_ReShape) history;       // 缝合历史
+};
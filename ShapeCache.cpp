@@ -0,0 +1,167 @@
+#include "ShapeCache.h"
+#include "SprayLog.h"
+#include <BinTools.hxx>
+#include <BinTools_FormatVersion.hxx>
+#include <Standard_Failure.hxx>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// FNV-1a 64位参数
+static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+// 哈希时每次读取的块大小
+static const size_t HASH_CHUNK_SIZE = 1 << 20;
+
+// 缓存文件格式版本（修改缓存内容的组织方式时递增，使旧文件失效）
+static const char* SHAPE_CACHE_FORMAT = "v1";
+
+// 对一段数据继续计算FNV-1a
+static uint64_t fnv1a(uint64_t hash, const unsigned char* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+// 64位整数转16进制字符串
+static std::string toHex(uint64_t value) {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+    return buffer;
+}
+
+// 构造函数
+ShapeCache::ShapeCache() {
+}
+
+// 设置缓存目录
+void ShapeCache::setDirectory(const std::string& newDirectory) {
+    std::lock_guard<std::mutex> lock(mutex);
+    directory = newDirectory;
+}
+
+// 获取缓存目录
+std::string ShapeCache::getDirectory() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return directory;
+}
+
+// 是否启用
+bool ShapeCache::isEnabled() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !directory.empty();
+}
+
+// 计算文件内容的FNV-1a 64位哈希
+bool ShapeCache::hashFile(const std::string& filename, uint64_t& hash, uint64_t& size) {
+    std::ifstream input(fs::u8path(filename), std::ios::binary);
+    if (!input) {
+        return false;
+    }
+
+    std::vector<unsigned char> buffer(HASH_CHUNK_SIZE);
+    hash = FNV_OFFSET_BASIS;
+    size = 0;
+    while (input) {
+        input.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        std::streamsize count = input.gcount();
+        if (count <= 0) break;
+        hash = fnv1a(hash, buffer.data(), static_cast<size_t>(count));
+        size += static_cast<uint64_t>(count);
+    }
+    return !input.bad();
+}
+
+// 计算缓存键：内容哈希 + 大小 + 参数标签哈希
+bool ShapeCache::makeKey(const std::string& filename, const std::string& paramsTag, std::string& key) const {
+    uint64_t contentHash = 0;
+    uint64_t size = 0;
+    if (!hashFile(filename, contentHash, size)) {
+        return false;
+    }
+
+    std::string tag = std::string(SHAPE_CACHE_FORMAT) + "|" + paramsTag;
+    uint64_t tagHash = fnv1a(FNV_OFFSET_BASIS, reinterpret_cast<const unsigned char*>(tag.data()), tag.size());
+    key = toHex(contentHash) + "_" + toHex(size) + "_" + toHex(tagHash);
+    return true;
+}
+
+// 缓存键对应的文件路径
+std::string ShapeCache::entryPath(const std::string& key) const {
+    return (fs::u8path(getDirectory()) / (key + ".brep")).u8string();
+}
+
+// 读取缓存的形状
+bool ShapeCache::load(const std::string& key, TopoDS_Shape& shape, const Message_ProgressRange& range) const {
+    if (!isEnabled()) {
+        return false;
+    }
+
+    std::string path = entryPath(key);
+    std::error_code ec;
+    if (!fs::exists(fs::u8path(path), ec)) {
+        return false;
+    }
+
+    try {
+        TopoDS_Shape cachedShape;
+        if (!BinTools::Read(cachedShape, path.c_str(), range) || cachedShape.IsNull()) {
+            SPRAY_LOG_WARN << "⚠️ BREP缓存文件无法读取，将重新加载: " << path;
+            return false;
+        }
+        shape = cachedShape;
+        return true;
+    } catch (const Standard_Failure& e) {
+        SPRAY_LOG_WARN << "⚠️ BREP缓存文件损坏，将重新加载: " << path << " (" << e.GetMessageString() << ")";
+        return false;
+    } catch (...) {
+        SPRAY_LOG_WARN << "⚠️ BREP缓存文件损坏，将重新加载: " << path;
+        return false;
+    }
+}
+
+// 保存形状：先写临时文件再重命名，避免其他进程读到写了一半的文件
+bool ShapeCache::store(const std::string& key, const TopoDS_Shape& shape, const Message_ProgressRange& range) const {
+    if (!isEnabled() || shape.IsNull()) {
+        return false;
+    }
+
+    std::error_code ec;
+    fs::create_directories(fs::u8path(getDirectory()), ec);
+    if (ec) {
+        SPRAY_LOG_WARN << "⚠️ 无法创建BREP缓存目录: " << getDirectory() << " (" << ec.message() << ")";
+        return false;
+    }
+
+    std::string path = entryPath(key);
+    size_t writer = std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+                    static_cast<size_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    std::string tempPath = path + ".tmp" + toHex(writer);
+
+    bool written = false;
+    try {
+        written = BinTools::Write(shape, tempPath.c_str(), Standard_True, Standard_False,
+                                  BinTools_FormatVersion_CURRENT, range);
+    } catch (...) {
+        written = false;
+    }
+
+    if (written) {
+        fs::rename(fs::u8path(tempPath), fs::u8path(path), ec);
+        written = !ec;
+    }
+    if (!written) {
+        fs::remove(fs::u8path(tempPath), ec);
+        SPRAY_LOG_WARN << "⚠️ 写入BREP缓存失败: " << path;
+    }
+    return written;
+}
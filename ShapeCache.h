@@ -0,0 +1,45 @@
+#pragma once
+
+#include <TopoDS_Shape.hxx>
+#include <Message_ProgressRange.hxx>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// 已加载并修复的模型的磁盘缓存（OCCT二进制BREP格式，包含三角剖分）
+//
+// 缓存键 = STEP文件内容哈希（FNV-1a 64位）+ 文件大小 + 调用方给出的参数标签（修复参数、剖分精度等），
+// 文件改动或参数变化都会得到新的键。缓存目录为空时不启用。
+// 多个进程/线程可以共享同一目录：写入先写临时文件再重命名，读到不完整的文件时按未命中处理。
+class ShapeCache {
+public:
+    ShapeCache();
+
+    // 设置缓存目录（为空时关闭缓存）
+    void setDirectory(const std::string& directory);
+    std::string getDirectory() const;
+
+    // 是否启用
+    bool isEnabled() const;
+
+    // 计算缓存键，文件无法读取时返回false
+    bool makeKey(const std::string& filename, const std::string& paramsTag, std::string& key) const;
+
+    // 读取缓存的形状，未命中或读取失败时返回false
+    bool load(const std::string& key, TopoDS_Shape& shape,
+              const Message_ProgressRange& range = Message_ProgressRange()) const;
+
+    // 保存形状（连同已有的三角剖分），返回是否成功
+    bool store(const std::string& key, const TopoDS_Shape& shape,
+               const Message_ProgressRange& range = Message_ProgressRange()) const;
+
+    // 计算文件内容的FNV-1a 64位哈希
+    static bool hashFile(const std::string& filename, uint64_t& hash, uint64_t& size);
+
+private:
+    // 缓存键对应的文件路径
+    std::string entryPath(const std::string& key) const;
+
+    mutable std::mutex mutex;  // 保护目录设置
+    std::string directory;     // 缓存目录
+};
@@ -0,0 +1,150 @@
+#include "SprayLog.h"
+#include <iostream>
+
+std::atomic<int> SprayLog::runtimeLevel(static_cast<int>(SprayLogLevel::Info));
+
+// 全局单例
+SprayLog& SprayLog::instance() {
+    static SprayLog log;
+    return log;
+}
+
+// 构造函数：启动后台写出线程
+SprayLog::SprayLog() : stopping(false), writing(false), async(true), consoleOutput(true) {
+    worker = std::thread(&SprayLog::workerLoop, this);
+}
+
+// 析构函数：写出剩余日志后结束后台线程
+SprayLog::~SprayLog() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCondition.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+// 设置运行时日志级别
+void SprayLog::setLevel(SprayLogLevel level) {
+    runtimeLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+// 获取运行时日志级别
+SprayLogLevel SprayLog::getLevel() {
+    return static_cast<SprayLogLevel>(runtimeLevel.load(std::memory_order_relaxed));
+}
+
+// 设置是否异步输出
+void SprayLog::setAsync(bool enabled) {
+    if (!enabled) {
+        flush();
+    }
+    std::lock_guard<std::mutex> lock(queueMutex);
+    async = enabled;
+}
+
+// 设置是否输出到控制台
+void SprayLog::setConsoleOutput(bool enabled) {
+    flush();
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    consoleOutput = enabled;
+}
+
+// 设置日志文件
+bool SprayLog::setLogFile(const std::string& filename) {
+    flush();
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    if (logFile.is_open()) {
+        logFile.close();
+    }
+    if (filename.empty()) {
+        return true;
+    }
+    logFile.open(filename, std::ios::out | std::ios::app);
+    return logFile.is_open();
+}
+
+// 写入一行日志
+void SprayLog::write(SprayLogLevel level, std::string&& line) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (async && !stopping) {
+            queue.emplace_back(level, std::move(line));
+            queueCondition.notify_one();
+            return;
+        }
+    }
+
+    // 同步模式（或退出过程中）：直接写出
+    LineBatch batch;
+    batch.emplace_back(level, std::move(line));
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    writeBatch(batch);
+}
+
+// 等待队列写空并刷新输出
+void SprayLog::flush() {
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        drainedCondition.wait(lock, [this]() { return (queue.empty() && !writing) || stopping; });
+    }
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    if (consoleOutput) {
+        std::cout.flush();
+        std::cerr.flush();
+    }
+    if (logFile.is_open()) {
+        logFile.flush();
+    }
+}
+
+// 后台写出线程：每次取走整个队列，写完后只刷新一次
+void SprayLog::workerLoop() {
+    LineBatch batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]() { return !queue.empty() || stopping; });
+            if (queue.empty() && stopping) {
+                break;
+            }
+            batch.swap(queue);
+            writing = true;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(sinkMutex);
+            writeBatch(batch);
+            if (consoleOutput) {
+                std::cout.flush();
+                std::cerr.flush();
+            }
+            if (logFile.is_open()) {
+                logFile.flush();
+            }
+        }
+        batch.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            writing = false;
+        }
+        drainedCondition.notify_all();
+    }
+    drainedCondition.notify_all();
+}
+
+// 写出一批日志
+void SprayLog::writeBatch(const LineBatch& batch) {
+    for (const auto& entry : batch) {
+        if (consoleOutput) {
+            std::ostream& out = entry.first >= SprayLogLevel::Warn ? std::cerr : std::cout;
+            out << entry.second << '\n';
+        }
+        if (logFile.is_open()) {
+            logFile << entry.second << '\n';
+        }
+    }
+}
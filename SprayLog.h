@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 日志级别
+enum class SprayLogLevel {
+    Trace = 0,  // 逐元素的跟踪信息
+    Debug = 1,  // 调试信息（循环内的逐项输出）
+    Info = 2,   // 阶段进度
+    Warn = 3,   // 警告
+    Error = 4,  // 错误
+    Off = 5     // 关闭
+};
+
+// 编译期最低日志级别：低于该级别的日志语句整体被编译器移除（例如 -DSPRAYR_LOG_MIN_LEVEL=2 去掉Trace/Debug）
+#ifndef SPRAYR_LOG_MIN_LEVEL
+#define SPRAYR_LOG_MIN_LEVEL 0
+#endif
+
+// 日志系统（全局单例，线程安全）
+//
+// 日志行先写入内存队列，由后台线程批量写到控制台/文件，每批只刷新一次，
+// 调用方不会在热点循环中阻塞在控制台I/O上。Warn及以上输出到stderr，其余输出到stdout。
+//
+// 用法：
+//   SPRAY_LOG_INFO << "生成了 " << count << " 条路径";        // 不需要std::endl
+//   SPRAY_LOG_FIRST_N(SprayLogLevel::Debug, 5) << "...";     // 每个调用点只输出前5次
+//   SPRAY_LOG_EVERY_N(SprayLogLevel::Debug, 100) << "...";   // 每个调用点每100次输出1次
+class SprayLog {
+public:
+    static SprayLog& instance();
+
+    // 运行时日志级别（默认Info）
+    static void setLevel(SprayLogLevel level);
+    static SprayLogLevel getLevel();
+
+    // 指定级别当前是否输出
+    static bool isEnabled(SprayLogLevel level) {
+        return static_cast<int>(level) >= runtimeLevel.load(std::memory_order_relaxed);
+    }
+
+    // 是否异步输出（默认开启；关闭后在调用线程中直接写出，仍不逐行刷新）
+    void setAsync(bool enabled);
+
+    // 是否输出到控制台（默认开启）
+    void setConsoleOutput(bool enabled);
+
+    // 额外输出到日志文件（文件名为空时关闭文件输出），返回是否成功打开
+    bool setLogFile(const std::string& filename);
+
+    // 写入一行日志
+    void write(SprayLogLevel level, std::string&& line);
+
+    // 等待队列中的日志全部写出并刷新
+    void flush();
+
+    ~SprayLog();
+
+private:
+    SprayLog();
+    SprayLog(const SprayLog&) = delete;
+    SprayLog& operator=(const SprayLog&) = delete;
+
+    typedef std::vector<std::pair<SprayLogLevel, std::string>> LineBatch;
+
+    // 后台写出线程
+    void workerLoop();
+
+    // 写出一批日志（调用时持有sinkMutex）
+    void writeBatch(const LineBatch& batch);
+
+    static std::atomic<int> runtimeLevel;
+
+    std::mutex queueMutex;               // 保护队列与状态
+    std::condition_variable queueCondition;  // 有新日志或需要退出
+    std::condition_variable drainedCondition; // 队列已写空
+    LineBatch queue;                     // 待写出的日志
+    bool stopping;                       // 正在退出
+    bool writing;                        // 后台线程正在写出一批
+    bool async;                          // 是否异步
+    std::thread worker;                  // 后台写出线程
+
+    std::mutex sinkMutex;                // 保护输出目标
+    bool consoleOutput;                  // 是否输出到控制台
+    std::ofstream logFile;               // 日志文件
+};
+
+// 单条日志：析构时把整行交给日志系统
+class SprayLogMessage {
+public:
+    explicit SprayLogMessage(SprayLogLevel level) : level(level) {}
+    ~SprayLogMessage() { SprayLog::instance().write(level, buffer.str()); }
+
+    std::ostream& stream() { return buffer; }
+
+private:
+    SprayLogLevel level;
+    std::ostringstream buffer;
+};
+
+#define SPRAY_LOG_IS_ON(level) \
+    (static_cast<int>(level) >= SPRAYR_LOG_MIN_LEVEL && SprayLog::isEnabled(level))
+
+// 按级别输出日志；级别未开启时右侧表达式不会求值
+#define SPRAY_LOG(level) \
+    if (!SPRAY_LOG_IS_ON(level)) {} else SprayLogMessage(level).stream()
+
+#define SPRAY_LOG_TRACE SPRAY_LOG(SprayLogLevel::Trace)
+#define SPRAY_LOG_DEBUG SPRAY_LOG(SprayLogLevel::Debug)
+#define SPRAY_LOG_INFO  SPRAY_LOG(SprayLogLevel::Info)
+#define SPRAY_LOG_WARN  SPRAY_LOG(SprayLogLevel::Warn)
+#define SPRAY_LOG_ERROR SPRAY_LOG(SprayLogLevel::Error)
+
+// 调用点计数：每个宏展开处的lambda类型不同，各自拥有独立的原子计数器
+#define SPRAY_LOG_SITE_COUNT() \
+    ([]() { static std::atomic<long long> sprayLogSiteCount(0); \
+            return sprayLogSiteCount.fetch_add(1, std::memory_order_relaxed); }())
+
+// 每个调用点只输出前n次
+#define SPRAY_LOG_FIRST_N(level, n) \
+    if (!(SPRAY_LOG_IS_ON(level) && SPRAY_LOG_SITE_COUNT() < (n))) {} else SprayLogMessage(level).stream()
+
+// 每个调用点每n次输出1次（第1、n+1、2n+1...次）
+#define SPRAY_LOG_EVERY_N(level, n) \
+    if (!(SPRAY_LOG_IS_ON(level) && SPRAY_LOG_SITE_COUNT() % (n) == 0)) {} else SprayLogMessage(level).stream()
@@ -0,0 +1,451 @@
+#include "SprayPipeline.h"
+#include "SprayLog.h"
+#include "SprayProfiler.h"
+#include <Message_ProgressScope.hxx>
+#include <TopExp_Explorer.hxx>
+#include <gp.hxx>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+// 去除字符串首尾空白
+static std::string trimString(const std::string& text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) begin++;
+    while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) end--;
+    return text.substr(begin, end - begin);
+}
+
+// 解析浮点数
+static bool parseDouble(const std::string& text, double& value) {
+    std::string trimmed = trimString(text);
+    if (trimmed.empty()) return false;
+    char* end = nullptr;
+    value = std::strtod(trimmed.c_str(), &end);
+    return end != nullptr && *end == '\0';
+}
+
+// 解析布尔值（true/false、1/0、yes/no、on/off）
+static bool parseBool(const std::string& text, bool& value) {
+    std::string lower = trimString(text);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "true" || lower == "1" || lower == "yes" || lower == "on") {
+        value = true;
+        return true;
+    }
+    if (lower == "false" || lower == "0" || lower == "no" || lower == "off") {
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+// 设置单个参数
+bool setSprayPipelineParam(SprayPipelineParams& params, const std::string& key,
+                           const std::string& value, std::string& error) {
+    double number = 0.0;
+    bool flag = false;
+
+    if (key == "direction") {
+        // 方向格式：x,y,z
+        std::stringstream stream(value);
+        std::string component;
+        double xyz[3] = { 0.0, 0.0, 0.0 };
+        int count = 0;
+        while (std::getline(stream, component, ',')) {
+            if (count >= 3 || !parseDouble(component, xyz[count])) {
+                error = "方向格式应为 x,y,z: " + value;
+                return false;
+            }
+            count++;
+        }
+        if (count != 3) {
+            error = "方向格式应为 x,y,z: " + value;
+            return false;
+        }
+        double length = std::sqrt(xyz[0] * xyz[0] + xyz[1] * xyz[1] + xyz[2] * xyz[2]);
+        if (length < gp::Resolution()) {
+            error = "方向格式应为非零向量 x,y,z: " + value;
+            return false;
+        }
+        params.sprayDirection = gp_Dir(xyz[0], xyz[1], xyz[2]);
+        return true;
+    }
+
+    if (key == "move-to-origin" || key == "auto-repair" || key == "visibility" || key == "parallel" ||
+        key == "parallel-import" || key == "partitioned-repair" || key == "spatial-sewing") {
+        if (!parseBool(value, flag)) {
+            error = "参数 " + key + " 需要布尔值: " + value;
+            return false;
+        }
+        if (key == "move-to-origin") params.moveToOrigin = flag;
+        else if (key == "auto-repair") params.autoRepair = flag;
+        else if (key == "visibility") params.analyzeVisibility = flag;
+        else if (key == "parallel-import") params.parallelImport = flag;
+        else if (key == "partitioned-repair") params.partitionedRepair = flag;
+        else if (key == "spatial-sewing") params.spatialSewing = flag;
+        else params.parallelMode = flag;
+        return true;
+    }
+
+    if (key == "angle-tolerance" || key == "height-tolerance" || key == "path-spacing" ||
+        key == "offset" || key == "point-density") {
+        if (!parseDouble(value, number)) {
+            error = "参数 " + key + " 需要数值: " + value;
+            return false;
+        }
+        if (key != "offset" && number <= 0.0) {
+            error = "参数 " + key + " 必须大于0: " + value;
+            return false;
+        }
+        if (key == "angle-tolerance") params.angleTolerance = number;
+        else if (key == "height-tolerance") params.heightTolerance = number;
+        else if (key == "path-spacing") params.pathSpacing = number;
+        else if (key == "offset") params.offsetDistance = number;
+        else params.pointDensity = number;
+        return true;
+    }
+
+    if (key == "products") {
+        // 根实体序号列表：1,3,5（为空表示全部）
+        std::vector<int> indices;
+        std::stringstream stream(value);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            double index = 0.0;
+            if (trimString(item).empty()) continue;
+            if (!parseDouble(item, index) || index < 1.0 || index != std::floor(index)) {
+                error = "根实体序号应为正整数列表 1,3,5: " + value;
+                return false;
+            }
+            indices.push_back(static_cast<int>(index));
+        }
+        params.loadSelection.rootIndices = indices;
+        return true;
+    }
+
+    if (key == "region") {
+        // 关注区域格式：xmin,ymin,zmin,xmax,ymax,zmax（为空表示不筛选）
+        if (trimString(value).empty()) {
+            params.loadSelection.useRegion = false;
+            params.loadSelection.region.SetVoid();
+            return true;
+        }
+        std::stringstream stream(value);
+        std::string component;
+        double bounds[6];
+        int count = 0;
+        while (std::getline(stream, component, ',')) {
+            if (count >= 6 || !parseDouble(component, bounds[count])) {
+                error = "区域格式应为 xmin,ymin,zmin,xmax,ymax,zmax: " + value;
+                return false;
+            }
+            count++;
+        }
+        if (count != 6 || bounds[0] > bounds[3] || bounds[1] > bounds[4] || bounds[2] > bounds[5]) {
+            error = "区域格式应为 xmin,ymin,zmin,xmax,ymax,zmax: " + value;
+            return false;
+        }
+        params.loadSelection.useRegion = true;
+        params.loadSelection.region.SetVoid();
+        params.loadSelection.region.Update(bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5]);
+        return true;
+    }
+
+    if (key == "shape-cache") {
+        params.shapeCacheDir = value;
+        return true;
+    }
+
+    error = "未知参数: " + key;
+    return false;
+}
+
+// 从配置文件读取参数
+bool loadSprayPipelineConfig(SprayPipelineParams& params, const std::string& filename, std::string& error) {
+    std::ifstream file(filename);
+    if (!file) {
+        error = "无法打开配置文件: " + filename;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        std::string content = trimString(line.substr(0, line.find('#')));
+        if (content.empty()) continue;
+
+        size_t separator = content.find('=');
+        if (separator == std::string::npos) {
+            error = filename + ":" + std::to_string(lineNumber) + " 缺少 '='";
+            return false;
+        }
+
+        std::string key = trimString(content.substr(0, separator));
+        std::string value = trimString(content.substr(separator + 1));
+        std::string paramError;
+        if (!setSprayPipelineParam(params, key, value, paramError)) {
+            error = filename + ":" + std::to_string(lineNumber) + " " + paramError;
+            return false;
+        }
+    }
+    return true;
+}
+
+// 构造函数
+SprayPipeline::SprayPipeline(const SprayPipelineParams& params) : params(params) {
+    handler.setParallelMode(params.parallelMode);
+    handler.setParallelImport(params.parallelImport);
+    handler.setPartitionedRepair(params.partitionedRepair);
+    handler.setSpatialSewing(params.spatialSewing);
+    handler.setShapeCacheDirectory(params.shapeCacheDir);
+}
+
+// 析构函数
+SprayPipeline::~SprayPipeline() {
+}
+
+// 设置流程参数
+void SprayPipeline::setParams(const SprayPipelineParams& newParams) {
+    params = newParams;
+    handler.setParallelMode(params.parallelMode);
+    handler.setParallelImport(params.parallelImport);
+    handler.setPartitionedRepair(params.partitionedRepair);
+    handler.setSpatialSewing(params.spatialSewing);
+    handler.setShapeCacheDirectory(params.shapeCacheDir);
+}
+
+// 获取流程参数
+const SprayPipelineParams& SprayPipeline::getParams() const {
+    return params;
+}
+
+// 加载STEP文件
+bool SprayPipeline::loadModel(const std::string& filename, const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("stage.load");
+
+    result = SprayPipelineResult();
+    result.inputFile = filename;
+    extractedFaces.Nullify();
+    processedFaces.Nullify();
+    processor.reset();
+
+    if (!handler.loadStepSelection(filename, params.loadSelection, params.moveToOrigin, params.autoRepair, range)) {
+        if (range.UserBreak()) return markCancelled("load");
+        result.failedStage = "load";
+        return false;
+    }
+    return true;
+}
+
+// 按喷涂方向提取面
+bool SprayPipeline::extractFaces(const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("stage.extract");
+
+    SPRAY_LOG_INFO << "🔍 基于法向量提取面...";
+    extractedFaces = handler.extractFacesByNormal(params.sprayDirection, params.angleTolerance, true, range);
+    processedFaces.Nullify();
+    processor.reset();
+
+    if (range.UserBreak()) {
+        extractedFaces.Nullify();
+        return markCancelled("extract");
+    }
+
+    result.extractedFaceCount = countFaces(extractedFaces);
+    if (extractedFaces.IsNull() || result.extractedFaceCount == 0) {
+        result.failedStage = "extract";
+        return false;
+    }
+    return true;
+}
+
+// 遮挡裁剪
+bool SprayPipeline::removeOcclusion(const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("stage.occlusion");
+
+    if (extractedFaces.IsNull()) {
+        SPRAY_LOG_WARN << "⚠️ 尚未提取面，无法进行遮挡裁剪";
+        result.failedStage = "occlusion";
+        return false;
+    }
+
+    SPRAY_LOG_INFO << "🔗 自动进行遮挡裁剪...";
+    processedFaces = handler.removeOccludedPortions(extractedFaces, params.heightTolerance, range);
+    processor.reset();
+
+    if (range.UserBreak()) {
+        processedFaces.Nullify();
+        return markCancelled("occlusion");
+    }
+
+    if (processedFaces.IsNull()) {
+        // 如果裁剪失败，使用原始提取的面
+        SPRAY_LOG_WARN << "⚠️ 遮挡裁剪失败，使用原始提取的面";
+        processedFaces = extractedFaces;
+    }
+
+    result.processedFaceCount = countFaces(processedFaces);
+    return true;
+}
+
+// 生成切割平面
+bool SprayPipeline::generateCuttingPlanes() {
+    SPRAY_PROFILE_SCOPE("stage.planes");
+
+    if (processedFaces.IsNull()) {
+        SPRAY_LOG_WARN << "⚠️ 尚未完成面提取，无法生成切割平面";
+        result.failedStage = "planes";
+        return false;
+    }
+
+    processor.reset(new FaceProcessor());
+    processor->setFaceNormalService(handler.getFaceNormalService());
+    processor->setShape(processedFaces);
+    processor->setCuttingParameters(params.sprayDirection, params.pathSpacing,
+                                    params.offsetDistance, params.pointDensity);
+
+    SPRAY_LOG_INFO << "开始生成切割平面...";
+    if (!processor->generateCuttingPlanes()) {
+        result.failedStage = "planes";
+        return false;
+    }
+    return true;
+}
+
+// 生成路径
+bool SprayPipeline::generatePaths(const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("stage.paths");
+
+    if (!processor) {
+        result.failedStage = "paths";
+        return false;
+    }
+
+    SPRAY_LOG_INFO << "开始为可见面生成路径...";
+    if (!processor->generatePaths(range)) {
+        if (range.UserBreak()) return markCancelled("paths");
+        result.failedStage = "paths";
+        return false;
+    }
+
+    result.pathCount = static_cast<int>(processor->getPaths().size());
+    SPRAY_LOG_INFO << "成功生成 " << result.pathCount << " 条路径";
+    return true;
+}
+
+// 整合轨迹
+bool SprayPipeline::integrateTrajectories(const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("stage.integrate");
+
+    if (!processor) {
+        result.failedStage = "integrate";
+        return false;
+    }
+
+    SPRAY_LOG_INFO << "开始整合轨迹...";
+    if (!processor->integrateTrajectories()) {
+        result.failedStage = "integrate";
+        return false;
+    }
+
+    if (params.analyzeVisibility) {
+        SPRAY_LOG_INFO << "开始路径级别的可见性分析...";
+        if (!processor->analyzePathVisibility(range)) {
+            if (range.UserBreak()) return markCancelled("integrate");
+            SPRAY_LOG_INFO << "跳过路径级别的可见性分析，直接使用面级别的可见性结果";
+        }
+    }
+
+    const std::vector<IntegratedTrajectory>& trajectories = processor->getIntegratedTrajectories();
+    result.trajectoryCount = static_cast<int>(trajectories.size());
+    result.trajectoryLength = 0.0;
+    for (const IntegratedTrajectory& trajectory : trajectories) {
+        result.trajectoryLength += trajectory.totalLength;
+    }
+    SPRAY_LOG_INFO << "成功整合为 " << result.trajectoryCount << " 条连续轨迹";
+    return true;
+}
+
+// 执行完整流程
+SprayPipelineResult SprayPipeline::run(const std::string& filename, const Message_ProgressRange& range) {
+    SPRAY_PROFILE_SCOPE("stage.run");
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    // 进度权重按各阶段的典型耗时分配
+    Message_ProgressScope scope(range, "喷涂流程", 12);
+
+    try {
+        bool success = loadModel(filename, scope.Next(3)) &&
+                       extractFaces(scope.Next()) &&
+                       removeOcclusion(scope.Next(5)) &&
+                       generateCuttingPlanes() &&
+                       generatePaths(scope.Next(2)) &&
+                       integrateTrajectories(scope.Next());
+        result.success = success;
+    } catch (const std::exception& e) {
+        SPRAY_LOG_ERROR << "❌ 处理 " << filename << " 时发生异常: " << e.what();
+        result.success = false;
+    } catch (...) {
+        SPRAY_LOG_ERROR << "❌ 处理 " << filename << " 时发生未知异常";
+        result.success = false;
+    }
+
+    if (!result.success && result.failedStage.empty()) {
+        result.failedStage = "exception";
+    }
+
+    result.inputFile = filename;
+    result.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return result;
+}
+
+// 模型处理器
+OCCHandler& SprayPipeline::getHandler() {
+    return handler;
+}
+
+const OCCHandler& SprayPipeline::getHandler() const {
+    return handler;
+}
+
+// 路径处理器
+FaceProcessor* SprayPipeline::getProcessor() const {
+    return processor.get();
+}
+
+// 提取并遮挡裁剪后的面
+const TopoDS_Shape& SprayPipeline::getProcessedFaces() const {
+    return processedFaces;
+}
+
+// 最近一次处理的结果统计
+const SprayPipelineResult& SprayPipeline::getResult() const {
+    return result;
+}
+
+// 统计形状中的面数量
+int SprayPipeline::countFaces(const TopoDS_Shape& shape) {
+    int count = 0;
+    if (shape.IsNull()) return 0;
+    for (TopExp_Explorer explorer(shape, TopAbs_FACE); explorer.More(); explorer.Next()) {
+        count++;
+    }
+    return count;
+}
+
+// 记录阶段被取消
+bool SprayPipeline::markCancelled(const char* stage) {
+    SPRAY_LOG_INFO << "⏹️ 流程已在阶段 " << stage << " 取消";
+    result.failedStage = stage;
+    result.cancelled = true;
+    return false;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <TopoDS_Shape.hxx>
+#include <gp_Dir.hxx>
+#include <Message_ProgressRange.hxx>
+#include "OCCHandler.h"
+#include "FaceProcessor.h"
+
+// 喷涂流程参数（默认值与界面中使用的参数一致）
+struct SprayPipelineParams {
+    bool moveToOrigin = true;              // 加载后移动到原点
+    bool autoRepair = true;                // 加载后自动修复
+    gp_Dir sprayDirection = gp_Dir(0, 0, 1); // 喷涂方向（提取面与切割方向）
+    double angleTolerance = 5.0;           // 面法向量与喷涂方向的最大夹角（度）
+    double heightTolerance = 1.0;          // 遮挡裁剪的分层高度容差
+    double pathSpacing = 200.0;            // 路径间距
+    double offsetDistance = 300.0;         // 路径偏移距离
+    double pointDensity = 0.2;             // 路径点密度
+    bool analyzeVisibility = true;         // 是否进行路径级别可见性分析
+    bool parallelMode = true;              // 是否启用遮挡裁剪的并行处理
+    bool parallelImport = false;           // 是否并行转换STEP根实体（装配体）
+    bool partitionedRepair = false;        // 是否分区并行修复（多实体装配体）
+    bool spatialSewing = false;            // 是否空间分区缝合（大面数模型）
+    std::string shapeCacheDir;             // BREP缓存目录（为空时不缓存修复后的模型）
+    StepLoadSelection loadSelection;       // 选择性加载：只加载指定根实体或关注区域内的部分（默认全部）
+};
+
+// 设置单个参数（键名与命令行长选项相同，如 "path-spacing"），失败时返回false并给出原因
+bool setSprayPipelineParam(SprayPipelineParams& params, const std::string& key,
+                           const std::string& value, std::string& error);
+
+// 从配置文件读取参数（每行 "键 = 值"，#开头为注释）
+bool loadSprayPipelineConfig(SprayPipelineParams& params, const std::string& filename, std::string& error);
+
+// 单个零件的处理结果
+struct SprayPipelineResult {
+    std::string inputFile;          // 输入文件
+    bool success = false;           // 是否完成全部流程
+    std::string failedStage;        // 失败的阶段（成功时为空）
+    bool cancelled = false;         // 是否因取消而中止（failedStage为取消时所在的阶段）
+    int extractedFaceCount = 0;     // 提取的面数量
+    int processedFaceCount = 0;     // 遮挡裁剪后的面数量
+    int pathCount = 0;              // 生成的路径数量
+    int trajectoryCount = 0;        // 整合后的轨迹数量
+    double trajectoryLength = 0.0;  // 轨迹总长度
+    double elapsedSeconds = 0.0;    // 处理耗时（秒）
+};
+
+// 喷涂轨迹生成流程：加载 → 修复 → 提取面 → 遮挡裁剪 → 切割平面 → 路径 → 轨迹整合
+// 不依赖Qt和VTK渲染，界面与命令行共用
+// 各阶段可传入进度范围（见 SprayProgressIndicator），用于报告进度和协作式取消；
+// 阶段被取消时返回false，并在结果中标记cancelled
+class SprayPipeline {
+public:
+    explicit SprayPipeline(const SprayPipelineParams& params = SprayPipelineParams());
+    ~SprayPipeline();
+
+    // 设置/获取流程参数
+    void setParams(const SprayPipelineParams& params);
+    const SprayPipelineParams& getParams() const;
+
+    // 加载STEP文件（按参数选择性加载、移动到原点并自动修复）
+    bool loadModel(const std::string& filename, const Message_ProgressRange& range = Message_ProgressRange());
+
+    // 按喷涂方向提取面
+    bool extractFaces(const Message_ProgressRange& range = Message_ProgressRange());
+
+    // 遮挡裁剪，失败时保留提取的面（取消时不保留）
+    bool removeOcclusion(const Message_ProgressRange& range = Message_ProgressRange());
+
+    // 生成切割平面
+    bool generateCuttingPlanes();
+
+    // 生成路径
+    bool generatePaths(const Message_ProgressRange& range = Message_ProgressRange());
+
+    // 整合轨迹（按参数进行路径级别可见性分析）
+    bool integrateTrajectories(const Message_ProgressRange& range = Message_ProgressRange());
+
+    // 执行完整流程，返回处理结果
+    SprayPipelineResult run(const std::string& filename, const Message_ProgressRange& range = Message_ProgressRange());
+
+    // 模型处理器
+    OCCHandler& getHandler();
+    const OCCHandler& getHandler() const;
+
+    // 路径处理器（generateCuttingPlanes之后有效）
+    FaceProcessor* getProcessor() const;
+
+    // 提取并遮挡裁剪后的面
+    const TopoDS_Shape& getProcessedFaces() const;
+
+    // 最近一次处理的结果统计
+    const SprayPipelineResult& getResult() const;
+
+private:
+    SprayPipelineParams params;
+    OCCHandler handler;
+    std::unique_ptr<FaceProcessor> processor;
+    TopoDS_Shape extractedFaces;   // 提取的面
+    TopoDS_Shape processedFaces;   // 遮挡裁剪后的面
+    SprayPipelineResult result;
+
+    // 统计形状中的面数量
+    static int countFaces(const TopoDS_Shape& shape);
+
+    // 记录阶段被取消，返回false
+    bool markCancelled(const char* stage);
+};
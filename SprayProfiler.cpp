@@ -0,0 +1,194 @@
+#include "SprayProfiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+// JSON字符串转义
+static std::string escapeJson(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+            case '"':  escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:   escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+// 查找阶段统计
+const SprayProfileStage* SprayProfileReport::findStage(const std::string& name) const {
+    for (const SprayProfileStage& stage : stages) {
+        if (stage.name == name) return &stage;
+    }
+    return nullptr;
+}
+
+// 读取计数器
+long long SprayProfileReport::counter(const std::string& name) const {
+    auto it = counters.find(name);
+    return it == counters.end() ? 0 : it->second;
+}
+
+// 以JSON格式输出
+std::string SprayProfileReport::toJson() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"wallMs\": " << wallMs << ",\n  \"stages\": [";
+    for (size_t i = 0; i < stages.size(); i++) {
+        const SprayProfileStage& stage = stages[i];
+        out << (i == 0 ? "\n" : ",\n")
+            << "    {\"name\": \"" << escapeJson(stage.name) << "\", \"calls\": " << stage.calls
+            << ", \"totalMs\": " << stage.totalMs << ", \"maxMs\": " << stage.maxMs << "}";
+    }
+    out << (stages.empty() ? "],\n" : "\n  ],\n") << "  \"counters\": {";
+    bool first = true;
+    for (const auto& counter : counters) {
+        out << (first ? "\n" : ",\n") << "    \"" << escapeJson(counter.first) << "\": " << counter.second;
+        first = false;
+    }
+    out << (counters.empty() ? "}\n" : "\n  }\n") << "}\n";
+    return out.str();
+}
+
+// 以文本表格输出
+std::string SprayProfileReport::toText() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "⏱️ 性能报告（总时间 " << wallMs << " ms）\n";
+    for (const SprayProfileStage& stage : stages) {
+        out << "  " << std::left << std::setw(44) << stage.name << std::right
+            << std::setw(8) << stage.calls << " 次"
+            << std::setw(12) << stage.totalMs << " ms"
+            << "  (最长 " << stage.maxMs << " ms)\n";
+    }
+    if (!counters.empty()) {
+        out << "📊 计数器\n";
+        for (const auto& counter : counters) {
+            out << "  " << std::left << std::setw(44) << counter.first << std::right
+                << std::setw(12) << counter.second << "\n";
+        }
+    }
+    return out.str();
+}
+
+// 全局单例
+SprayProfiler& SprayProfiler::instance() {
+    static SprayProfiler profiler;
+    return profiler;
+}
+
+// 构造函数
+SprayProfiler::SprayProfiler() : enabled(false), origin(std::chrono::steady_clock::now()) {
+}
+
+// 开启/关闭记录
+void SprayProfiler::setEnabled(bool value) {
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+// 清空已记录的数据
+void SprayProfiler::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    events.clear();
+    counters.clear();
+    origin = std::chrono::steady_clock::now();
+}
+
+// 记录一个已结束的作用域
+void SprayProfiler::recordScope(const char* name, std::chrono::steady_clock::time_point start,
+                                std::chrono::steady_clock::time_point end) {
+    int threadId = currentThreadId();
+    std::lock_guard<std::mutex> lock(mutex);
+    ScopeEvent event;
+    event.name = name;
+    event.startUs = std::chrono::duration_cast<std::chrono::microseconds>(start - origin).count();
+    event.durationUs = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    event.threadId = threadId;
+    events.push_back(event);
+}
+
+// 计数器累加
+void SprayProfiler::addCounter(const char* name, long long delta) {
+    std::lock_guard<std::mutex> lock(mutex);
+    counters[name] += delta;
+}
+
+// 生成报告
+SprayProfileReport SprayProfiler::report() const {
+    SprayProfileReport result;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    result.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin).count();
+    result.counters = counters;
+
+    std::map<std::string, SprayProfileStage> stageMap;
+    for (const ScopeEvent& event : events) {
+        SprayProfileStage& stage = stageMap[event.name];
+        double durationMs = event.durationUs / 1000.0;
+        stage.name = event.name;
+        stage.calls++;
+        stage.totalMs += durationMs;
+        stage.maxMs = std::max(stage.maxMs, durationMs);
+    }
+
+    for (auto& entry : stageMap) {
+        result.stages.push_back(entry.second);
+    }
+    std::sort(result.stages.begin(), result.stages.end(),
+              [](const SprayProfileStage& a, const SprayProfileStage& b) { return a.totalMs > b.totalMs; });
+    return result;
+}
+
+// 写出JSON报告
+bool SprayProfiler::writeJson(const std::string& filename) const {
+    std::ofstream out(filename);
+    if (!out) return false;
+    out << report().toJson();
+    return static_cast<bool>(out);
+}
+
+// 写出Chrome Trace格式
+bool SprayProfiler::writeChromeTrace(const std::string& filename) const {
+    std::ofstream out(filename);
+    if (!out) return false;
+
+    std::vector<ScopeEvent> snapshot;
+    std::map<std::string, long long> counterSnapshot;
+    long long endUs = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot = events;
+        counterSnapshot = counters;
+        endUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+    }
+
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (const ScopeEvent& event : snapshot) {
+        out << (first ? "" : ",\n")
+            << "{\"name\":\"" << escapeJson(event.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId
+            << ",\"ts\":" << event.startUs << ",\"dur\":" << event.durationUs << "}";
+        first = false;
+    }
+    // 计数器以结束时刻的最终值输出
+    for (const auto& counter : counterSnapshot) {
+        out << (first ? "" : ",\n")
+            << "{\"name\":\"" << escapeJson(counter.first) << "\",\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":" << endUs
+            << ",\"args\":{\"value\":" << counter.second << "}}";
+        first = false;
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return static_cast<bool>(out);
+}
+
+// 当前线程的序号
+int SprayProfiler::currentThreadId() {
+    static std::atomic<int> nextThreadId(1);
+    thread_local int threadId = nextThreadId++;
+    return threadId;
+}
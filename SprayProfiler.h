@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 阶段计时与计数器（性能诊断）
+//
+// 用法：
+//   SPRAY_PROFILE_SCOPE("occlusion.removeOccludedPortions");  // 作用域计时
+//   SPRAY_COUNTER_ADD("occlusion.booleansAttempted", 1);      // 计数器累加
+//
+// 运行时通过 SprayProfiler::instance().setEnabled(true) 开启，关闭时每个埋点只有一次原子读取；
+// 编译时定义 SPRAYR_DISABLE_PROFILING 可将所有埋点完全移除。
+// 名称必须是字符串字面量（或生命周期覆盖整个程序的字符串）。
+
+// 单个阶段的统计
+struct SprayProfileStage {
+    std::string name;       // 阶段名称
+    long long calls = 0;    // 调用次数
+    double totalMs = 0.0;   // 累计耗时（毫秒，多线程时为各线程耗时之和）
+    double maxMs = 0.0;     // 单次最长耗时（毫秒）
+};
+
+// 一次运行的性能报告
+struct SprayProfileReport {
+    double wallMs = 0.0;                       // 从reset到生成报告的总时间（毫秒）
+    std::vector<SprayProfileStage> stages;     // 各阶段统计（按累计耗时降序）
+    std::map<std::string, long long> counters; // 计数器
+
+    // 查找阶段统计，不存在时返回nullptr
+    const SprayProfileStage* findStage(const std::string& name) const;
+
+    // 读取计数器，不存在时返回0
+    long long counter(const std::string& name) const;
+
+    // 以JSON格式输出
+    std::string toJson() const;
+
+    // 以文本表格输出
+    std::string toText() const;
+};
+
+// 性能记录器（全局单例，线程安全）
+class SprayProfiler {
+public:
+    static SprayProfiler& instance();
+
+    // 开启/关闭记录
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // 清空已记录的数据并重新开始计时
+    void reset();
+
+    // 记录一个已结束的作用域
+    void recordScope(const char* name, std::chrono::steady_clock::time_point start,
+                     std::chrono::steady_clock::time_point end);
+
+    // 计数器累加
+    void addCounter(const char* name, long long delta);
+
+    // 生成报告
+    SprayProfileReport report() const;
+
+    // 写出JSON报告
+    bool writeJson(const std::string& filename) const;
+
+    // 写出Chrome Trace格式（chrome://tracing 或 Perfetto 打开）
+    bool writeChromeTrace(const std::string& filename) const;
+
+private:
+    SprayProfiler();
+
+    // 一条作用域记录
+    struct ScopeEvent {
+        const char* name;  // 名称
+        long long startUs; // 相对reset的开始时间（微秒）
+        long long durationUs; // 持续时间（微秒）
+        int threadId;      // 线程序号
+    };
+
+    // 当前线程的序号（按首次记录顺序分配）
+    static int currentThreadId();
+
+    std::atomic<bool> enabled;
+    mutable std::mutex mutex;
+    std::chrono::steady_clock::time_point origin;   // 计时起点
+    std::vector<ScopeEvent> events;                 // 作用域记录
+    std::map<std::string, long long> counters;      // 计数器
+};
+
+// 作用域计时器：构造时开始计时，析构时记录
+class SprayScopedTimer {
+public:
+    explicit SprayScopedTimer(const char* name)
+        : name(name), active(SprayProfiler::instance().isEnabled()) {
+        if (active) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~SprayScopedTimer() {
+        if (active) {
+            SprayProfiler::instance().recordScope(name, start, std::chrono::steady_clock::now());
+        }
+    }
+
+    SprayScopedTimer(const SprayScopedTimer&) = delete;
+    SprayScopedTimer& operator=(const SprayScopedTimer&) = delete;
+
+private:
+    const char* name;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define SPRAY_PROFILE_CONCAT_IMPL(a, b) a##b
+#define SPRAY_PROFILE_CONCAT(a, b) SPRAY_PROFILE_CONCAT_IMPL(a, b)
+
+#ifndef SPRAYR_DISABLE_PROFILING
+#define SPRAY_PROFILE_SCOPE(name) SprayScopedTimer SPRAY_PROFILE_CONCAT(sprayProfileScope_, __LINE__)(name)
+#define SPRAY_COUNTER_ADD(name, delta)                                  \
+    do {                                                                \
+        if (SprayProfiler::instance().isEnabled()) {                    \
+            SprayProfiler::instance().addCounter((name), (delta));      \
+        }                                                               \
+    } while (0)
+#else
+#define SPRAY_PROFILE_SCOPE(name) do {} while (0)
+#define SPRAY_COUNTER_ADD(name, delta) do {} while (0)
+#endif
@@ -0,0 +1,79 @@
+#include "SprayProgress.h"
+#include <cmath>
+#include <vector>
+
+// 构造函数
+SprayProgressIndicator::SprayProgressIndicator() : cancelled(false), lastPermille(-1) {
+}
+
+// 设置进度回调
+void SprayProgressIndicator::setCallback(const Callback& newCallback) {
+    callback = newCallback;
+}
+
+// 请求取消
+void SprayProgressIndicator::cancel() {
+    cancelled.store(true, std::memory_order_relaxed);
+}
+
+// 是否已请求取消
+bool SprayProgressIndicator::isCancelled() const {
+    return cancelled.load(std::memory_order_relaxed);
+}
+
+// OCCT算法查询是否中止
+Standard_Boolean SprayProgressIndicator::UserBreak() {
+    return isCancelled() ? Standard_True : Standard_False;
+}
+
+// 进度推进：进度变化不足0.1%且步骤未变化时不回调
+void SprayProgressIndicator::Show(const Message_ProgressScope& scope, const Standard_Boolean isForce) {
+    if (!callback) {
+        return;
+    }
+
+    double fraction = GetPosition();
+    int permille = static_cast<int>(std::floor(fraction * 1000.0));
+    std::string step = describeScope(scope);
+    if (!isForce && permille == lastPermille && step == lastStep) {
+        return;
+    }
+
+    lastPermille = permille;
+    lastStep = step;
+    callback(fraction, step);
+}
+
+// Start时重置
+void SprayProgressIndicator::Reset() {
+    Message_ProgressIndicator::Reset();
+    lastPermille = -1;
+    lastStep.clear();
+}
+
+// 拼接步骤描述：只包含有名称的作用域，有限步数的作用域附带 当前/总数
+std::string SprayProgressIndicator::describeScope(const Message_ProgressScope& scope) {
+    std::vector<const Message_ProgressScope*> chain;
+    for (const Message_ProgressScope* current = &scope; current != nullptr; current = current->Parent()) {
+        chain.push_back(current);
+    }
+
+    std::string description;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        const Message_ProgressScope* current = *it;
+        const char* name = current->Name();
+        if (name == nullptr || *name == '\0') {
+            continue;
+        }
+
+        if (!description.empty()) {
+            description += " / ";
+        }
+        description += name;
+        if (!current->IsInfinite() && current->MaxValue() > 1.0) {
+            description += " " + std::to_string(static_cast<long long>(current->Value())) + "/" +
+                           std::to_string(static_cast<long long>(current->MaxValue()));
+        }
+    }
+    return description;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Message_ProgressIndicator.hxx>
+#include <Message_ProgressRange.hxx>
+#include <Message_ProgressScope.hxx>
+#include <atomic>
+#include <functional>
+#include <string>
+
+// 进度报告与协作式取消（基于OCCT的 Message_ProgressIndicator）
+//
+// 用法：
+//   Handle(SprayProgressIndicator) progress = new SprayProgressIndicator();
+//   progress->setCallback([](double fraction, const std::string& step) { ... });
+//   pipeline.removeOcclusion(progress->Start());   // 工作线程中执行
+//   progress->cancel();                             // 任意线程中请求取消
+//
+// 取消后，各阶段内部的 Message_ProgressScope::More() 返回false，传入OCCT算法的进度范围
+// （布尔运算、缝合、STEP转换等）也会在下一个检查点中止。
+// 回调在推进进度的线程中执行（可能是OSD_Parallel的工作线程），由指示器内部的互斥锁串行化；
+// 界面需要自行转发到UI线程。
+class SprayProgressIndicator : public Message_ProgressIndicator {
+    DEFINE_STANDARD_RTTI_INLINE(SprayProgressIndicator, Message_ProgressIndicator)
+
+public:
+    // 进度回调：fraction为总体进度（0~1），step为当前步骤的描述（如 "遮挡裁剪 / 第2层 3/7"）
+    typedef std::function<void(double fraction, const std::string& step)> Callback;
+
+    SprayProgressIndicator();
+
+    // 设置进度回调（需在Start之前设置）
+    void setCallback(const Callback& callback);
+
+    // 请求取消
+    void cancel();
+
+    // 是否已请求取消
+    bool isCancelled() const;
+
+    // OCCT算法通过此接口查询是否中止
+    Standard_Boolean UserBreak() override;
+
+protected:
+    // 进度推进时由OCCT调用（持有指示器内部互斥锁）
+    void Show(const Message_ProgressScope& scope, const Standard_Boolean isForce) override;
+
+    // Start时重置
+    void Reset() override;
+
+private:
+    // 从根作用域到当前作用域拼接步骤描述
+    static std::string describeScope(const Message_ProgressScope& scope);
+
+    Callback callback;
+    std::atomic<bool> cancelled;
+    int lastPermille;          // 上次回调时的进度（千分比），用于减少回调次数
+    std::string lastStep;      // 上次回调时的步骤描述
+};
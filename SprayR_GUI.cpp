@@ -3,6 +3,7 @@
 //
 
 #include "SprayR_GUI.h"
+#include "SprayLog.h"
 #include <QFileDialog>
 #include <QDebug>
 #include <vtkHardwareSelector.h>
@@ -44,17 +45,29 @@
 #include <vtkSphereSource.h>
 #include <QMessageBox>
 #include <QLabel>
+#include <QStandardPaths>
+#include <Message_ProgressScope.hxx>
+#include <Standard_Failure.hxx>
+#include <memory>
+#include <sstream>
 
 #include "FaceProcessor.h"
 
 
 Spray_GUI::Spray_GUI(QWidget* parent)
-    : QMainWindow(parent), useColorBarMode(false), m_sprayPathVTKActor(nullptr), m_nonSprayPathVTKActor(nullptr)
+    : QMainWindow(parent), useColorBarMode(false), m_sprayPathVTKActor(nullptr), m_nonSprayPathVTKActor(nullptr),
+      jobThread(nullptr)
 {
     setupUI();
     connectSignals();
 
-    // 初始化VTKViewer
+    // 修复后的模型缓存到用户缓存目录，再次打开同一零件时跳过读取与修复
+    SprayPipelineParams params = pipeline.getParams();
+    params.shapeCacheDir = (QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/shapes").toStdString();
+    pipeline.setParams(params);
+
+    // 初始化VTKViewer（大模型旋转缩放时渲染简化代理）
+    defaultOptions.useLod = true;
     vtkViewer.setRenderWindow(renderWindow);
     // 延迟设置交互器，因为此时interactor可能尚未创建
     QTimer::singleShot(100, this, [this]() {
@@ -65,7 +78,9 @@ Spray_GUI::Spray_GUI(QWidget* parent)
     });
 }
 
-Spray_GUI::~Spray_GUI() {}
+Spray_GUI::~Spray_GUI() {
+    cancelJobAndWait();
+}
 
 void Spray_GUI::setupUI() {
     // 创建中央主窗口部件
@@ -93,6 +108,19 @@ void Spray_GUI::setupUI() {
 
     // 按钮布局加入左侧垂直布局
     leftLayout->addLayout(buttonLayout);
+    // 任务状态栏：当前步骤、进度条、取消按钮
+    QHBoxLayout* jobLayout = new QHBoxLayout();
+    statusLabel = new QLabel(QStringLiteral("就绪"), centralWidget);
+    progressBar = new QProgressBar(centralWidget);
+    progressBar->setRange(0, 1000);
+    progressBar->setTextVisible(false);
+    progressBar->setVisible(false);
+    btnCancel = new QPushButton(QStringLiteral("取消"), centralWidget);
+    btnCancel->setEnabled(false);
+    jobLayout->addWidget(statusLabel, 1);
+    jobLayout->addWidget(progressBar, 2);
+    jobLayout->addWidget(btnCancel);
+    leftLayout->addLayout(jobLayout);
     // 创建VTK显示窗口并加入左侧布局
     vtkWidget = new QVTKOpenGLNativeWidget(this);
     leftLayout->addWidget(vtkWidget, 1);
@@ -133,135 +161,109 @@ void Spray_GUI::connectSignals() {
         QString fileName = QFileDialog::getOpenFileName(this, "选择STEP文件", "", "STEP Files (*.step *.stp)");
         if (fileName.isEmpty()) return;
 
+        std::string filename = fileName.toStdString();
+        auto poly = std::make_shared<vtkSmartPointer<vtkPolyData>>();
+        auto lod = std::make_shared<VTKViewer::ModelLod>();
 
-        // 使用基础修复功能加载STEP文件（保持法向量方向）
-        // 参数说明：文件名，移动到原点=true，自动修复=false（避免法向量问题）
-        if (!occHandler.loadStepFile(fileName.toStdString(), true, true)) {
-            QMessageBox::warning(this, "加载失败", "STEP文件加载失败！");
-            return;
-        }
-
-        TopoDS_Shape shape = occHandler.getShape();
-        std::cout << "📋 模型结构分析：" << std::endl;
-        occHandler.printShapeStructure(shape, TopAbs_SHELL, std::cout, 0); // 显示完整结构和统计信息
-
-        vtkSmartPointer<vtkPolyData> poly = occHandler.shapeToPolyData();
-        if (!poly || poly->GetNumberOfPoints() == 0) {
-            QMessageBox::warning(this, "转换失败", "STEP模型转换为VTK数据失败！");
-            return;
-        }
-
-        currentPoly = poly; // 保存当前模型数据
-
-        // 渲染参数设置
-        defaultOptions.showSurface = true; // 显示表面
-        defaultOptions.showWireframe = true; // 显示线框
-        defaultOptions.showNormals = true; // 显示法线
-        defaultOptions.surfaceOpacity = 1.0; // 不透明度
-        defaultOptions.normalScale = 50.0; // 法线箭头大小
-        // 明确设置银色
-        defaultOptions.surfaceColor[0] = 0.75; // 银色 R
-        defaultOptions.surfaceColor[1] = 0.75; // 银色 G
-        defaultOptions.surfaceColor[2] = 0.75; // 银色 B
+        runJob(QStringLiteral("导入STEP模型"), [this, filename, poly, lod, options = defaultOptions](const Message_ProgressRange& range) {
+            // 加载STEP文件（移动到原点并自动修复，见SprayPipelineParams）
+            if (!pipeline.loadModel(filename, range)) {
+                return false;
+            }
 
-        // 更新VTKViewer显示模型
+            OCCHandler& occHandler = pipeline.getHandler();
+            std::ostringstream structure;
+            occHandler.printShapeStructure(occHandler.getShape(), TopAbs_SHELL, structure, 0); // 显示完整结构和统计信息
+            SPRAY_LOG_INFO << "📋 模型结构分析：\n" << structure.str();
+
+            *poly = occHandler.shapeToPolyData();
+            *lod = VTKViewer::buildModelLod(*poly, options, occHandler.shapeEdgesToPolyData());
+            return true;
+        }, [this, poly, lod](bool success) {
+            if (!success) {
+                QMessageBox::warning(this, "加载失败", "STEP文件加载失败！");
+                return;
+            }
+            if (!*poly || (*poly)->GetNumberOfPoints() == 0) {
+                QMessageBox::warning(this, "转换失败", "STEP模型转换为VTK数据失败！");
+                return;
+            }
 
-        // 使用VTKViewer显示模型，替代原来的updateModelView调用
-        vtkViewer.setModel(poly, defaultOptions);
-        renderWindow->Render();
+            currentPoly = *poly; // 保存当前模型数据
+
+            // 渲染参数设置
+            defaultOptions.showSurface = true; // 显示表面
+            defaultOptions.showWireframe = true; // 显示线框
+            defaultOptions.showNormals = true; // 显示法线
+            defaultOptions.surfaceOpacity = 1.0; // 不透明度
+            defaultOptions.normalScale = 50.0; // 法线箭头大小
+            // 明确设置银色
+            defaultOptions.surfaceColor[0] = 0.75; // 银色 R
+            defaultOptions.surfaceColor[1] = 0.75; // 银色 G
+            defaultOptions.surfaceColor[2] = 0.75; // 银色 B
+
+            // 使用VTKViewer显示模型，替代原来的updateModelView调用
+            vtkViewer.setModel(currentPoly, defaultOptions, *lod);
+            renderWindow->Render();
+        });
     });
 
     // 旋转按钮（恢复为只旋转模型）
     connect(btnRotateX, &QPushButton::clicked, this, [this]() {
-        gp_Dir axis(1, 0, 0); // X轴
-        occHandler.rotate90(axis);
-        vtkSmartPointer<vtkPolyData> poly = occHandler.shapeToPolyData();
-        if (!poly || poly->GetNumberOfPoints() == 0) {
-            QMessageBox::warning(this, "转换失败", "STEP模型转换为VTK数据失败！");
-            return;
-        }
-        currentPoly = poly; // 更新当前模型数据
-        vtkViewer.setModel(poly, defaultOptions);
-        renderWindow->Render();
-
-        });
+        rotateModel(gp_Dir(1, 0, 0)); // X轴
+    });
     connect(btnRotateY, &QPushButton::clicked, this, [this]() {
-        gp_Dir axis(0, 1, 0); // Y轴
-        occHandler.rotate90(axis);
-        vtkSmartPointer<vtkPolyData> poly = occHandler.shapeToPolyData();
-        if (!poly || poly->GetNumberOfPoints() == 0) {
-            QMessageBox::warning(this, "转换失败", "STEP模型转换为VTK数据失败！");
-            return;
-        }
-        currentPoly = poly; // 更新当前模型数据
-        vtkViewer.setModel(poly, defaultOptions);
-        renderWindow->Render();
-        });
+        rotateModel(gp_Dir(0, 1, 0)); // Y轴
+    });
     connect(btnRotateZ, &QPushButton::clicked, this, [this]() {
-        gp_Dir axis(0, 0, 1); // Z轴
-        occHandler.rotate90(axis);
-        vtkSmartPointer<vtkPolyData> poly = occHandler.shapeToPolyData();
-        if (!poly || poly->GetNumberOfPoints() == 0) {
-            QMessageBox::warning(this, "转换失败", "STEP模型转换为VTK数据失败！");
-            return;
-        }
-        currentPoly = poly; // 更新当前模型数据
-        vtkViewer.setModel(poly, defaultOptions);
-        renderWindow->Render();
-        });
-
+        rotateModel(gp_Dir(0, 0, 1)); // Z轴
+    });
 
     // 提取shells按钮（集成面合并功能）
     connect(btnextractFaces, &QPushButton::clicked, this, [this]() {
-            gp_Dir direction(0, 0, 1); // 默认法向量方向为Z轴
+        auto poly = std::make_shared<vtkSmartPointer<vtkPolyData>>();
+        auto lod = std::make_shared<VTKViewer::ModelLod>();
 
-            try {
-                // 第一步：提取面
-                std::cout << "🔍 基于法向量提取面..." << std::endl;
-                TopoDS_Shape extractedFaces = occHandler.extractFacesByNormal(direction, 5.0);
+        runJob(QStringLiteral("提取shells"), [this, poly, lod, options = defaultOptions](const Message_ProgressRange& range) {
+            Message_ProgressScope scope(range, nullptr, 6);
 
-                if (extractedFaces.IsNull()) {
-                    QMessageBox::warning(this, "提取失败", "未能提取到任何面！");
-                    return;
-                }
+            // 第一步：提取面
+            if (!pipeline.extractFaces(scope.Next())) {
+                return false;
+            }
 
-                std::cout << "📋 提取面的原始结构：" << std::endl;
-                occHandler.printShapeStructure(extractedFaces, TopAbs_SHELL, std::cout, 0);
-
-                // 第二步：自动进行遮挡裁剪
-                std::cout << "🔗 自动进行遮挡裁剪..." << std::endl;
-                // 使用更小的高度容差，更精确的分层
-                TopoDS_Shape processedShape = occHandler.removeOccludedPortions(extractedFaces, 1.0);
-
-                if (!processedShape.IsNull()) {
-                    // 使用遮挡裁剪后的结果
-                    extractedShells = processedShape;
-                    std::cout << "✅ 遮挡裁剪完成，最终结构：" << std::endl;
-                    occHandler.printShapeStructure(extractedShells, TopAbs_SHELL, std::cout, 0);
-                } else {
-                    // 如果裁剪失败，使用原始提取的面
-                    std::cout << "⚠️ 遮挡裁剪失败，使用原始提取的面" << std::endl;
-                    extractedShells = extractedFaces;
-                }
+            // 第二步：自动进行遮挡裁剪（失败时使用原始提取的面）
+            pipeline.removeOcclusion(scope.Next(5));
+            if (pipeline.getResult().cancelled) {
+                return false;
+            }
 
-                std::cout << "✅ 面提取和遮挡裁剪完成，已保存结果用于后续处理" << std::endl;
+            OCCHandler& occHandler = pipeline.getHandler();
+            std::ostringstream structure;
+            occHandler.printShapeStructure(pipeline.getProcessedFaces(), TopAbs_SHELL, structure, 0);
+            SPRAY_LOG_INFO << "✅ 遮挡裁剪完成，最终结构：\n" << structure.str();
+
+            *poly = occHandler.shapeToPolyData(pipeline.getProcessedFaces());
+            *lod = VTKViewer::buildModelLod(*poly, options, occHandler.shapeEdgesToPolyData(pipeline.getProcessedFaces()));
+            return true;
+        }, [this, poly, lod](bool success) {
+            if (!success) {
+                QMessageBox::warning(this, "提取失败", "未能提取到任何面！");
+                return;
+            }
 
-                // 显示最终结果
-                vtkSmartPointer<vtkPolyData> poly = occHandler.shapeToPolyData(extractedShells);
-                if (poly && poly->GetNumberOfPoints() > 0) {
-                    vtkViewer.setModel(poly, defaultOptions);
-                    renderWindow->Render();
-                } else {
-                    QMessageBox::warning(this, "显示失败", "无法转换结果为可视化数据！");
-                }
+            extractedShells = pipeline.getProcessedFaces();
+            SPRAY_LOG_INFO << "✅ 面提取和遮挡裁剪完成，已保存结果用于后续处理";
 
-            } catch (const std::exception& e) {
-                QMessageBox::critical(this, "处理错误",
-                                    QString("面提取和合并过程中发生错误: %1").arg(e.what()));
-            } catch (...) {
-                QMessageBox::critical(this, "处理错误", "面提取和合并过程中发生未知错误");
+            // 显示最终结果
+            if (*poly && (*poly)->GetNumberOfPoints() > 0) {
+                vtkViewer.setModel(*poly, defaultOptions, *lod);
+                renderWindow->Render();
+            } else {
+                QMessageBox::warning(this, "显示失败", "无法转换结果为可视化数据！");
             }
         });
+    });
 
     connect(btnaddcutFaces, &QPushButton::clicked, this, [this]() {
         if (extractedShells.IsNull()) {
@@ -269,125 +271,244 @@ void Spray_GUI::connectSignals() {
             return;
         }
 
-        gp_Dir direction(0, 0, 1); // 默认法向量方向为Z轴
+        SPRAY_LOG_INFO << "🎯 使用当前保存的shells生成切割路径...";
+        SPRAY_LOG_INFO << "📋 当前shells可能是原始提取的或经过重叠裁剪的";
+
+        // 工作线程中生成的数据，完成后在UI线程中显示
+        struct PathJobOutput {
+            vtkSmartPointer<vtkPolyData> planeData;      // 切割平面
+            vtkSmartPointer<vtkPolyData> integratedData; // 表层可见轨迹
+            bool pathsGenerated = false;
+            bool integrated = false;
+        };
+        auto output = std::make_shared<PathJobOutput>();
+
+        runJob(QStringLiteral("生成切割路径"), [this, output](const Message_ProgressRange& range) {
+            Message_ProgressScope scope(range, nullptr, 4);
+
+            // 生成切割平面（间距、偏移与点密度见SprayPipelineParams）
+            if (pipeline.generateCuttingPlanes()) {
+                SPRAY_LOG_INFO << "生成切割平面成功，准备显示...";
+                // 仅用于显示，单精度即可
+                pipeline.getProcessor()->setSinglePrecisionPolyData(true);
+                output->planeData = pipeline.getProcessor()->cuttingPlanesToPolyData();
+            }
 
-        std::cout << "🎯 使用当前保存的shells生成切割路径..." << std::endl;
-        std::cout << "📋 当前shells可能是原始提取的或经过重叠裁剪的" << std::endl;
+            // 第三步：为可见面生成路径
+            output->pathsGenerated = pipeline.generatePaths(scope.Next(3));
+            if (!output->pathsGenerated) {
+                return !pipeline.getResult().cancelled;
+            }
 
-        FaceProcessor processor;
+            // 第四步：整合轨迹，并进行路径级别的可见性分析
+            output->integrated = pipeline.integrateTrajectories(scope.Next());
+            if (!output->integrated) {
+                return !pipeline.getResult().cancelled;
+            }
 
-        processor.setShape(extractedShells);
+            // 只显示表层可见轨迹
+            output->integratedData = pipeline.getProcessor()->integratedTrajectoriesToPolyData();
+            return true;
+        }, [this, output](bool) {
+            if (output->planeData && output->planeData->GetNumberOfPoints() > 0) {
+                // 为切割平面设置渲染选项
+                VTKViewer::RenderOptions planeOptions;
+                planeOptions.surfaceOpacity = 0.3;  // 半透明
+                planeOptions.surfaceColor[0] = 0.2; // 青蓝色
+                planeOptions.surfaceColor[1] = 0.7;
+                planeOptions.surfaceColor[2] = 0.9;
+                planeOptions.showWireframe = false; // 不显示线框
+                planeOptions.showNormals = false;   // 不显示法线
+
+                // 显示切割平面（重复生成时替换原图层的数据）
+                vtkViewer.setLayer(VTKViewer::LAYER_PLANES, output->planeData, planeOptions);
+                renderWindow->Render();
+            } else {
+                vtkViewer.setLayerVisible(VTKViewer::LAYER_PLANES, false);
+            }
 
-        try {
-            // 增加间距，减少切割平面数量
-            // 设置切割参数（可选）- 增加路径间距以减少生成的路径数量
-            double pathSpacing = 200;  // 增加间距到200.0
-            double offsetDistance = 300.0;  // 保持偏移距离为0.0
-            processor.setCuttingParameters(direction, pathSpacing, offsetDistance, 0.2);  // 设置点密度为0.2
-
-
-
-            // 生成切割平面
-            std::cout << "开始生成切割平面..." << std::endl;
-            if (processor.generateCuttingPlanes()) {
-                // 显示切割平面
-                std::cout << "生成切割平面成功，准备显示..." << std::endl;
-
-                // 创建用于显示切割平面的PolyData
-                vtkSmartPointer<vtkPolyData> planeData = processor.cuttingPlanesToPolyData();
-
-                if (planeData && planeData->GetNumberOfPoints() > 0) {
-                    // 为切割平面设置渲染选项
-                    VTKViewer::RenderOptions planeOptions;
-                    planeOptions.surfaceOpacity = 0.3;  // 半透明
-                    planeOptions.surfaceColor[0] = 0.2; // 青蓝色
-                    planeOptions.surfaceColor[1] = 0.7;
-                    planeOptions.surfaceColor[2] = 0.9;
-                    planeOptions.showWireframe = false; // 不显示线框
-                    planeOptions.showNormals = false;   // 不显示法线
-
-                    // 添加切割平面到视图
-                    vtkViewer.addPolyData(planeData, planeOptions);
-                }
+            // 上一次生成的轨迹在本次成功整合前隐藏
+            if (!output->integratedData || output->integratedData->GetNumberOfPoints() == 0) {
+                vtkViewer.setLayerVisible(VTKViewer::LAYER_TRAJECTORIES, false);
+                renderWindow->Render();
             }
 
-            // 第三步：为可见面生成路径
-            std::cout << "开始为可见面生成路径..." << std::endl;
-
-            // 生成路径
-            if (processor.generatePaths()) {
-                // 获取生成的路径
-                const std::vector<SprayPath>& paths = processor.getPaths();
-                std::cout << "成功生成 " << paths.size() << " 条路径" << std::endl;
-
-                if (paths.size() > 500) {
-                    QMessageBox::warning(this, "路径数量过多",
-                                       "生成了 " + QString::number(paths.size()) + " 条路径，这可能导致性能问题。\n"
-                                       "建议增加路径间距或仅处理部分面。\n"
-                                       "是否继续？",
-                                       QMessageBox::Yes | QMessageBox::No);
-                }
+            if (!output->pathsGenerated) {
+                QMessageBox::warning(this, "路径生成失败", "未能生成任何路径，请检查输入面或参数设置。");
+                return;
+            }
+
+            const std::vector<SprayPath>& paths = pipeline.getProcessor()->getPaths();
+            if (paths.size() > 500) {
+                QMessageBox::warning(this, "路径数量过多",
+                                   "生成了 " + QString::number(paths.size()) + " 条路径，这可能导致性能问题。\n"
+                                   "建议增加路径间距或仅处理部分面。");
+            }
 
-                // 第四步：整合轨迹
-                std::cout << "开始整合轨迹..." << std::endl;
-                if (processor.integrateTrajectories()) {
-                    const std::vector<IntegratedTrajectory>& trajectories = processor.getIntegratedTrajectories();
-                    std::cout << "成功整合为 " << trajectories.size() << " 条连续轨迹" << std::endl;
-
-                    // 第五步：路径级别的可见性分析（可选，用于进一步优化）
-                    std::cout << "开始路径级别的可见性分析..." << std::endl;
-                    if (processor.analyzePathVisibility()) {
-                        const std::vector<SurfaceLayer>& layers = processor.getSurfaceLayers();
-                        std::cout << "可见性分析完成，识别出 " << layers.size() << " 个表面层级" << std::endl;
-
-                        // 显示表层轨迹统计
-                        if (!layers.empty()) {
-                            std::cout << "路径级别可见性分析完成，最表层包含 " << layers[0].pathIndices.size() << " 条可见路径段" << std::endl;
-                            std::cout << "已按Z+方向进行遮挡检测和智能路径分割" << std::endl;
-                            std::cout << "保留了所有没被遮挡且长度≥20mm的路径段，删除了被遮挡和过短的部分" << std::endl;
-                            std::cout << "颜色说明：绿色=喷涂路径，橙色=连接路径" << std::endl;
-                        }
-                    } else {
-                        std::cout << "跳过路径级别的可见性分析，直接使用面级别的可见性结果" << std::endl;
-                    }
-
-                    // 只显示表层可见轨迹
-                    vtkSmartPointer<vtkPolyData> integratedData = processor.integratedTrajectoriesToPolyData();
-
-                    if (integratedData && integratedData->GetNumberOfPoints() > 0) {
-                        VTKViewer::RenderOptions integratedOptions;
-                        // 使用默认颜色，让VTK使用数据中的颜色信息
-                        // 绿色=喷涂路径，橙色=连接路径
-                        integratedOptions.surfaceOpacity = 1.0;   // 完全不透明
-                        integratedOptions.showNormals = false;
-
-                        try {
-                            vtkViewer.addPolyData(integratedData, integratedOptions);
-                            renderWindow->Render();
-                            std::cout << "表层可见轨迹渲染完成!" << std::endl;
-                        } catch (const std::exception& e) {
-                            QMessageBox::critical(this, "渲染错误",
-                                                QString("渲染表层轨迹时发生错误: %1").arg(e.what()));
-                        } catch (...) {
-                            QMessageBox::critical(this, "渲染错误", "渲染表层轨迹时发生未知错误");
-                        }
-                    } else {
-                        QMessageBox::warning(this, "轨迹生成问题", "表层轨迹数据为空，无法显示。");
-                    }
-                } else {
-                    std::cout << "轨迹整合失败，无法进行表面可见性分析" << std::endl;
-                    QMessageBox::warning(this, "轨迹整合失败", "未能生成整合轨迹，请检查输入面或参数设置。");
+            if (!output->integrated) {
+                SPRAY_LOG_WARN << "⚠️ 轨迹整合失败，无法进行表面可见性分析";
+                QMessageBox::warning(this, "轨迹整合失败", "未能生成整合轨迹，请检查输入面或参数设置。");
+                return;
+            }
+
+            // 显示表层轨迹统计
+            const std::vector<SurfaceLayer>& layers = pipeline.getProcessor()->getSurfaceLayers();
+            if (!layers.empty()) {
+                SPRAY_LOG_INFO << "可见性分析完成，识别出 " << layers.size() << " 个表面层级";
+                SPRAY_LOG_INFO << "路径级别可见性分析完成，最表层包含 " << layers[0].pathIndices.size() << " 条可见路径段";
+                SPRAY_LOG_INFO << "已按Z+方向进行遮挡检测和智能路径分割";
+                SPRAY_LOG_INFO << "保留了所有没被遮挡且长度≥20mm的路径段，删除了被遮挡和过短的部分";
+                SPRAY_LOG_INFO << "颜色说明：绿色=喷涂路径，橙色=连接路径";
+            }
+
+            if (output->integratedData && output->integratedData->GetNumberOfPoints() > 0) {
+                VTKViewer::RenderOptions integratedOptions;
+                // 使用默认颜色，让VTK使用数据中的颜色信息
+                // 绿色=喷涂路径，橙色=连接路径
+                integratedOptions.surfaceOpacity = 1.0;   // 完全不透明
+                integratedOptions.showNormals = false;
+
+                try {
+                    vtkViewer.setLayer(VTKViewer::LAYER_TRAJECTORIES, output->integratedData, integratedOptions);
+                    renderWindow->Render();
+                    SPRAY_LOG_INFO << "表层可见轨迹渲染完成!";
+                } catch (const std::exception& e) {
+                    QMessageBox::critical(this, "渲染错误",
+                                        QString("渲染表层轨迹时发生错误: %1").arg(e.what()));
+                } catch (...) {
+                    QMessageBox::critical(this, "渲染错误", "渲染表层轨迹时发生未知错误");
                 }
             } else {
-                QMessageBox::warning(this, "路径生成失败", "未能生成任何路径，请检查输入面或参数设置。");
+                QMessageBox::warning(this, "轨迹生成问题", "表层轨迹数据为空，无法显示。");
             }
+        });
+    });
+
+    // 取消按钮：请求当前任务在下一个检查点停止
+    connect(btnCancel, &QPushButton::clicked, this, [this]() {
+        if (!jobProgress.IsNull()) {
+            jobProgress->cancel();
+            btnCancel->setEnabled(false);
+            statusLabel->setText(QStringLiteral("正在取消..."));
+        }
+    });
+}
+
+// 旋转模型并刷新显示
+void Spray_GUI::rotateModel(const gp_Dir& axis) {
+    auto poly = std::make_shared<vtkSmartPointer<vtkPolyData>>();
+    auto lod = std::make_shared<VTKViewer::ModelLod>();
+
+    runJob(QStringLiteral("旋转模型"), [this, axis, poly, lod, options = defaultOptions](const Message_ProgressRange&) {
+        pipeline.getHandler().rotate90(axis);
+        *poly = pipeline.getHandler().shapeToPolyData();
+        *lod = VTKViewer::buildModelLod(*poly, options, pipeline.getHandler().shapeEdgesToPolyData());
+        return true;
+    }, [this, poly, lod](bool) {
+        if (!*poly || (*poly)->GetNumberOfPoints() == 0) {
+            QMessageBox::warning(this, "转换失败", "STEP模型转换为VTK数据失败！");
+            return;
+        }
+        currentPoly = *poly; // 更新当前模型数据
+        vtkViewer.setModel(currentPoly, defaultOptions, *lod);
+        renderWindow->Render();
+    });
+}
+
+// 在工作线程中执行耗时任务
+void Spray_GUI::runJob(const QString& title,
+                       const std::function<bool(const Message_ProgressRange&)>& work,
+                       const std::function<void(bool success)>& finished) {
+    if (jobThread) {
+        return; // 同一时间只运行一个任务（按钮已禁用，这里只是保护）
+    }
+
+    Handle(SprayProgressIndicator) progress = new SprayProgressIndicator();
+    // 进度回调可能来自任意工作线程，转发到UI线程更新控件
+    progress->setCallback([this](double fraction, const std::string& step) {
+        int value = static_cast<int>(fraction * 1000.0);
+        QString text = QString::fromStdString(step);
+        QMetaObject::invokeMethod(this, [this, value, text]() {
+            if (jobProgress.IsNull() || jobProgress->isCancelled()) return;
+            progressBar->setValue(value);
+            if (!text.isEmpty()) statusLabel->setText(text);
+        }, Qt::QueuedConnection);
+    });
+
+    // 任务结果：成功标志与异常信息
+    struct JobOutcome {
+        bool success = false;
+        QString error;
+    };
+    auto outcome = std::make_shared<JobOutcome>();
+
+    jobThread = QThread::create([progress, work, outcome]() {
+        try {
+            outcome->success = work(progress->Start());
+        } catch (const Standard_Failure& e) {
+            outcome->error = QString::fromUtf8(e.GetMessageString());
         } catch (const std::exception& e) {
-            QMessageBox::critical(this, "处理错误",
-                                QString("处理面时发生错误: %1").arg(e.what()));
+            outcome->error = QString::fromUtf8(e.what());
         } catch (...) {
-            QMessageBox::critical(this, "处理错误", "处理面时发生未知错误");
+            outcome->error = QStringLiteral("未知错误");
         }
     });
+
+    connect(jobThread, &QThread::finished, this, [this, title, progress, outcome, finished]() {
+        jobThread->deleteLater();
+        jobThread = nullptr;
+        jobProgress.Nullify();
+        setJobRunning(false);
+
+        // 任务完成后才收到的取消请求不影响结果
+        if (progress->isCancelled() && !outcome->success) {
+            statusLabel->setText(title + QStringLiteral(" 已取消"));
+            return;
+        }
+        if (!outcome->error.isEmpty()) {
+            statusLabel->setText(title + QStringLiteral(" 出错"));
+            QMessageBox::critical(this, "处理错误", QString("%1过程中发生错误: %2").arg(title, outcome->error));
+            return;
+        }
+
+        statusLabel->setText(title + (outcome->success ? QStringLiteral(" 完成") : QStringLiteral(" 失败")));
+        finished(outcome->success);
+    });
+
+    jobProgress = progress;
+    statusLabel->setText(title + QStringLiteral("..."));
+    progressBar->setValue(0);
+    setJobRunning(true);
+    jobThread->start();
+}
+
+// 任务运行期间禁用会修改流程状态的按钮
+void Spray_GUI::setJobRunning(bool running) {
+    btnLoadModel->setEnabled(!running);
+    btnRotateX->setEnabled(!running);
+    btnRotateY->setEnabled(!running);
+    btnRotateZ->setEnabled(!running);
+    btnextractFaces->setEnabled(!running);
+    btnaddcutFaces->setEnabled(!running);
+    btnCancel->setEnabled(running);
+    progressBar->setVisible(running);
+}
+
+// 请求取消当前任务并等待其结束
+void Spray_GUI::cancelJobAndWait() {
+    if (!jobThread) {
+        return;
+    }
+    if (!jobProgress.IsNull()) {
+        jobProgress->cancel();
+    }
+    jobThread->wait();
+}
+
+// 关闭窗口时先停止后台任务，避免任务访问已销毁的流程对象
+void Spray_GUI::closeEvent(QCloseEvent* event) {
+    cancelJobAndWait();
+    QMainWindow::closeEvent(event);
 }
 
 void Spray_GUI::updateAxes() {
@@ -10,6 +10,11 @@
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QTimer>
+#include <QProgressBar>
+#include <QLabel>
+#include <QThread>
+#include <QCloseEvent>
+#include <functional>
 #include <QVTKOpenGLNativeWidget.h>
 #include <vtkSmartPointer.h>
 #include <vtkPolyDataMapper.h>
@@ -21,6 +26,8 @@
 #include <vtkOrientationMarkerWidget.h>
 #include "VTKViewer.h"
 #include "OCCHandler.h"
+#include "SprayPipeline.h"
+#include "SprayProgress.h"
 
 // --- 新增的VTK头文件，用于路径显示 ---
 #include <vtkPoints.h>         // For path points
@@ -46,6 +53,9 @@ private:
     QPushButton* btnRotateZ;
     QPushButton* btnextractFaces;
     QPushButton* btnaddcutFaces; // 添加切割面
+    QPushButton* btnCancel;      // 取消当前任务
+    QProgressBar* progressBar;   // 当前任务进度
+    QLabel* statusLabel;         // 当前任务步骤
 
     QVTKOpenGLNativeWidget* vtkWidget;
     vtkSmartPointer<vtkGenericOpenGLRenderWindow> renderWindow;
@@ -63,15 +73,40 @@ private:
     vtkSmartPointer<vtkActor> m_nonSprayPathVTKActor; // 非喷涂路径可视化Actor
     // --- 结束新增 ---
     VTKViewer vtkViewer; // 添加VTKViewer成员
-    OCCHandler occHandler;
+    SprayPipeline pipeline; // 喷涂流程（持有模型处理器与路径处理器）
     // --- 新增的渲染选项 ---
     VTKViewer::RenderOptions defaultOptions; // 默认渲染选项
 
+    // --- 后台任务 ---
+    QThread* jobThread;                          // 正在运行的任务线程（空闲时为nullptr）
+    Handle(SprayProgressIndicator) jobProgress;  // 当前任务的进度与取消
+
     // std::set<vtkIdType> getVisibleCellIdsByHardwareSelector(vtkRenderWindow* renderWindow, vtkRenderer* renderer, vtkPolyData* polyData);
 
     void setupUI();
     void connectSignals();
     void updateAxes();
+
+    // 在工作线程中执行耗时任务（同一时间只运行一个）
+    // work: 在工作线程中执行，不得访问界面控件；返回是否成功
+    // finished: 在UI线程中执行，用于显示结果；任务被取消时不调用
+    void runJob(const QString& title,
+                const std::function<bool(const Message_ProgressRange&)>& work,
+                const std::function<void(bool success)>& finished);
+
+    // 任务运行期间禁用会修改流程状态的按钮
+    void setJobRunning(bool running);
+
+    // 请求取消当前任务并等待其结束
+    void cancelJobAndWait();
+
+    // 旋转模型并刷新显示
+    void rotateModel(const gp_Dir& axis);
+
+protected:
+    void closeEvent(QCloseEvent* event) override;
+
+private:
     // void resetCameraToShowActor(vtkRenderer* renderer, vtkActor* actor); // 添加重置相机视角方法
     // void showExportWindow(const std::set<vtkIdType>& filteredVisibleCellIds);
     // void previewVisibleFacesWithColorBar(const double viewDir[3], bool onlyColorBar, const std::set<vtkIdType>* externalVisibleCellIds = nullptr);
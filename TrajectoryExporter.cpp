@@ -0,0 +1,489 @@
+#include "TrajectoryExporter.h"
+#include "SprayLog.h"
+#include "SprayProfiler.h"
+#include <gp_Mat.hxx>
+#include <gp_Quaternion.hxx>
+#include <gp_EulerSequence.hxx>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+// 输出流缓冲区大小
+static const size_t EXPORT_BUFFER_SIZE = 1 << 20;
+
+// 二进制格式
+static const char BINARY_MAGIC[8] = { 'S', 'P', 'R', 'A', 'Y', 'T', 'R', 'J' };
+static const uint32_t BINARY_VERSION = 1;
+static const uint32_t BINARY_POINT_RECORD_SIZE = 3 * 8 + 3 * 4 + 1;
+static const std::streamoff BINARY_TRAJECTORY_COUNT_OFFSET = 16;
+static const std::streamoff BINARY_POINT_COUNT_OFFSET = 24;
+static const std::streamoff BINARY_TRAJECTORY_POINT_COUNT_OFFSET = 8;
+
+// 点记录的标志位
+static const uint8_t POINT_FLAG_SPRAY = 1;
+static const uint8_t POINT_FLAG_SEGMENT_START = 2;
+
+// 与类型大小相同的无符号整数
+template <size_t Size> struct UnsignedBits;
+template <> struct UnsignedBits<1> { using type = uint8_t; };
+template <> struct UnsignedBits<4> { using type = uint32_t; };
+template <> struct UnsignedBits<8> { using type = uint64_t; };
+
+// 按小端字节序写入（逐字节输出，与本机字节序无关）
+template <typename T>
+static void writeRaw(std::ostream& out, T value) {
+    using Bits = typename UnsignedBits<sizeof(T)>::type;
+    Bits bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    char bytes[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); i++) {
+        bytes[i] = static_cast<char>((bits >> (8 * i)) & 0xFF);
+    }
+    out.write(bytes, sizeof(T));
+}
+
+// 内置的通用模板
+TrajectoryTemplate TrajectoryTemplate::defaultTemplate() {
+    TrajectoryTemplate result;
+    result.header = "; PROGRAM {program}\n";
+    result.trajectory = "; TRAJECTORY {trajectory}\n";
+    result.segment = "; SEGMENT {segment}\n";
+    result.sprayOn = "SPRAY ON\n";
+    result.sprayOff = "SPRAY OFF\n";
+    result.point = "LIN X {x} Y {y} Z {z} A {a} B {b} C {c}\n";
+    result.trajectoryEnd = "";
+    result.footer = "END\n";
+    return result;
+}
+
+// 从文件读取模板
+bool TrajectoryTemplate::load(const std::string& filename, TrajectoryTemplate& result, std::string& error) {
+    std::ifstream file(filename);
+    if (!file) {
+        error = "无法打开模板文件: " + filename;
+        return false;
+    }
+
+    const std::pair<const char*, std::string TrajectoryTemplate::*> sections[] = {
+        {"[header]", &TrajectoryTemplate::header},       {"[trajectory]", &TrajectoryTemplate::trajectory},
+        {"[segment]", &TrajectoryTemplate::segment},     {"[spray_on]", &TrajectoryTemplate::sprayOn},
+        {"[spray_off]", &TrajectoryTemplate::sprayOff},  {"[point]", &TrajectoryTemplate::point},
+        {"[trajectory_end]", &TrajectoryTemplate::trajectoryEnd}, {"[footer]", &TrajectoryTemplate::footer}};
+
+    TrajectoryTemplate loaded;
+    std::string TrajectoryTemplate::*current = nullptr;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        if (!line.empty() && line[0] == '[') {
+            current = nullptr;
+            for (const auto& section : sections) {
+                if (line == section.first) {
+                    current = section.second;
+                }
+            }
+            if (!current) {
+                error = filename + ":" + std::to_string(lineNumber) + " 未知的模板节 " + line;
+                return false;
+            }
+            continue;
+        }
+
+        if (!current) {
+            if (line.empty()) continue;
+            error = filename + ":" + std::to_string(lineNumber) + " 文本不在任何模板节中";
+            return false;
+        }
+        (loaded.*current) += line + "\n";
+    }
+
+    result = loaded;
+    return true;
+}
+
+// 构造函数
+TrajectoryExporter::TrajectoryExporter()
+    : textTemplate(TrajectoryTemplate::defaultTemplate()), programName("SPRAY"), decimals(3),
+      format(TrajectoryExportFormat::Csv), inTrajectory(false), sprayOn(false), trajectoryIndex(0),
+      segmentIndex(-1), trajectoryPoints(0), trajectoryCount(0), pointCount(0), trajectoryHeaderOffset(0) {
+}
+
+// 析构函数
+TrajectoryExporter::~TrajectoryExporter() {
+    if (out.is_open()) {
+        close();
+    }
+}
+
+// 设置模板
+void TrajectoryExporter::setTemplate(const TrajectoryTemplate& textTemplate) {
+    this->textTemplate = textTemplate;
+}
+
+// 设置程序名
+void TrajectoryExporter::setProgramName(const std::string& name) {
+    programName = name;
+}
+
+// 设置模板输出的小数位数
+void TrajectoryExporter::setDecimals(int decimals) {
+    this->decimals = std::max(0, decimals);
+}
+
+// 按名称解析格式
+bool TrajectoryExporter::parseFormat(const std::string& name, TrajectoryExportFormat& format) {
+    if (name == "csv") {
+        format = TrajectoryExportFormat::Csv;
+    } else if (name == "binary") {
+        format = TrajectoryExportFormat::Binary;
+    } else if (name == "template") {
+        format = TrajectoryExportFormat::Template;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 格式对应的文件扩展名
+const char* TrajectoryExporter::fileExtension(TrajectoryExportFormat format) {
+    switch (format) {
+    case TrajectoryExportFormat::Binary:
+        return ".trj";
+    case TrajectoryExportFormat::Template:
+        return ".txt";
+    default:
+        return ".csv";
+    }
+}
+
+// 由表面法向量计算工具姿态
+void TrajectoryExporter::toolOrientation(const gp_Dir& normal, double euler[3], double quaternion[4]) {
+    // 工具Z轴指向表面；X轴取世界X轴（与Z轴接近平行时取世界Y轴）在垂直平面上的投影
+    const gp_XYZ toolZ = normal.Reversed().XYZ();
+    const gp_XYZ reference = std::abs(toolZ.X()) < 0.99 ? gp_XYZ(1, 0, 0) : gp_XYZ(0, 1, 0);
+    const gp_XYZ toolY = toolZ.Crossed(reference).Normalized();
+    const gp_XYZ toolX = toolY.Crossed(toolZ);
+
+    gp_Quaternion rotation(gp_Mat(toolX, toolY, toolZ));
+    double a, b, c;
+    rotation.GetEulerAngles(gp_Intrinsic_ZYX, a, b, c);
+    const double toDegrees = 180.0 / M_PI;
+    euler[0] = a * toDegrees;
+    euler[1] = b * toDegrees;
+    euler[2] = c * toDegrees;
+    quaternion[0] = rotation.W();
+    quaternion[1] = rotation.X();
+    quaternion[2] = rotation.Y();
+    quaternion[3] = rotation.Z();
+}
+
+// 将模板节拆分为片段
+bool TrajectoryExporter::compileSection(const std::string& section, std::vector<Token>& tokens, std::string& error) {
+    static const std::pair<const char*, Field> fields[] = {
+        {"program", Program}, {"trajectory", TrajectoryNumber}, {"segment", SegmentNumber}, {"index", Index},
+        {"line", Line}, {"x", X}, {"y", Y}, {"z", Z}, {"nx", NX}, {"ny", NY}, {"nz", NZ}, {"spray", Spray},
+        {"a", A}, {"b", B}, {"c", C}, {"qw", QW}, {"qx", QX}, {"qy", QY}, {"qz", QZ}};
+
+    tokens.clear();
+    size_t position = 0;
+    while (position < section.size()) {
+        size_t open = section.find('{', position);
+        size_t close = open == std::string::npos ? std::string::npos : section.find('}', open);
+        if (close == std::string::npos) {
+            tokens.push_back({Literal, section.substr(position)});
+            break;
+        }
+        if (open > position) {
+            tokens.push_back({Literal, section.substr(position, open - position)});
+        }
+
+        const std::string name = section.substr(open + 1, close - open - 1);
+        auto it = std::find_if(std::begin(fields), std::end(fields),
+                               [&name](const std::pair<const char*, Field>& field) { return name == field.first; });
+        if (it == std::end(fields)) {
+            error = "未知的模板字段 {" + name + "}";
+            return false;
+        }
+        tokens.push_back({it->second, std::string()});
+        position = close + 1;
+    }
+    return true;
+}
+
+// 检查模板中的占位符
+bool TrajectoryExporter::validateTemplate(const TrajectoryTemplate& textTemplate, std::string& error) {
+    const std::string* sections[] = {
+        &textTemplate.header, &textTemplate.trajectory, &textTemplate.segment, &textTemplate.sprayOn,
+        &textTemplate.sprayOff, &textTemplate.point, &textTemplate.trajectoryEnd, &textTemplate.footer};
+    std::vector<Token> tokens;
+    for (const std::string* section : sections) {
+        if (!compileSection(*section, tokens, error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 打开输出文件
+bool TrajectoryExporter::open(const std::string& filename, TrajectoryExportFormat format) {
+    if (out.is_open()) {
+        close();
+    }
+
+    if (format == TrajectoryExportFormat::Template) {
+        std::string error;
+        const std::pair<const std::string*, std::vector<Token>*> sections[] = {
+            {&textTemplate.header, &headerTokens},     {&textTemplate.trajectory, &trajectoryTokens},
+            {&textTemplate.segment, &segmentTokens},   {&textTemplate.sprayOn, &sprayOnTokens},
+            {&textTemplate.sprayOff, &sprayOffTokens}, {&textTemplate.point, &pointTokens},
+            {&textTemplate.trajectoryEnd, &trajectoryEndTokens}, {&textTemplate.footer, &footerTokens}};
+        for (const auto& section : sections) {
+            if (!compileSection(*section.first, *section.second, error)) {
+                SPRAY_LOG_ERROR << "❌ 轨迹模板无效: " << error;
+                return false;
+            }
+        }
+    }
+
+    // 缓冲区必须在打开文件之前设置
+    buffer.resize(EXPORT_BUFFER_SIZE);
+    out.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.open(filename, format == TrajectoryExportFormat::Binary ? std::ios::binary | std::ios::out : std::ios::out);
+    if (!out) {
+        SPRAY_LOG_ERROR << "❌ 无法创建轨迹文件: " << filename;
+        return false;
+    }
+
+    this->format = format;
+    inTrajectory = false;
+    trajectoryCount = 0;
+    pointCount = 0;
+
+    switch (format) {
+    case TrajectoryExportFormat::Csv:
+        out << "trajectory,point,x,y,z,nx,ny,nz,spray,segment,a,b,c\n";
+        out << std::setprecision(9);
+        break;
+    case TrajectoryExportFormat::Binary:
+        out.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        writeRaw<uint32_t>(out, BINARY_VERSION);
+        writeRaw<uint32_t>(out, BINARY_POINT_RECORD_SIZE);
+        writeRaw<uint64_t>(out, 0);  // 轨迹数，关闭时回填
+        writeRaw<uint64_t>(out, 0);  // 点数，关闭时回填
+        break;
+    case TrajectoryExportFormat::Template:
+        out << std::fixed << std::setprecision(decimals);
+        emit(headerTokens, nullptr);
+        break;
+    }
+    return static_cast<bool>(out);
+}
+
+// 开始一条轨迹
+bool TrajectoryExporter::beginTrajectory(int trajectoryIndex) {
+    if (!out.is_open()) {
+        return false;
+    }
+    if (inTrajectory) {
+        endTrajectory();
+    }
+
+    inTrajectory = true;
+    sprayOn = false;
+    this->trajectoryIndex = trajectoryIndex;
+    segmentIndex = -1;
+    trajectoryPoints = 0;
+
+    if (format == TrajectoryExportFormat::Binary) {
+        trajectoryHeaderOffset = static_cast<std::streamoff>(out.tellp());
+        writeRaw<int32_t>(out, trajectoryIndex);
+        writeRaw<uint32_t>(out, 0);
+        writeRaw<uint64_t>(out, 0);  // 点数，轨迹结束时回填
+    } else if (format == TrajectoryExportFormat::Template) {
+        emit(trajectoryTokens, nullptr);
+    }
+    return static_cast<bool>(out);
+}
+
+// 写入一个点
+bool TrajectoryExporter::writePoint(const PathPoint& point, bool segmentStart) {
+    if (!inTrajectory) {
+        return false;
+    }
+    if (segmentStart || segmentIndex < 0) {
+        segmentIndex++;
+    }
+
+    switch (format) {
+    case TrajectoryExportFormat::Csv: {
+        double euler[3], quaternion[4];
+        toolOrientation(point.normal, euler, quaternion);
+        out << trajectoryIndex << ',' << trajectoryPoints << ','
+            << point.position.X() << ',' << point.position.Y() << ',' << point.position.Z() << ','
+            << point.normal.X() << ',' << point.normal.Y() << ',' << point.normal.Z() << ','
+            << (point.isSprayPoint ? 1 : 0) << ',' << segmentIndex << ','
+            << euler[0] << ',' << euler[1] << ',' << euler[2] << '\n';
+        break;
+    }
+    case TrajectoryExportFormat::Binary: {
+        writeRaw<double>(out, point.position.X());
+        writeRaw<double>(out, point.position.Y());
+        writeRaw<double>(out, point.position.Z());
+        writeRaw<float>(out, static_cast<float>(point.normal.X()));
+        writeRaw<float>(out, static_cast<float>(point.normal.Y()));
+        writeRaw<float>(out, static_cast<float>(point.normal.Z()));
+        uint8_t flags = 0;
+        if (point.isSprayPoint) flags |= POINT_FLAG_SPRAY;
+        if (segmentStart) flags |= POINT_FLAG_SEGMENT_START;
+        writeRaw<uint8_t>(out, flags);
+        break;
+    }
+    case TrajectoryExportFormat::Template:
+        if (segmentStart) {
+            emit(segmentTokens, &point);
+        }
+        if (point.isSprayPoint != sprayOn) {
+            sprayOn = point.isSprayPoint;
+            emit(sprayOn ? sprayOnTokens : sprayOffTokens, &point);
+        }
+        emit(pointTokens, &point);
+        break;
+    }
+
+    trajectoryPoints++;
+    pointCount++;
+    return static_cast<bool>(out);
+}
+
+// 结束当前轨迹
+bool TrajectoryExporter::endTrajectory() {
+    if (!inTrajectory) {
+        return false;
+    }
+    inTrajectory = false;
+    trajectoryCount++;
+
+    if (format == TrajectoryExportFormat::Binary) {
+        patchCount(trajectoryHeaderOffset + BINARY_TRAJECTORY_POINT_COUNT_OFFSET, trajectoryPoints);
+    } else if (format == TrajectoryExportFormat::Template) {
+        if (sprayOn) {
+            sprayOn = false;
+            emit(sprayOffTokens, nullptr);
+        }
+        emit(trajectoryEndTokens, nullptr);
+    }
+    return static_cast<bool>(out);
+}
+
+// 写入整条轨迹
+bool TrajectoryExporter::writeTrajectory(const IntegratedTrajectory& trajectory) {
+    SPRAY_PROFILE_SCOPE("export.trajectory");
+
+    if (!beginTrajectory(trajectory.trajectoryIndex)) {
+        return false;
+    }
+
+    // pathSegments按升序记录各路径段的起点（空路径段可能与下一段重合）
+    size_t nextSegment = 0;
+    for (size_t i = 0; i < trajectory.points.size(); i++) {
+        bool segmentStart = false;
+        while (nextSegment < trajectory.pathSegments.size() &&
+               trajectory.pathSegments[nextSegment] <= static_cast<int>(i)) {
+            segmentStart = true;
+            nextSegment++;
+        }
+        if (!writePoint(trajectory.points[i], segmentStart)) {
+            return false;
+        }
+    }
+    return endTrajectory();
+}
+
+// 写入文件结尾并关闭
+bool TrajectoryExporter::close() {
+    if (!out.is_open()) {
+        return false;
+    }
+    if (inTrajectory) {
+        endTrajectory();
+    }
+
+    if (format == TrajectoryExportFormat::Binary) {
+        patchCount(BINARY_TRAJECTORY_COUNT_OFFSET, trajectoryCount);
+        patchCount(BINARY_POINT_COUNT_OFFSET, pointCount);
+    } else if (format == TrajectoryExportFormat::Template) {
+        emit(footerTokens, nullptr);
+    }
+
+    out.flush();
+    const bool success = static_cast<bool>(out);
+    out.close();
+    SPRAY_COUNTER_ADD("export.points", static_cast<long long>(pointCount));
+    return success;
+}
+
+// 已写入的点数
+uint64_t TrajectoryExporter::getPointCount() const {
+    return pointCount;
+}
+
+// 写入二进制计数（回填后回到文件末尾继续写）
+void TrajectoryExporter::patchCount(std::streamoff position, uint64_t count) {
+    const std::streampos end = out.tellp();
+    out.seekp(position);
+    writeRaw<uint64_t>(out, count);
+    out.seekp(end);
+}
+
+// 输出模板节
+void TrajectoryExporter::emit(const std::vector<Token>& tokens, const PathPoint* point) {
+    double euler[3] = { 0.0, 0.0, 0.0 };
+    double quaternion[4] = { 1.0, 0.0, 0.0, 0.0 };
+    bool orientationReady = false;
+
+    for (const Token& token : tokens) {
+        if (token.field == Literal) {
+            out << token.text;
+            continue;
+        }
+        switch (token.field) {
+        case Program: out << programName; continue;
+        case TrajectoryNumber: out << trajectoryIndex; continue;
+        case SegmentNumber: out << std::max(segmentIndex, 0); continue;
+        case Index: out << trajectoryPoints; continue;
+        case Line: out << pointCount; continue;
+        default: break;
+        }
+
+        // 以下字段需要点数据，不在点相关的节中时留空
+        if (!point) {
+            continue;
+        }
+        if (!orientationReady && token.field >= A) {
+            toolOrientation(point->normal, euler, quaternion);
+            orientationReady = true;
+        }
+        switch (token.field) {
+        case X: out << point->position.X(); break;
+        case Y: out << point->position.Y(); break;
+        case Z: out << point->position.Z(); break;
+        case NX: out << point->normal.X(); break;
+        case NY: out << point->normal.Y(); break;
+        case NZ: out << point->normal.Z(); break;
+        case Spray: out << (point->isSprayPoint ? 1 : 0); break;
+        case A: out << euler[0]; break;
+        case B: out << euler[1]; break;
+        case C: out << euler[2]; break;
+        case QW: out << quaternion[0]; break;
+        case QX: out << quaternion[1]; break;
+        case QY: out << quaternion[2]; break;
+        case QZ: out << quaternion[3]; break;
+        default: break;
+        }
+    }
+}
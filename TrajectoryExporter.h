@@ -0,0 +1,140 @@
+#pragma once
+
+#include "FaceProcessor.h"
+#include <gp_Dir.hxx>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// 轨迹导出格式
+enum class TrajectoryExportFormat {
+    Csv,       // 逗号分隔文本，每行一个点
+    Binary,    // 紧凑二进制（小端）
+    Template   // 按文本模板生成的机器人程序
+};
+
+// 机器人程序文本模板
+//
+// 模板文件按节书写，每节以单独一行的节名开始：
+//   [header] [trajectory] [segment] [spray_on] [spray_off] [point] [trajectory_end] [footer]
+// 节内的文本原样输出，{name} 形式的占位符替换为字段值：
+//   {program} 程序名   {trajectory} 轨迹序号   {segment} 路径段序号   {index} 轨迹内点序号   {line} 全局点序号
+//   {x} {y} {z} 位置   {nx} {ny} {nz} 表面法向量   {spray} 是否喷涂（1/0）
+//   {a} {b} {c} 工具姿态（ZYX欧拉角，度）   {qw} {qx} {qy} {qz} 工具姿态四元数
+// 工具坐标系的Z轴指向表面（与点的法向量相反），X轴取世界X轴在垂直平面上的投影。
+// [spray_on]/[spray_off] 在点的喷涂状态切换时、该点之前输出；轨迹结束时喷枪仍开启则输出 [spray_off]。
+struct TrajectoryTemplate {
+    std::string header;         // 文件开头
+    std::string trajectory;     // 每条轨迹开始
+    std::string segment;        // 每个路径段开始
+    std::string sprayOn;        // 开启喷枪
+    std::string sprayOff;       // 关闭喷枪
+    std::string point;          // 每个点
+    std::string trajectoryEnd;  // 每条轨迹结束
+    std::string footer;         // 文件结尾
+
+    // 内置的通用模板（直线运动指令 + 喷枪开关）
+    static TrajectoryTemplate defaultTemplate();
+
+    // 从文件读取模板
+    static bool load(const std::string& filename, TrajectoryTemplate& result, std::string& error);
+};
+
+// 轨迹流式导出
+//
+// 点逐个写入带缓冲的文件流，不在内存中组装整个文件，百万点的程序也只占用固定大小的缓冲区。
+// 用法：open() → 对每条轨迹 writeTrajectory()（或 beginTrajectory()/writePoint()/endTrajectory()）→ close()。
+//
+// 二进制格式（小端，字段紧密排列）：
+//   文件头32字节：  char[8] "SPRAYTRJ" | uint32 版本(1) | uint32 点记录字节数(37) | uint64 轨迹数 | uint64 点数
+//   轨迹头16字节：  int32 轨迹序号 | uint32 保留(0) | uint64 点数
+//   点记录37字节：  float64 x,y,z | float32 nx,ny,nz | uint8 标志（bit0 喷涂，bit1 路径段起点）
+// 轨迹头和文件头中的计数在轨迹结束和关闭文件时回填。
+class TrajectoryExporter {
+public:
+    TrajectoryExporter();
+    ~TrajectoryExporter();
+
+    // 设置模板（Template格式使用，默认为内置模板）
+    void setTemplate(const TrajectoryTemplate& textTemplate);
+
+    // 设置程序名（模板中的 {program}）
+    void setProgramName(const std::string& name);
+
+    // 设置模板输出的小数位数（默认3）
+    void setDecimals(int decimals);
+
+    // 打开输出文件
+    bool open(const std::string& filename, TrajectoryExportFormat format);
+
+    // 开始一条轨迹
+    bool beginTrajectory(int trajectoryIndex);
+
+    // 写入一个点（segmentStart表示该点是一个路径段的起点）
+    bool writePoint(const PathPoint& point, bool segmentStart);
+
+    // 结束当前轨迹
+    bool endTrajectory();
+
+    // 写入整条轨迹（路径段起点取自pathSegments）
+    bool writeTrajectory(const IntegratedTrajectory& trajectory);
+
+    // 写入文件结尾并关闭，返回全部写入是否成功
+    bool close();
+
+    // 已写入的点数
+    uint64_t getPointCount() const;
+
+    // 按名称解析格式（csv/binary/template）
+    static bool parseFormat(const std::string& name, TrajectoryExportFormat& format);
+
+    // 格式对应的文件扩展名
+    static const char* fileExtension(TrajectoryExportFormat format);
+
+    // 检查模板中的占位符，遇到未知字段时返回false（open()时同样会检查）
+    static bool validateTemplate(const TrajectoryTemplate& textTemplate, std::string& error);
+
+    // 由表面法向量计算工具姿态：ZYX欧拉角（度）与四元数（w, x, y, z）
+    static void toolOrientation(const gp_Dir& normal, double euler[3], double quaternion[4]);
+
+private:
+    // 模板字段
+    enum Field {
+        Literal, Program, TrajectoryNumber, SegmentNumber, Index, Line,
+        X, Y, Z, NX, NY, NZ, Spray, A, B, C, QW, QX, QY, QZ
+    };
+
+    // 模板片段（原样文本或字段）
+    struct Token {
+        Field field;
+        std::string text;
+    };
+
+    // 将模板节拆分为片段，遇到未知字段时返回false
+    static bool compileSection(const std::string& section, std::vector<Token>& tokens, std::string& error);
+
+    // 输出模板节
+    void emit(const std::vector<Token>& tokens, const PathPoint* point);
+
+    // 写入二进制计数（回填）
+    void patchCount(std::streamoff position, uint64_t count);
+
+    TrajectoryTemplate textTemplate;        // 文本模板
+    std::vector<Token> headerTokens, trajectoryTokens, segmentTokens, sprayOnTokens, sprayOffTokens,
+        pointTokens, trajectoryEndTokens, footerTokens;  // 编译后的模板节
+    std::string programName;                // 程序名
+    int decimals;                           // 模板小数位数
+
+    std::ofstream out;                      // 输出流
+    std::vector<char> buffer;               // 输出流缓冲区
+    TrajectoryExportFormat format;          // 当前格式
+    bool inTrajectory;                      // 是否在轨迹中
+    bool sprayOn;                           // 模板输出的喷枪状态
+    int trajectoryIndex;                    // 当前轨迹序号
+    int segmentIndex;                       // 当前路径段序号
+    uint64_t trajectoryPoints;              // 当前轨迹已写入的点数
+    uint64_t trajectoryCount;               // 已写入的轨迹数
+    uint64_t pointCount;                    // 已写入的点数
+    std::streamoff trajectoryHeaderOffset;  // 当前轨迹头在文件中的位置（二进制）
+};
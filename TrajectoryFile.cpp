@@ -0,0 +1,582 @@
+#include "TrajectoryFile.h"
+#include "SprayLog.h"
+#include "SprayProfiler.h"
+#include <gp_Vec.hxx>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// 文件按小端存放，读取时直接映射不做转换，只支持小端平台（MSVC的目标平台均为小端）
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "TrajectoryFile requires a little-endian platform"
+#endif
+
+// 文件标识与版本
+static const char TRAJECTORY_FILE_MAGIC[8] = { 'S', 'P', 'R', 'A', 'Y', 'S', 'T', 'F' };
+static const uint32_t TRAJECTORY_FILE_VERSION = 1;
+
+// 点块的列数（x y z nx ny nz spray）与每个点的字节数
+static const int POINT_COLUMNS = 7;
+static const size_t POINT_RECORD_BYTES = 3 * sizeof(double) + 3 * sizeof(float) + sizeof(uint8_t);
+
+// 未压缩点块中各列的起始位置
+static void columnOffsets(size_t count, size_t offsets[POINT_COLUMNS]) {
+    offsets[0] = 0;
+    offsets[1] = count * 8;
+    offsets[2] = count * 16;
+    offsets[3] = count * 24;
+    offsets[4] = count * 28;
+    offsets[5] = count * 32;
+    offsets[6] = count * 36;
+}
+
+// 压缩一列：与前一个值按位异或，写1字节高位零字节数和其余低位字节
+template <typename Bits>
+static void encodeColumn(const unsigned char* column, size_t count, std::vector<unsigned char>& out) {
+    Bits previous = 0;
+    for (size_t i = 0; i < count; i++) {
+        Bits value;
+        std::memcpy(&value, column + i * sizeof(Bits), sizeof(Bits));
+        const Bits delta = value ^ previous;
+        previous = value;
+
+        int zeroBytes = 0;
+        while (zeroBytes < static_cast<int>(sizeof(Bits)) &&
+               ((delta >> (8 * (sizeof(Bits) - 1 - zeroBytes))) & 0xFF) == 0) {
+            zeroBytes++;
+        }
+        out.push_back(static_cast<unsigned char>(zeroBytes));
+        for (int b = 0; b < static_cast<int>(sizeof(Bits)) - zeroBytes; b++) {
+            out.push_back(static_cast<unsigned char>((delta >> (8 * b)) & 0xFF));
+        }
+    }
+}
+
+// 解压一列，数据不完整时返回false
+template <typename Bits>
+static bool decodeColumn(const unsigned char* input, size_t inputBytes, size_t count, unsigned char* column) {
+    const unsigned char* end = input + inputBytes;
+    Bits previous = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (input >= end) {
+            return false;
+        }
+        const int zeroBytes = *input++;
+        const int byteCount = static_cast<int>(sizeof(Bits)) - zeroBytes;
+        if (byteCount < 0 || end - input < byteCount) {
+            return false;
+        }
+        Bits delta = 0;
+        for (int b = 0; b < byteCount; b++) {
+            delta |= static_cast<Bits>(input[b]) << (8 * b);
+        }
+        input += byteCount;
+        previous ^= delta;
+        std::memcpy(column + i * sizeof(Bits), &previous, sizeof(Bits));
+    }
+    return input == end;
+}
+
+// 构造函数
+TrajectoryFileWriter::TrajectoryFileWriter(bool compress) : compress(compress) {
+}
+
+// 析构函数（未完成的文件丢弃）
+TrajectoryFileWriter::~TrajectoryFileWriter() {
+    if (out.is_open()) {
+        out.close();
+        std::error_code ec;
+        fs::remove(fs::u8path(tempFilename), ec);
+    }
+}
+
+// 创建文件
+bool TrajectoryFileWriter::open(const std::string& filename) {
+    this->filename = filename;
+    tempFilename = filename + ".tmp";
+    entries.clear();
+
+    out.open(fs::u8path(tempFilename), std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!out) {
+        SPRAY_LOG_ERROR << "❌ 无法创建喷涂程序文件: " << filename;
+        return false;
+    }
+
+    // 文件头在close时写入
+    TrajectoryFileHeader header = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return static_cast<bool>(out);
+}
+
+// 补齐到8字节
+void TrajectoryFileWriter::pad() {
+    static const char zeros[8] = {};
+    const std::streamoff position = out.tellp();
+    if (position % 8 != 0) {
+        out.write(zeros, 8 - position % 8);
+    }
+}
+
+// 写入点块与附加数组，并登记索引项
+bool TrajectoryFileWriter::writeRecord(TrajectoryFileEntry entry, const std::vector<PathPoint>* points,
+                                       const std::vector<int>* aux) {
+    if (!out.is_open()) {
+        return false;
+    }
+
+    const size_t count = points ? points->size() : 0;
+    entry.pointCount = count;
+    if (count > 0) {
+        // 先按列组装未压缩的点块
+        size_t offsets[POINT_COLUMNS];
+        columnOffsets(count, offsets);
+        scratch.resize(count * POINT_RECORD_BYTES);
+        unsigned char* block = scratch.data();
+        for (size_t i = 0; i < count; i++) {
+            const PathPoint& point = (*points)[i];
+            const double position[3] = { point.position.X(), point.position.Y(), point.position.Z() };
+            const float normal[3] = { static_cast<float>(point.normal.X()), static_cast<float>(point.normal.Y()),
+                                      static_cast<float>(point.normal.Z()) };
+            for (int axis = 0; axis < 3; axis++) {
+                std::memcpy(block + offsets[axis] + i * sizeof(double), &position[axis], sizeof(double));
+                std::memcpy(block + offsets[3 + axis] + i * sizeof(float), &normal[axis], sizeof(float));
+            }
+            block[offsets[6] + i] = point.isSprayPoint ? 1 : 0;
+        }
+
+        std::vector<unsigned char> encoded;
+        if (compress) {
+            encoded.resize(POINT_COLUMNS * sizeof(uint64_t));
+            uint64_t columnBytes[POINT_COLUMNS];
+            for (int column = 0; column < POINT_COLUMNS; column++) {
+                const size_t before = encoded.size();
+                if (column < 3) {
+                    encodeColumn<uint64_t>(block + offsets[column], count, encoded);
+                } else if (column < 6) {
+                    encodeColumn<uint32_t>(block + offsets[column], count, encoded);
+                } else {
+                    encoded.insert(encoded.end(), block + offsets[column], block + offsets[column] + count);
+                }
+                columnBytes[column] = encoded.size() - before;
+            }
+            std::memcpy(encoded.data(), columnBytes, sizeof(columnBytes));
+        }
+
+        entry.pointOffset = static_cast<uint64_t>(out.tellp());
+        if (compress && encoded.size() < scratch.size()) {
+            entry.flags |= TRAJECTORY_ENTRY_COMPRESSED;
+            entry.pointBytes = encoded.size();
+            out.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+        } else {
+            entry.pointBytes = scratch.size();
+            out.write(reinterpret_cast<const char*>(scratch.data()), static_cast<std::streamsize>(scratch.size()));
+        }
+        pad();
+    }
+
+    if (aux && !aux->empty()) {
+        entry.auxOffset = static_cast<uint64_t>(out.tellp());
+        entry.auxCount = aux->size();
+        for (int value : *aux) {
+            const int32_t stored = static_cast<int32_t>(value);
+            out.write(reinterpret_cast<const char*>(&stored), sizeof(stored));
+        }
+        pad();
+    }
+
+    entries.push_back(entry);
+    return static_cast<bool>(out);
+}
+
+// 写入路径
+bool TrajectoryFileWriter::writePath(const SprayPath& path) {
+    TrajectoryFileEntry entry = {};
+    entry.kind = static_cast<uint32_t>(TrajectoryRecordKind::Path);
+    entry.id = path.pathIndex;
+    entry.group = path.planeIndex;
+    entry.flags = path.isConnected ? TRAJECTORY_ENTRY_CONNECTED : 0;
+    entry.value = path.width;
+    return writeRecord(entry, &path.points, nullptr);
+}
+
+// 写入整合轨迹
+bool TrajectoryFileWriter::writeTrajectory(const IntegratedTrajectory& trajectory) {
+    TrajectoryFileEntry entry = {};
+    entry.kind = static_cast<uint32_t>(TrajectoryRecordKind::Trajectory);
+    entry.id = trajectory.trajectoryIndex;
+    entry.group = -1;
+    entry.value = trajectory.totalLength;
+    return writeRecord(entry, &trajectory.points, &trajectory.pathSegments);
+}
+
+// 写入表面层级
+bool TrajectoryFileWriter::writeSurfaceLayer(const SurfaceLayer& layer) {
+    TrajectoryFileEntry entry = {};
+    entry.kind = static_cast<uint32_t>(TrajectoryRecordKind::SurfaceLayer);
+    entry.id = layer.layerIndex;
+    entry.group = -1;
+    entry.value = layer.averageDepth;
+    return writeRecord(entry, nullptr, &layer.pathIndices);
+}
+
+// 写入索引并完成文件
+bool TrajectoryFileWriter::close() {
+    if (!out.is_open()) {
+        return false;
+    }
+    SPRAY_PROFILE_SCOPE("trajectoryFile.write");
+
+    pad();
+    TrajectoryFileHeader header = {};
+    std::memcpy(header.magic, TRAJECTORY_FILE_MAGIC, sizeof(header.magic));
+    header.version = TRAJECTORY_FILE_VERSION;
+    header.entrySize = sizeof(TrajectoryFileEntry);
+    header.entryCount = entries.size();
+    header.indexOffset = static_cast<uint64_t>(out.tellp());
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              static_cast<std::streamsize>(entries.size() * sizeof(TrajectoryFileEntry)));
+    header.fileSize = static_cast<uint64_t>(out.tellp());
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+
+    std::error_code ec;
+    bool written = static_cast<bool>(out);
+    if (written) {
+        fs::rename(fs::u8path(tempFilename), fs::u8path(filename), ec);
+        written = !ec;
+    }
+    if (!written) {
+        fs::remove(fs::u8path(tempFilename), ec);
+        SPRAY_LOG_ERROR << "❌ 写入喷涂程序文件失败: " << filename;
+    }
+    return written;
+}
+
+// 构造函数
+TrajectoryFileReader::TrajectoryFileReader()
+    : data(nullptr), size(0), entries(nullptr), entryCount(0),
+#ifdef _WIN32
+      fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#else
+      fileDescriptor(-1)
+#endif
+{
+}
+
+// 析构函数
+TrajectoryFileReader::~TrajectoryFileReader() {
+    close();
+}
+
+// 映射文件并校验文件头与索引
+bool TrajectoryFileReader::open(const std::string& filename) {
+    close();
+
+#ifdef _WIN32
+    fileHandle = CreateFileW(fs::u8path(filename).wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER fileSize;
+    if (fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(fileHandle, &fileSize)) {
+        SPRAY_LOG_ERROR << "❌ 无法打开喷涂程序文件: " << filename;
+        close();
+        return false;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+    if (size >= sizeof(TrajectoryFileHeader)) {
+        mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle) {
+            data = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        }
+    }
+#else
+    fileDescriptor = ::open(filename.c_str(), O_RDONLY);
+    struct stat fileStat;
+    if (fileDescriptor < 0 || fstat(fileDescriptor, &fileStat) != 0) {
+        SPRAY_LOG_ERROR << "❌ 无法打开喷涂程序文件: " << filename;
+        close();
+        return false;
+    }
+    size = static_cast<size_t>(fileStat.st_size);
+    if (size >= sizeof(TrajectoryFileHeader)) {
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (mapped != MAP_FAILED) {
+            data = static_cast<const unsigned char*>(mapped);
+        }
+    }
+#endif
+
+    if (!data) {
+        SPRAY_LOG_ERROR << "❌ 无法映射喷涂程序文件: " << filename;
+        close();
+        return false;
+    }
+
+    // 校验文件头与索引范围（点块与附加数组在访问时校验）
+    const TrajectoryFileHeader* header = reinterpret_cast<const TrajectoryFileHeader*>(data);
+    const bool valid = std::memcmp(header->magic, TRAJECTORY_FILE_MAGIC, sizeof(header->magic)) == 0 &&
+                       header->version == TRAJECTORY_FILE_VERSION &&
+                       header->entrySize == sizeof(TrajectoryFileEntry) &&
+                       header->fileSize == size &&
+                       header->indexOffset % 8 == 0 &&
+                       header->indexOffset <= size &&
+                       header->entryCount <= (size - header->indexOffset) / sizeof(TrajectoryFileEntry);
+    if (!valid) {
+        SPRAY_LOG_ERROR << "❌ 喷涂程序文件格式无效或版本不支持: " << filename;
+        close();
+        return false;
+    }
+
+    entries = reinterpret_cast<const TrajectoryFileEntry*>(data + header->indexOffset);
+    entryCount = static_cast<size_t>(header->entryCount);
+    return true;
+}
+
+// 解除映射
+void TrajectoryFileReader::close() {
+#ifdef _WIN32
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (data) {
+        munmap(const_cast<unsigned char*>(data), size);
+    }
+    if (fileDescriptor >= 0) {
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+#endif
+    data = nullptr;
+    size = 0;
+    entries = nullptr;
+    entryCount = 0;
+}
+
+// 是否已打开
+bool TrajectoryFileReader::isOpen() const {
+    return data != nullptr;
+}
+
+// 记录数
+size_t TrajectoryFileReader::getRecordCount() const {
+    return entryCount;
+}
+
+// 索引项（超出范围时返回nullptr）
+const TrajectoryFileEntry* TrajectoryFileReader::getEntry(size_t record) const {
+    if (record >= entryCount) {
+        return nullptr;
+    }
+    return &entries[record];
+}
+
+// 点块视图
+bool TrajectoryFileReader::getPoints(size_t record, TrajectoryPointsView& view,
+                                     std::vector<unsigned char>& scratch) const {
+    if (record >= entryCount) {
+        return false;
+    }
+    const TrajectoryFileEntry& entry = entries[record];
+    view = TrajectoryPointsView();
+    if (entry.pointCount == 0) {
+        return true;
+    }
+    if (entry.pointOffset % 8 != 0 || entry.pointOffset > size || entry.pointBytes > size - entry.pointOffset ||
+        entry.pointCount > size / 4) {
+        return false;
+    }
+
+    const size_t count = static_cast<size_t>(entry.pointCount);
+    const unsigned char* block = data + entry.pointOffset;
+    if (entry.flags & TRAJECTORY_ENTRY_COMPRESSED) {
+        // 解码为未压缩的列布局
+        const size_t headerBytes = POINT_COLUMNS * sizeof(uint64_t);
+        if (entry.pointBytes < headerBytes) {
+            return false;
+        }
+        uint64_t columnBytes[POINT_COLUMNS];
+        std::memcpy(columnBytes, block, sizeof(columnBytes));
+        size_t offsets[POINT_COLUMNS];
+        columnOffsets(count, offsets);
+        scratch.resize(count * POINT_RECORD_BYTES);
+
+        const unsigned char* input = block + headerBytes;
+        uint64_t remaining = entry.pointBytes - headerBytes;
+        for (int column = 0; column < POINT_COLUMNS; column++) {
+            if (columnBytes[column] > remaining) {
+                return false;
+            }
+            const size_t bytes = static_cast<size_t>(columnBytes[column]);
+            bool decoded;
+            if (column < 3) {
+                decoded = decodeColumn<uint64_t>(input, bytes, count, scratch.data() + offsets[column]);
+            } else if (column < 6) {
+                decoded = decodeColumn<uint32_t>(input, bytes, count, scratch.data() + offsets[column]);
+            } else {
+                decoded = bytes == count;
+                if (decoded) {
+                    std::memcpy(scratch.data() + offsets[column], input, count);
+                }
+            }
+            if (!decoded) {
+                return false;
+            }
+            input += bytes;
+            remaining -= bytes;
+        }
+        block = scratch.data();
+    } else if (entry.pointBytes < count * POINT_RECORD_BYTES) {
+        return false;
+    }
+
+    size_t offsets[POINT_COLUMNS];
+    columnOffsets(count, offsets);
+    view.count = count;
+    view.x = reinterpret_cast<const double*>(block + offsets[0]);
+    view.y = reinterpret_cast<const double*>(block + offsets[1]);
+    view.z = reinterpret_cast<const double*>(block + offsets[2]);
+    view.nx = reinterpret_cast<const float*>(block + offsets[3]);
+    view.ny = reinterpret_cast<const float*>(block + offsets[4]);
+    view.nz = reinterpret_cast<const float*>(block + offsets[5]);
+    view.spray = block + offsets[6];
+    return true;
+}
+
+// 附加数组
+bool TrajectoryFileReader::getAux(size_t record, const int32_t*& values, size_t& count) const {
+    values = nullptr;
+    count = 0;
+    if (record >= entryCount) {
+        return false;
+    }
+    const TrajectoryFileEntry& entry = entries[record];
+    if (entry.auxCount == 0) {
+        return true;
+    }
+    if (entry.auxOffset % 4 != 0 || entry.auxOffset > size ||
+        entry.auxCount > (size - entry.auxOffset) / sizeof(int32_t)) {
+        return false;
+    }
+    values = reinterpret_cast<const int32_t*>(data + entry.auxOffset);
+    count = static_cast<size_t>(entry.auxCount);
+    return true;
+}
+
+// 读取点并复制为PathPoint数组
+bool TrajectoryFileReader::readPoints(size_t record, std::vector<PathPoint>& points) const {
+    TrajectoryPointsView view;
+    std::vector<unsigned char> scratch;
+    if (!getPoints(record, view, scratch)) {
+        return false;
+    }
+    points.clear();
+    points.reserve(view.count);
+    for (size_t i = 0; i < view.count; i++) {
+        gp_Vec normal(view.nx[i], view.ny[i], view.nz[i]);
+        points.emplace_back(gp_Pnt(view.x[i], view.y[i], view.z[i]),
+                            normal.Magnitude() > 1e-12 ? gp_Dir(normal) : gp_Dir(0, 0, 1), view.spray[i] != 0);
+    }
+    return true;
+}
+
+// 附加数组复制为int数组
+bool TrajectoryFileReader::readAux(size_t record, std::vector<int>& values) const {
+    const int32_t* stored = nullptr;
+    size_t count = 0;
+    if (!getAux(record, stored, count)) {
+        return false;
+    }
+    values.assign(stored, stored + count);
+    return true;
+}
+
+// 复制为SprayPath
+bool TrajectoryFileReader::readPath(size_t record, SprayPath& path) const {
+    if (record >= entryCount || entries[record].kind != static_cast<uint32_t>(TrajectoryRecordKind::Path)) {
+        return false;
+    }
+    const TrajectoryFileEntry& entry = entries[record];
+    path.pathIndex = entry.id;
+    path.planeIndex = entry.group;
+    path.isConnected = (entry.flags & TRAJECTORY_ENTRY_CONNECTED) != 0;
+    path.width = entry.value;
+    return readPoints(record, path.points);
+}
+
+// 复制为IntegratedTrajectory
+bool TrajectoryFileReader::readTrajectory(size_t record, IntegratedTrajectory& trajectory) const {
+    if (record >= entryCount || entries[record].kind != static_cast<uint32_t>(TrajectoryRecordKind::Trajectory)) {
+        return false;
+    }
+    const TrajectoryFileEntry& entry = entries[record];
+    trajectory.trajectoryIndex = entry.id;
+    trajectory.totalLength = entry.value;
+    return readPoints(record, trajectory.points) && readAux(record, trajectory.pathSegments);
+}
+
+// 复制为SurfaceLayer
+bool TrajectoryFileReader::readSurfaceLayer(size_t record, SurfaceLayer& layer) const {
+    if (record >= entryCount || entries[record].kind != static_cast<uint32_t>(TrajectoryRecordKind::SurfaceLayer)) {
+        return false;
+    }
+    const TrajectoryFileEntry& entry = entries[record];
+    layer.layerIndex = entry.id;
+    layer.averageDepth = entry.value;
+    return readAux(record, layer.pathIndices);
+}
+
+// 读取全部记录
+bool TrajectoryFileReader::readAll(std::vector<SprayPath>& paths, std::vector<IntegratedTrajectory>& trajectories,
+                                   std::vector<SurfaceLayer>& layers) const {
+    SPRAY_PROFILE_SCOPE("trajectoryFile.readAll");
+
+    paths.clear();
+    trajectories.clear();
+    layers.clear();
+    for (size_t record = 0; record < entryCount; record++) {
+        bool read = true;
+        switch (static_cast<TrajectoryRecordKind>(entries[record].kind)) {
+        case TrajectoryRecordKind::Path:
+            paths.emplace_back();
+            read = readPath(record, paths.back());
+            break;
+        case TrajectoryRecordKind::Trajectory:
+            trajectories.emplace_back();
+            read = readTrajectory(record, trajectories.back());
+            break;
+        case TrajectoryRecordKind::SurfaceLayer:
+            layers.emplace_back();
+            read = readSurfaceLayer(record, layers.back());
+            break;
+        default:
+            break;  // 新版本增加的记录类型跳过
+        }
+        if (!read) {
+            return false;
+        }
+    }
+    return true;
+}
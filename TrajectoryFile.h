@@ -0,0 +1,159 @@
+#pragma once
+
+#include "FaceProcessor.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// 喷涂程序文件（.stf）：保存路径、整合轨迹与表面层级，可直接内存映射读取
+//
+// 文件布局（小端，各部分8字节对齐）：
+//   文件头64字节（TrajectoryFileHeader）
+//   数据块：每条记录的点块（SoA）与附加整数数组
+//   索引：每条记录一个64字节的TrajectoryFileEntry，位于文件末尾，由文件头的indexOffset指向
+// 点块按列存放：x[n] y[n] z[n]（float64） nx[n] ny[n] nz[n]（float32） spray[n]（uint8）。
+// 压缩的点块先写7个uint64列字节数，再依次写各列：浮点列与前一个值按位异或，
+// 每个值写1字节的高位零字节数和其余的低位字节（路径上相邻点的高位基本相同）；spray列原样存放。
+// 压缩后不比原始数据小的块按原样存放。附加数组（轨迹的路径段起点、层级的路径序号）为int32，不压缩。
+// 写入先写临时文件再重命名，读取方不会看到写了一半的文件。
+
+// 记录类型
+enum class TrajectoryRecordKind : uint32_t {
+    Path = 1,        // SprayPath
+    Trajectory = 2,  // IntegratedTrajectory
+    SurfaceLayer = 3 // SurfaceLayer
+};
+
+// 文件头
+struct TrajectoryFileHeader {
+    char magic[8];         // "SPRAYSTF"
+    uint32_t version;      // 格式版本
+    uint32_t entrySize;    // 索引项字节数
+    uint64_t entryCount;   // 记录数
+    uint64_t indexOffset;  // 索引的文件偏移
+    uint64_t fileSize;     // 文件总字节数
+    uint64_t reserved[3];  // 保留（0）
+};
+
+// 索引项（每条记录一项）
+struct TrajectoryFileEntry {
+    uint32_t kind;         // 记录类型（TrajectoryRecordKind）
+    int32_t id;            // pathIndex / trajectoryIndex / layerIndex
+    int32_t group;         // 路径所属切割平面（其他记录为-1）
+    uint32_t flags;        // 标志（见TRAJECTORY_ENTRY_*）
+    uint64_t pointCount;   // 点数
+    uint64_t pointOffset;  // 点块的文件偏移
+    uint64_t pointBytes;   // 点块字节数
+    uint64_t auxOffset;    // 附加int32数组的文件偏移
+    uint64_t auxCount;     // 附加数组元素数
+    double value;          // 路径宽度 / 轨迹总长度 / 层级平均深度
+};
+
+static_assert(sizeof(TrajectoryFileHeader) == 64, "TrajectoryFileHeader must be 64 bytes");
+static_assert(sizeof(TrajectoryFileEntry) == 64, "TrajectoryFileEntry must be 64 bytes");
+
+// 索引项标志
+const uint32_t TRAJECTORY_ENTRY_COMPRESSED = 1;  // 点块已压缩
+const uint32_t TRAJECTORY_ENTRY_CONNECTED = 2;   // 路径已连接（SprayPath::isConnected）
+
+// 点块的只读视图（未压缩时直接指向映射的文件内容）
+struct TrajectoryPointsView {
+    size_t count = 0;
+    const double* x = nullptr;
+    const double* y = nullptr;
+    const double* z = nullptr;
+    const float* nx = nullptr;
+    const float* ny = nullptr;
+    const float* nz = nullptr;
+    const uint8_t* spray = nullptr;
+};
+
+// 喷涂程序文件写入
+class TrajectoryFileWriter {
+public:
+    // compress为true时点块使用异或差分压缩
+    explicit TrajectoryFileWriter(bool compress = false);
+    ~TrajectoryFileWriter();
+
+    // 创建文件（实际写入临时文件，close成功后替换目标文件）
+    bool open(const std::string& filename);
+
+    // 写入记录
+    bool writePath(const SprayPath& path);
+    bool writeTrajectory(const IntegratedTrajectory& trajectory);
+    bool writeSurfaceLayer(const SurfaceLayer& layer);
+
+    // 写入索引并完成文件，返回是否成功
+    bool close();
+
+private:
+    // 写入点块与附加数组，并登记索引项
+    bool writeRecord(TrajectoryFileEntry entry, const std::vector<PathPoint>* points, const std::vector<int>* aux);
+
+    // 补齐到8字节
+    void pad();
+
+    bool compress;                             // 是否压缩点块
+    std::string filename;                      // 目标文件
+    std::string tempFilename;                  // 临时文件
+    std::ofstream out;                         // 输出流
+    std::vector<TrajectoryFileEntry> entries;  // 索引
+    std::vector<unsigned char> scratch;        // 点块的编码缓冲区
+};
+
+// 喷涂程序文件读取（内存映射，零拷贝）
+class TrajectoryFileReader {
+public:
+    TrajectoryFileReader();
+    ~TrajectoryFileReader();
+
+    TrajectoryFileReader(const TrajectoryFileReader&) = delete;
+    TrajectoryFileReader& operator=(const TrajectoryFileReader&) = delete;
+
+    // 映射文件并校验文件头与索引
+    bool open(const std::string& filename);
+
+    // 解除映射
+    void close();
+
+    // 是否已打开
+    bool isOpen() const;
+
+    // 记录数与索引项（record超出范围时返回nullptr）
+    size_t getRecordCount() const;
+    const TrajectoryFileEntry* getEntry(size_t record) const;
+
+    // 点块视图：未压缩的点块直接指向文件内容；压缩的点块解码到scratch中（scratch需保持有效）
+    bool getPoints(size_t record, TrajectoryPointsView& view, std::vector<unsigned char>& scratch) const;
+
+    // 附加数组（轨迹的路径段起点、层级的路径序号）
+    bool getAux(size_t record, const int32_t*& data, size_t& count) const;
+
+    // 复制为流程的数据结构
+    bool readPath(size_t record, SprayPath& path) const;
+    bool readTrajectory(size_t record, IntegratedTrajectory& trajectory) const;
+    bool readSurfaceLayer(size_t record, SurfaceLayer& layer) const;
+
+    // 读取全部记录
+    bool readAll(std::vector<SprayPath>& paths, std::vector<IntegratedTrajectory>& trajectories,
+                 std::vector<SurfaceLayer>& layers) const;
+
+private:
+    // 读取点并复制为PathPoint数组
+    bool readPoints(size_t record, std::vector<PathPoint>& points) const;
+
+    // 附加数组复制为int数组
+    bool readAux(size_t record, std::vector<int>& values) const;
+
+    const unsigned char* data;            // 映射的文件内容
+    size_t size;                          // 文件字节数
+    const TrajectoryFileEntry* entries;   // 索引
+    size_t entryCount;                    // 记录数
+#ifdef _WIN32
+    void* fileHandle;                     // 文件句柄
+    void* mappingHandle;                  // 映射句柄
+#else
+    int fileDescriptor;                   // 文件描述符
+#endif
+};
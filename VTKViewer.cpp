@@ -4,11 +4,121 @@
 #include <vtkProperty.h>
 #include <vtkPolyDataNormals.h>
 #include <vtkArrowSource.h>
-#include <vtkGlyph3D.h>
+#include <vtkGlyph3DMapper.h>
 #include <vtkPointData.h>
 #include <vtkCellData.h>
+#include <vtkCellArray.h>
 #include <vtkDoubleArray.h>
-#include <vtkCell.h>
+#include <vtkFloatArray.h>
+#include <vtkSMPTools.h>
+#include <vtkLODActor.h>
+#include <vtkQuadricClustering.h>
+#include <vtkFeatureEdges.h>
+#include <algorithm>
+
+const char* const VTKViewer::LAYER_MODEL = "model";
+const char* const VTKViewer::LAYER_PLANES = "planes";
+const char* const VTKViewer::LAYER_PATHS = "paths";
+const char* const VTKViewer::LAYER_TRAJECTORIES = "trajectories";
+
+// 设置面的显示属性
+static void applySurfaceOptions(vtkActor* actor, const VTKViewer::RenderOptions& options) {
+    actor->GetMapper()->ScalarVisibilityOff();
+    actor->GetProperty()->SetColor(options.surfaceColor[0], options.surfaceColor[1], options.surfaceColor[2]);
+    actor->GetProperty()->SetOpacity(options.surfaceOpacity);
+    actor->GetProperty()->SetAmbient(0.3);
+    actor->GetProperty()->SetDiffuse(0.7);
+    actor->GetProperty()->BackfaceCullingOff();
+    actor->GetProperty()->FrontfaceCullingOff();
+}
+
+// 设置线框的显示属性
+static void applyWireframeOptions(vtkActor* actor, const VTKViewer::RenderOptions& options) {
+    actor->GetProperty()->SetRepresentationToWireframe();
+    actor->GetProperty()->SetColor(options.wireframeColor[0], options.wireframeColor[1], options.wireframeColor[2]);
+    actor->GetProperty()->SetLineWidth(1.5);
+    actor->GetProperty()->SetOpacity(1.0);
+    actor->GetProperty()->SetAmbient(1.0);
+    actor->GetProperty()->SetDiffuse(0.0);
+    actor->GetProperty()->SetSpecular(0.0);
+}
+
+// 设置法线箭头的显示属性
+static void applyNormalsOptions(vtkActor* actor, const VTKViewer::RenderOptions& options) {
+    vtkGlyph3DMapper::SafeDownCast(actor->GetMapper())->SetScaleFactor(options.normalScale);
+    actor->GetProperty()->SetColor(options.normalColor[0], options.normalColor[1], options.normalColor[2]);
+}
+
+// 普通映射器
+static vtkSmartPointer<vtkMapper> createPolyDataMapper() {
+    return vtkSmartPointer<vtkPolyDataMapper>::New();
+}
+
+// 法线箭头映射器：一个箭头模型在GPU上按单元中心实例化，方向取"Normals"数组
+static vtkSmartPointer<vtkMapper> createNormalsMapper() {
+    vtkSmartPointer<vtkArrowSource> arrowSource = vtkSmartPointer<vtkArrowSource>::New();
+    vtkSmartPointer<vtkGlyph3DMapper> mapper = vtkSmartPointer<vtkGlyph3DMapper>::New();
+    mapper->SetSourceConnection(arrowSource->GetOutputPort());
+    mapper->SetOrientationArray("Normals");
+    mapper->SetOrientationModeToDirection();
+    mapper->ScalingOn();
+    mapper->SetScaleModeToNoDataScaling();
+    mapper->ScalarVisibilityOff();
+    return mapper;
+}
+
+// 用映射器包装数据并创建actor
+static vtkSmartPointer<vtkActor> createActor(vtkSmartPointer<vtkPolyData> polyData, vtkSmartPointer<vtkMapper> mapper) {
+    mapper->SetInputDataObject(0, polyData);
+
+    vtkSmartPointer<vtkActor> actor = vtkSmartPointer<vtkActor>::New();
+    actor->SetMapper(mapper);
+    return actor;
+}
+
+// 按采样步长计算多边形单元的中心与法向量（直接遍历offsets/connectivity，按单元区间并行）
+template <typename IdType, typename PointType>
+static void fillCellCenters(const IdType* offsets, const IdType* connectivity, const PointType* points,
+                            vtkDataArray* cellNormals, vtkIdType firstCellId, vtkIdType stride, vtkIdType count,
+                            float* centers, float* normals) {
+    vtkSMPTools::For(0, count, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType k = begin; k < end; k++) {
+            const vtkIdType cell = k * stride;
+            const IdType first = offsets[cell];
+            const IdType last = offsets[cell + 1];
+            double sum[3] = { 0.0, 0.0, 0.0 };
+            for (IdType c = first; c < last; c++) {
+                const PointType* point = points + 3 * connectivity[c];
+                sum[0] += point[0];
+                sum[1] += point[1];
+                sum[2] += point[2];
+            }
+            const double scale = last > first ? 1.0 / static_cast<double>(last - first) : 0.0;
+            centers[3 * k] = static_cast<float>(sum[0] * scale);
+            centers[3 * k + 1] = static_cast<float>(sum[1] * scale);
+            centers[3 * k + 2] = static_cast<float>(sum[2] * scale);
+
+            double n[3];
+            cellNormals->GetTuple(firstCellId + cell, n);
+            normals[3 * k] = static_cast<float>(n[0]);
+            normals[3 * k + 1] = static_cast<float>(n[1]);
+            normals[3 * k + 2] = static_cast<float>(n[2]);
+        }
+    });
+}
+
+// 按单元数组的存储位数分派
+template <typename PointType>
+static void fillCellCenters(vtkCellArray* polys, const PointType* points, vtkDataArray* cellNormals,
+                            vtkIdType firstCellId, vtkIdType stride, vtkIdType count, float* centers, float* normals) {
+    if (polys->IsStorage64Bit()) {
+        fillCellCenters(polys->GetOffsetsArray64()->GetPointer(0), polys->GetConnectivityArray64()->GetPointer(0),
+                        points, cellNormals, firstCellId, stride, count, centers, normals);
+    } else {
+        fillCellCenters(polys->GetOffsetsArray32()->GetPointer(0), polys->GetConnectivityArray32()->GetPointer(0),
+                        points, cellNormals, firstCellId, stride, count, centers, normals);
+    }
+}
 
 VTKViewer::VTKViewer() {
     renderer = vtkSmartPointer<vtkRenderer>::New();
@@ -27,34 +137,26 @@ void VTKViewer::setModel(vtkSmartPointer<vtkPolyData> polyData) {
 }
 
 void VTKViewer::setModel(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options) {
-    // 清除旧actor
-    renderer->RemoveAllViewProps();
-
-    // 我们不再需要VTK计算法向量，因为OCCHandler已经提供了正确的法向量
-    // 只需直接使用polyData而不进行法线修正
-    vtkSmartPointer<vtkPolyData> polyWithNormals = polyData;
-
-    // 根据选项添加不同的可视化元素
-    if (options.showSurface) {
-        vtkSmartPointer<vtkActor> surfaceActor = createSurfaceActor(polyWithNormals, options);
-        renderer->AddActor(surfaceActor);
-    }
+    setModel(polyData, options, ModelLod());
+}
 
-    if (options.showWireframe) {
-        vtkSmartPointer<vtkActor> wireframeActor = createWireframeActor(polyWithNormals, options);
-        renderer->AddActor(wireframeActor);
-    }
+void VTKViewer::setModel(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options, const ModelLod& lod) {
+    // 切割平面、路径和轨迹都依赖旧模型，一并清除
+    clearOverlays();
 
-    if (options.showNormals) {
-        vtkSmartPointer<vtkActor> normalsActor = createNormalsActor(polyWithNormals, options);
-        renderer->AddActor(normalsActor);
-    }
+    // 我们不再需要VTK计算法向量，因为OCCHandler已经提供了正确的法向量
+    // 模型图层已存在时只替换数据，不重建actor
+    setLayer(LAYER_MODEL, polyData, options, lod);
 
     // 添加坐标轴
-    renderer->AddActor(axes);
+    if (!renderer->HasViewProp(axes)) {
+        renderer->AddActor(axes);
+    }
 
     // 更新坐标轴大小
-    updateAxesSize(polyData);
+    if (polyData) {
+        updateAxesSize(polyData);
+    }
 
     // 重置相机
     renderer->ResetCamera();
@@ -66,110 +168,260 @@ void VTKViewer::addPolyData(vtkSmartPointer<vtkPolyData> polyData, const RenderO
         return; // 如果polyData为空，则不进行任何操作
     }
 
-    // 直接使用polyData，不进行法线修正
-    vtkSmartPointer<vtkPolyData> polyWithNormals = polyData;
-
-    // 根据选项添加不同的可视化元素
+    // 根据选项添加不同的可视化元素（记录下来，setModel时一并清除）
+    std::vector<vtkSmartPointer<vtkActor>> actors;
     if (options.showSurface) {
-        vtkSmartPointer<vtkActor> surfaceActor = createSurfaceActor(polyWithNormals, options);
-        renderer->AddActor(surfaceActor);
+        actors.push_back(createSurfaceActor(polyData, options));
     }
 
     if (options.showWireframe) {
-        vtkSmartPointer<vtkActor> wireframeActor = createWireframeActor(polyWithNormals, options);
-        renderer->AddActor(wireframeActor);
+        actors.push_back(createWireframeActor(polyData, options));
     }
 
     if (options.showNormals) {
-        vtkSmartPointer<vtkActor> normalsActor = createNormalsActor(polyWithNormals, options);
-        renderer->AddActor(normalsActor);
+        actors.push_back(createNormalsActor(polyData, options));
+    }
+
+    for (const vtkSmartPointer<vtkActor>& actor : actors) {
+        renderer->AddActor(actor);
+        looseActors.push_back(actor);
     }
 
     // 重置相机，确保所有添加的内容都可见
     renderer->ResetCamera();
 }
 
-vtkSmartPointer<vtkActor> VTKViewer::createSurfaceActor(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options) {
-    vtkSmartPointer<vtkPolyDataMapper> surfaceMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
-    surfaceMapper->SetInputData(polyData);
-    surfaceMapper->ScalarVisibilityOff();
-
-    vtkSmartPointer<vtkActor> surfaceActor = vtkSmartPointer<vtkActor>::New();
-    surfaceActor->SetMapper(surfaceMapper);
-    surfaceActor->GetProperty()->SetColor(options.surfaceColor[0], options.surfaceColor[1], options.surfaceColor[2]);
-    surfaceActor->GetProperty()->SetOpacity(options.surfaceOpacity);
-    surfaceActor->GetProperty()->SetAmbient(0.3);
-    surfaceActor->GetProperty()->SetDiffuse(0.7);
-    surfaceActor->GetProperty()->BackfaceCullingOff();
-    surfaceActor->GetProperty()->FrontfaceCullingOff();
+// 更新图层中的一个actor：需要显示时替换输入（不存在则创建）并显示，否则隐藏
+void VTKViewer::updateLayerActor(vtkSmartPointer<vtkActor>& actor, bool show,
+                                 vtkSmartPointer<vtkPolyData> input, const RenderOptions& options,
+                                 vtkSmartPointer<vtkMapper> (*createMapper)(),
+                                 void (*apply)(vtkActor*, const RenderOptions&)) {
+    if (!show || !input) {
+        if (actor) {
+            actor->SetVisibility(0);
+        }
+        return;
+    }
 
+    if (actor) {
+        actor->GetMapper()->SetInputDataObject(0, input);
+    } else {
+        actor = createActor(input, createMapper());
+        renderer->AddActor(actor);
+    }
+    apply(actor, options);
+    actor->SetVisibility(1);
+}
+
+// 生成LOD数据：二次误差聚类得到简化代理；没有B-rep边时用特征边（边界、非流形边和超过二面角阈值的边）代替三角形线框
+VTKViewer::ModelLod VTKViewer::buildModelLod(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options,
+                                             vtkSmartPointer<vtkPolyData> edges) {
+    ModelLod lod;
+    lod.edges = edges;
+    if (!options.useLod || !polyData || polyData->GetNumberOfCells() < options.lodMinCells) {
+        return lod;
+    }
+
+    vtkSmartPointer<vtkQuadricClustering> clustering = vtkSmartPointer<vtkQuadricClustering>::New();
+    clustering->SetInputData(polyData);
+    clustering->SetNumberOfDivisions(options.lodDivisions, options.lodDivisions, options.lodDivisions);
+    clustering->AutoAdjustNumberOfDivisionsOn();
+    clustering->Update();
+    lod.proxy = clustering->GetOutput();
+
+    if (!lod.edges) {
+        vtkSmartPointer<vtkFeatureEdges> featureEdges = vtkSmartPointer<vtkFeatureEdges>::New();
+        featureEdges->SetInputData(polyData);
+        featureEdges->BoundaryEdgesOn();
+        featureEdges->FeatureEdgesOn();
+        featureEdges->SetFeatureAngle(options.featureAngle);
+        featureEdges->NonManifoldEdgesOn();
+        featureEdges->ManifoldEdgesOff();
+        featureEdges->ColoringOff();
+        featureEdges->Update();
+        lod.edges = featureEdges->GetOutput();
+    }
+    return lod;
+}
+
+// 设置命名图层的数据
+void VTKViewer::setLayer(const std::string& name, vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options,
+                         const ModelLod& lod) {
+    auto it = layers.find(name);
+    const bool created = it == layers.end();
+    if (created) {
+        if (!polyData) {
+            return;
+        }
+        it = layers.emplace(name, Layer()).first;
+    }
+
+    Layer& layer = it->second;
+    layer.options = options;
+    layer.hasData = polyData != nullptr;
+    layer.visible = true;
+
+    ModelLod modelLod = lod;
+    if (options.useLod && polyData && !modelLod.proxy) {
+        modelLod = buildModelLod(polyData, options, modelLod.edges);
+    }
+    const bool useLod = modelLod.proxy != nullptr;
+
+    // 面actor的类型随LOD开关切换；LOD actor在交互时按渲染时间选用简化代理，静止时渲染完整网格
+    const bool isLodActor = vtkLODActor::SafeDownCast(layer.surfaceActor) != nullptr;
+    if (layer.surfaceActor && isLodActor != useLod) {
+        renderer->RemoveActor(layer.surfaceActor);
+        layer.surfaceActor = nullptr;
+        layer.lodMapper = nullptr;
+    }
+    if (useLod && options.showSurface && !layer.surfaceActor) {
+        vtkSmartPointer<vtkLODActor> lodActor = vtkSmartPointer<vtkLODActor>::New();
+        lodActor->SetMapper(createPolyDataMapper());
+        layer.lodMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+        layer.lodMapper->ScalarVisibilityOff();
+        lodActor->AddLODMapper(layer.lodMapper);  // 有自定义LOD时不再生成默认的点云/包围盒LOD
+        layer.surfaceActor = lodActor;
+        renderer->AddActor(lodActor);
+    }
+    if (layer.lodMapper) {
+        layer.lodMapper->SetInputData(modelLod.proxy);
+    }
+
+    vtkSmartPointer<vtkPolyData> normalCenters;
+    if (options.showNormals && polyData) {
+        normalCenters = createNormalCenters(polyData, options);
+    }
+    vtkSmartPointer<vtkPolyData> wireframe = modelLod.edges ? modelLod.edges : polyData;
+    updateLayerActor(layer.surfaceActor, options.showSurface, polyData, options, createPolyDataMapper,
+                     applySurfaceOptions);
+    updateLayerActor(layer.wireframeActor, options.showWireframe, wireframe, options, createPolyDataMapper,
+                     applyWireframeOptions);
+    updateLayerActor(layer.normalsActor, options.showNormals, normalCenters, options, createNormalsMapper,
+                     applyNormalsOptions);
+
+    // 新图层需要重置相机，确保内容可见；替换数据时保持当前视角
+    if (created) {
+        renderer->ResetCamera();
+    }
+}
+
+// 显示/隐藏图层
+void VTKViewer::setLayerVisible(const std::string& name, bool visible) {
+    auto it = layers.find(name);
+    if (it == layers.end()) {
+        return;
+    }
+    Layer& layer = it->second;
+    layer.visible = visible;
+    // 被显示选项关闭的部分保持隐藏
+    const bool shown = visible && layer.hasData;
+    if (layer.surfaceActor) {
+        layer.surfaceActor->SetVisibility(shown && layer.options.showSurface ? 1 : 0);
+    }
+    if (layer.wireframeActor) {
+        layer.wireframeActor->SetVisibility(shown && layer.options.showWireframe ? 1 : 0);
+    }
+    if (layer.normalsActor) {
+        layer.normalsActor->SetVisibility(shown && layer.options.showNormals ? 1 : 0);
+    }
+}
+
+// 图层是否存在
+bool VTKViewer::hasLayer(const std::string& name) const {
+    return layers.find(name) != layers.end();
+}
+
+// 移除图层
+void VTKViewer::removeLayer(const std::string& name) {
+    auto it = layers.find(name);
+    if (it == layers.end()) {
+        return;
+    }
+    Layer& layer = it->second;
+    for (vtkActor* actor : { layer.surfaceActor.Get(), layer.wireframeActor.Get(), layer.normalsActor.Get() }) {
+        if (actor) {
+            renderer->RemoveActor(actor);
+        }
+    }
+    layers.erase(it);
+}
+
+// 移除模型以外的全部图层与addPolyData添加的actor
+void VTKViewer::clearOverlays() {
+    for (auto it = layers.begin(); it != layers.end();) {
+        const std::string name = (it++)->first;
+        if (name != LAYER_MODEL) {
+            removeLayer(name);
+        }
+    }
+    for (const vtkSmartPointer<vtkActor>& actor : looseActors) {
+        renderer->RemoveActor(actor);
+    }
+    looseActors.clear();
+}
+
+vtkSmartPointer<vtkActor> VTKViewer::createSurfaceActor(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options) {
+    vtkSmartPointer<vtkActor> surfaceActor = createActor(polyData, createPolyDataMapper());
+    applySurfaceOptions(surfaceActor, options);
     return surfaceActor;
 }
 
 vtkSmartPointer<vtkActor> VTKViewer::createWireframeActor(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options) {
-    vtkSmartPointer<vtkPolyDataMapper> wireframeMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
-    wireframeMapper->SetInputData(polyData);
-
-    vtkSmartPointer<vtkActor> wireframeActor = vtkSmartPointer<vtkActor>::New();
-    wireframeActor->SetMapper(wireframeMapper);
-    wireframeActor->GetProperty()->SetRepresentationToWireframe();
-    wireframeActor->GetProperty()->SetColor(options.wireframeColor[0], options.wireframeColor[1], options.wireframeColor[2]);
-    wireframeActor->GetProperty()->SetLineWidth(1.5);
-    wireframeActor->GetProperty()->SetOpacity(1.0);
-    wireframeActor->GetProperty()->SetAmbient(1.0);
-    wireframeActor->GetProperty()->SetDiffuse(0.0);
-    wireframeActor->GetProperty()->SetSpecular(0.0);
-
+    vtkSmartPointer<vtkActor> wireframeActor = createActor(polyData, createPolyDataMapper());
+    applyWireframeOptions(wireframeActor, options);
     return wireframeActor;
 }
 
 vtkSmartPointer<vtkActor> VTKViewer::createNormalsActor(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options) {
+    vtkSmartPointer<vtkActor> normalActor = createActor(createNormalCenters(polyData, options), createNormalsMapper());
+    applyNormalsOptions(normalActor, options);
+    return normalActor;
+}
+
+// 生成法线箭头的位置与方向：多边形单元的中心和单元法向量（单精度）。
+// 单元数超过maxNormalGlyphs时按固定步长均匀抽样，箭头数量不随网格规模增长
+vtkSmartPointer<vtkPolyData> VTKViewer::createNormalCenters(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options) {
+    vtkSmartPointer<vtkFloatArray> centerArray = vtkSmartPointer<vtkFloatArray>::New();
+    centerArray->SetNumberOfComponents(3);
+    vtkSmartPointer<vtkFloatArray> normalArray = vtkSmartPointer<vtkFloatArray>::New();
+    normalArray->SetNumberOfComponents(3);
+    normalArray->SetName("Normals");
+
     vtkDataArray* cellNormals = polyData->GetCellData()->GetNormals();
-    vtkSmartPointer<vtkPoints> cellCenters = vtkSmartPointer<vtkPoints>::New();
-    vtkSmartPointer<vtkDoubleArray> cellNormalArray = vtkSmartPointer<vtkDoubleArray>::New();
-    cellNormalArray->SetNumberOfComponents(3);
-    cellNormalArray->SetName("Normals");
-
-    for (vtkIdType i = 0; i < polyData->GetNumberOfCells(); ++i) {
-        vtkCell* cell = polyData->GetCell(i);
-        double center[3] = { 0,0,0 };
-        int npts = cell->GetNumberOfPoints();
-        for (int j = 0; j < npts; ++j) {
-            double pt[3];
-            polyData->GetPoint(cell->GetPointId(j), pt);
-            center[0] += pt[0];
-            center[1] += pt[1];
-            center[2] += pt[2];
+    vtkCellArray* polys = polyData->GetPolys();
+    vtkPoints* points = polyData->GetPoints();
+    const vtkIdType polyCount = polys ? polys->GetNumberOfCells() : 0;
+    if (cellNormals && points && polyCount > 0) {
+        // 单元法向量按全部单元编号，多边形排在顶点和线之后
+        const vtkIdType firstCellId = polyData->GetNumberOfVerts() + polyData->GetNumberOfLines();
+        const vtkIdType stride = options.maxNormalGlyphs > 0
+            ? std::max<vtkIdType>(1, (polyCount + options.maxNormalGlyphs - 1) / options.maxNormalGlyphs)
+            : 1;
+        const vtkIdType count = (polyCount + stride - 1) / stride;
+        centerArray->SetNumberOfTuples(count);
+        normalArray->SetNumberOfTuples(count);
+        float* centers = centerArray->GetPointer(0);
+        float* normals = normalArray->GetPointer(0);
+
+        vtkDataArray* pointData = points->GetData();
+        if (vtkFloatArray* floatPoints = vtkFloatArray::SafeDownCast(pointData)) {
+            fillCellCenters(polys, floatPoints->GetPointer(0), cellNormals, firstCellId, stride, count, centers, normals);
+        } else {
+            vtkSmartPointer<vtkDoubleArray> doublePoints = vtkDoubleArray::SafeDownCast(pointData);
+            if (!doublePoints) {
+                doublePoints = vtkSmartPointer<vtkDoubleArray>::New();
+                doublePoints->DeepCopy(pointData);
+            }
+            fillCellCenters(polys, doublePoints->GetPointer(0), cellNormals, firstCellId, stride, count, centers, normals);
         }
-        center[0] /= npts;
-        center[1] /= npts;
-        center[2] /= npts;
-        cellCenters->InsertNextPoint(center);
-        double n[3];
-        cellNormals->GetTuple(i, n);
-        cellNormalArray->InsertNextTuple(n);
     }
 
+    vtkSmartPointer<vtkPoints> centerPoints = vtkSmartPointer<vtkPoints>::New();
+    centerPoints->SetData(centerArray);
     vtkSmartPointer<vtkPolyData> cellNormalPoly = vtkSmartPointer<vtkPolyData>::New();
-    cellNormalPoly->SetPoints(cellCenters);
-    cellNormalPoly->GetPointData()->SetNormals(cellNormalArray);
-
-    vtkSmartPointer<vtkArrowSource> arrowSource = vtkSmartPointer<vtkArrowSource>::New();
-    vtkSmartPointer<vtkGlyph3D> glyph = vtkSmartPointer<vtkGlyph3D>::New();
-    glyph->SetSourceConnection(arrowSource->GetOutputPort());
-    glyph->SetInputData(cellNormalPoly);
-    glyph->SetVectorModeToUseNormal();
-    glyph->SetScaleFactor(options.normalScale); // 使用选项中的法线缩放因子
-    glyph->OrientOn();
-    glyph->Update();
-
-    vtkSmartPointer<vtkPolyDataMapper> normalMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
-    normalMapper->SetInputConnection(glyph->GetOutputPort());
-    vtkSmartPointer<vtkActor> normalActor = vtkSmartPointer<vtkActor>::New();
-    normalActor->SetMapper(normalMapper);
-    normalActor->GetProperty()->SetColor(options.normalColor[0], options.normalColor[1], options.normalColor[2]);
-
-    return normalActor;
+    cellNormalPoly->SetPoints(centerPoints);
+    cellNormalPoly->GetPointData()->AddArray(normalArray);
+    return cellNormalPoly;
 }
 
 vtkSmartPointer<vtkRenderer> VTKViewer::getRenderer() const {
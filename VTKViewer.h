@@ -8,6 +8,11 @@
 #include <vtkAxesActor.h>
 #include <vtkOrientationMarkerWidget.h>
 #include <vtkActor.h>
+#include <vtkMapper.h>
+#include <vtkPolyDataMapper.h>
+#include <map>
+#include <string>
+#include <vector>
 
 class VTKViewer {
 public:
@@ -18,11 +23,28 @@ public:
         bool showNormals = true;       // 是否显示法线
         double surfaceOpacity = 1.0;   // 面的不透明度
         double normalScale = 50.0;     // 法线箭头大小
+        int maxNormalGlyphs = 20000;   // 法线箭头数量上限（单元更多时均匀抽样，0表示不限）
+        bool useLod = false;           // 大模型交互时渲染简化代理（无B-rep边时线框改为特征边）
+        int lodMinCells = 200000;      // 单元数达到该值才启用LOD
+        int lodDivisions = 128;        // 简化代理的聚类网格划分数（每个轴）
+        double featureAngle = 30.0;    // 特征边的二面角阈值（度）
         double surfaceColor[3] = {0.75, 0.75, 0.75}; // 面的颜色（默认银色）
         double wireframeColor[3] = {0.0, 0.0, 0.0};  // 线框颜色（默认黑色）
         double normalColor[3] = {1.0, 0.0, 0.0};     // 法线颜色（默认红色）
     };
 
+    // 图层名称（模型、切割平面、路径、轨迹）
+    static const char* const LAYER_MODEL;
+    static const char* const LAYER_PLANES;
+    static const char* const LAYER_PATHS;
+    static const char* const LAYER_TRAJECTORIES;
+
+    // 模型的交互代理与线框数据
+    struct ModelLod {
+        vtkSmartPointer<vtkPolyData> proxy;  // 简化网格（交互时渲染）
+        vtkSmartPointer<vtkPolyData> edges;  // 线框：B-rep边（OCCHandler::shapeEdgesToPolyData）或特征边，代替三角形线框
+    };
+
     VTKViewer();
     ~VTKViewer();
 
@@ -32,16 +54,43 @@ public:
     // 设置要显示的PolyData (新接口，带渲染选项)
     void setModel(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options);
 
-    // 在现有模型基础上添加新的PolyData
+    // 设置要显示的PolyData，使用预先生成的LOD数据
+    void setModel(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options, const ModelLod& lod);
+
+    // 生成LOD数据（不访问渲染器，可在工作线程中调用）。edges为模型的B-rep边，总是作为线框；
+    // 未提供时，启用LOD的大模型改用特征边。未启用LOD或模型较小时proxy为空
+    static ModelLod buildModelLod(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options,
+                                  vtkSmartPointer<vtkPolyData> edges = nullptr);
+
+    // 在现有模型基础上添加新的PolyData（每次调用都新增actor，重复显示同类数据请使用setLayer）
     void addPolyData(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options);
 
+    // 设置命名图层的数据并显示：图层已存在时替换原有映射器的输入并更新显示选项，不新增actor；
+    // polyData为空时隐藏该图层
+    // options.useLod时面使用LOD actor（交互时渲染lod.proxy），lod.edges不为空时线框显示lod.edges；
+    // 需要LOD而lod.proxy为空时现场生成
+    void setLayer(const std::string& name, vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options,
+                  const ModelLod& lod = ModelLod());
+
+    // 显示/隐藏图层
+    void setLayerVisible(const std::string& name, bool visible);
+
+    // 图层是否存在
+    bool hasLayer(const std::string& name) const;
+
+    // 移除图层
+    void removeLayer(const std::string& name);
+
+    // 移除模型以外的全部图层与addPolyData添加的actor
+    void clearOverlays();
+
     // 创建和显示面
     vtkSmartPointer<vtkActor> createSurfaceActor(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options);
 
     // 创建和显示线框
     vtkSmartPointer<vtkActor> createWireframeActor(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options);
 
-    // 创建和显示法线
+    // 创建和显示法线（单元中心的箭头，GPU实例化绘制，数量受maxNormalGlyphs限制）
     vtkSmartPointer<vtkActor> createNormalsActor(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options);
 
     // 获取渲染器
@@ -61,8 +110,30 @@ public:
     void setInteractor(vtkSmartPointer<vtkRenderWindowInteractor> interactor);
 
 private:
+    // 命名图层（actor在首次需要显示时创建，之后只替换映射器的输入）
+    struct Layer {
+        vtkSmartPointer<vtkActor> surfaceActor;
+        vtkSmartPointer<vtkActor> wireframeActor;
+        vtkSmartPointer<vtkActor> normalsActor;
+        vtkSmartPointer<vtkPolyDataMapper> lodMapper;  // 简化代理的映射器（LOD actor使用）
+        RenderOptions options;  // 最近一次的显示选项
+        bool hasData = false;   // 是否有数据
+        bool visible = true;    // 是否显示（setLayerVisible）
+    };
+
+    // 生成法线箭头的位置与方向（单元中心、单元法向量）
+    vtkSmartPointer<vtkPolyData> createNormalCenters(vtkSmartPointer<vtkPolyData> polyData, const RenderOptions& options);
+
+    // 更新图层中的一个actor：需要显示时替换输入（不存在则创建）并显示，否则隐藏
+    void updateLayerActor(vtkSmartPointer<vtkActor>& actor, bool show,
+                          vtkSmartPointer<vtkPolyData> input, const RenderOptions& options,
+                          vtkSmartPointer<vtkMapper> (*createMapper)(),
+                          void (*apply)(vtkActor*, const RenderOptions&));
+
     vtkSmartPointer<vtkRenderer> renderer;
     vtkSmartPointer<vtkAxesActor> axes;
     vtkSmartPointer<vtkOrientationMarkerWidget> orientationWidget;
     RenderOptions defaultOptions; // 默认渲染选项
+    std::map<std::string, Layer> layers;                  // 命名图层
+    std::vector<vtkSmartPointer<vtkActor>> looseActors;   // addPolyData添加的actor
 };
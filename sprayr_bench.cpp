@@ -0,0 +1,425 @@
+// 喷涂流程性能基准程序
+// 在进程内生成参数化测试几何（叠放板、多孔板、B样条曲面板、箱体组合），
+// 写成STEP后重新加载，逐阶段计时，并按面数输出扩展曲线
+
+#include "SprayPipeline.h"
+#include "SprayLog.h"
+#include <STEPControl_Controller.hxx>
+#include <STEPControl_Writer.hxx>
+#include <IFSelect_ReturnStatus.hxx>
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <BRepPrimAPI_MakeCylinder.hxx>
+#include <BRepAlgoAPI_Cut.hxx>
+#include <BRepBuilderAPI_MakeFace.hxx>
+#include <BRep_Builder.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopTools_ListOfShape.hxx>
+#include <GeomAPI_PointsToBSplineSurface.hxx>
+#include <Geom_BSplineSurface.hxx>
+#include <TColgp_Array2OfPnt.hxx>
+#include <gp_Ax2.hxx>
+#include <Standard_Failure.hxx>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// 测试几何生成器
+struct GeometryGenerator {
+    std::string name;                          // 名称
+    std::function<TopoDS_Shape(int)> build;    // 按规模参数生成几何
+};
+
+// 叠放板：n块逐层错开的板，上层部分遮挡下层（总错开量固定，任意块数时板宽都为正）
+static TopoDS_Shape makeStackedPlates(int count) {
+    TopoDS_Compound compound;
+    BRep_Builder builder;
+    builder.MakeCompound(compound);
+
+    for (int i = 0; i < count; i++) {
+        double shift = 600.0 * i / count;
+        gp_Pnt corner(shift, shift * 0.5, 100.0 * i);
+        builder.Add(compound, BRepPrimAPI_MakeBox(corner, 1000.0 - shift, 600.0, 10.0).Shape());
+    }
+    return compound;
+}
+
+// 多孔板：n×n个圆孔的薄板
+static TopoDS_Shape makePerforatedSheet(int holesPerSide) {
+    const double size = 1000.0;
+    const double thickness = 5.0;
+    TopoDS_Shape sheet = BRepPrimAPI_MakeBox(size, size, thickness).Shape();
+
+    TopTools_ListOfShape tools;
+    double pitch = size / (holesPerSide + 1);
+    double radius = pitch * 0.3;
+    for (int i = 1; i <= holesPerSide; i++) {
+        for (int j = 1; j <= holesPerSide; j++) {
+            gp_Ax2 axis(gp_Pnt(i * pitch, j * pitch, -1.0), gp_Dir(0, 0, 1));
+            tools.Append(BRepPrimAPI_MakeCylinder(axis, radius, thickness + 2.0).Shape());
+        }
+    }
+
+    TopTools_ListOfShape arguments;
+    arguments.Append(sheet);
+
+    BRepAlgoAPI_Cut cutter;
+    cutter.SetArguments(arguments);
+    cutter.SetTools(tools);
+    cutter.Build();
+    return cutter.IsDone() ? cutter.Shape() : sheet;
+}
+
+// B样条曲面板：n×n块起伏平缓的曲面片，分两层放置
+static TopoDS_Shape makeBSplinePanels(int panelsPerSide) {
+    TopoDS_Compound compound;
+    BRep_Builder builder;
+    builder.MakeCompound(compound);
+
+    const double panelSize = 200.0;
+    const int poleCount = 6;
+    for (int pi = 0; pi < panelsPerSide; pi++) {
+        for (int pj = 0; pj < panelsPerSide; pj++) {
+            double baseZ = ((pi + pj) % 2 == 0) ? 0.0 : 150.0;
+            TColgp_Array2OfPnt points(1, poleCount, 1, poleCount);
+            for (int u = 1; u <= poleCount; u++) {
+                for (int v = 1; v <= poleCount; v++) {
+                    double x = pi * panelSize * 0.9 + panelSize * (u - 1) / (poleCount - 1);
+                    double y = pj * panelSize * 0.9 + panelSize * (v - 1) / (poleCount - 1);
+                    double z = baseZ + 4.0 * std::sin(x / 90.0) * std::cos(y / 110.0);
+                    points.SetValue(u, v, gp_Pnt(x, y, z));
+                }
+            }
+
+            GeomAPI_PointsToBSplineSurface fitter(points);
+            if (!fitter.IsDone()) continue;
+            BRepBuilderAPI_MakeFace faceMaker(fitter.Surface(), 1e-6);
+            if (faceMaker.IsDone()) {
+                builder.Add(compound, faceMaker.Face());
+            }
+        }
+    }
+    return compound;
+}
+
+// 箱体组合：底板上n×n个高度不同的箱体
+static TopoDS_Shape makeBoxAssembly(int boxesPerSide) {
+    TopoDS_Compound compound;
+    BRep_Builder builder;
+    builder.MakeCompound(compound);
+
+    const double pitch = 120.0;
+    double baseSize = pitch * boxesPerSide + 40.0;
+    builder.Add(compound, BRepPrimAPI_MakeBox(gp_Pnt(-20.0, -20.0, -20.0), baseSize, baseSize, 20.0).Shape());
+
+    for (int i = 0; i < boxesPerSide; i++) {
+        for (int j = 0; j < boxesPerSide; j++) {
+            double height = 30.0 + 25.0 * ((i * 7 + j * 3) % 5);
+            builder.Add(compound, BRepPrimAPI_MakeBox(gp_Pnt(i * pitch, j * pitch, 0.0), 90.0, 90.0, height).Shape());
+        }
+    }
+    return compound;
+}
+
+// 统计面数量
+static int countFaces(const TopoDS_Shape& shape) {
+    int count = 0;
+    for (TopExp_Explorer explorer(shape, TopAbs_FACE); explorer.More(); explorer.Next()) {
+        count++;
+    }
+    return count;
+}
+
+// 写出STEP文件
+static bool writeStep(const TopoDS_Shape& shape, const std::string& filename) {
+    STEPControl_Writer writer;
+    if (writer.Transfer(shape, STEPControl_AsIs) != IFSelect_RetDone) {
+        return false;
+    }
+    return writer.Write(filename.c_str()) == IFSelect_RetDone;
+}
+
+// 一次测量的各阶段耗时（毫秒）
+struct StageTimings {
+    double load = 0.0;        // loadStepFile（含修复）
+    double mesh = 0.0;        // shapeToPolyData
+    double extract = 0.0;     // extractFacesByNormal
+    double occlusion = 0.0;   // removeOccludedPortions
+    double paths = 0.0;       // 切割平面与generatePaths
+    double integrate = 0.0;   // integrateTrajectories
+    int loadedFaces = 0;      // 加载后的面数
+    int trajectories = 0;     // 轨迹数
+    bool success = false;
+};
+
+// 计时执行一个阶段
+template <typename Func>
+static double timeStage(Func&& func, bool& ok) {
+    auto start = std::chrono::steady_clock::now();
+    ok = func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 对一个STEP文件执行一次完整流程并计时
+static StageTimings runOnce(const std::string& stepFile, const SprayPipelineParams& params) {
+    StageTimings timings;
+    SprayPipeline pipeline(params);
+    OCCHandler& handler = pipeline.getHandler();
+    bool ok = false;
+
+    timings.load = timeStage([&]() { return pipeline.loadModel(stepFile); }, ok);
+    if (!ok) return timings;
+    timings.loadedFaces = countFaces(handler.getShape());
+
+    timings.mesh = timeStage([&]() {
+        vtkSmartPointer<vtkPolyData> poly = handler.shapeToPolyData();
+        return poly && poly->GetNumberOfPoints() > 0;
+    }, ok);
+    if (!ok) return timings;
+
+    timings.extract = timeStage([&]() { return pipeline.extractFaces(); }, ok);
+    if (!ok) return timings;
+
+    timings.occlusion = timeStage([&]() { return pipeline.removeOcclusion(); }, ok);
+    if (!ok) return timings;
+
+    timings.paths = timeStage([&]() {
+        return pipeline.generateCuttingPlanes() && pipeline.generatePaths();
+    }, ok);
+    if (!ok) return timings;
+
+    timings.integrate = timeStage([&]() { return pipeline.integrateTrajectories(); }, ok);
+    if (!ok) return timings;
+
+    timings.trajectories = pipeline.getResult().trajectoryCount;
+    timings.success = true;
+    return timings;
+}
+
+// 取多次测量的中位数
+static double median(std::vector<double> values) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : 0.5 * (values[middle - 1] + values[middle]);
+}
+
+// 汇总多次测量
+static StageTimings medianTimings(const std::vector<StageTimings>& runs) {
+    StageTimings result;
+    if (runs.empty()) return result;
+
+    std::vector<double> load, mesh, extract, occlusion, paths, integrate;
+    result.success = true;
+    for (const StageTimings& run : runs) {
+        load.push_back(run.load);
+        mesh.push_back(run.mesh);
+        extract.push_back(run.extract);
+        occlusion.push_back(run.occlusion);
+        paths.push_back(run.paths);
+        integrate.push_back(run.integrate);
+        result.success = result.success && run.success;
+    }
+    result.load = median(load);
+    result.mesh = median(mesh);
+    result.extract = median(extract);
+    result.occlusion = median(occlusion);
+    result.paths = median(paths);
+    result.integrate = median(integrate);
+    result.loadedFaces = runs.back().loadedFaces;
+    result.trajectories = runs.back().trajectories;
+    return result;
+}
+
+// 打印用法
+static void printUsage(std::ostream& out) {
+    out << "用法: sprayr-bench [选项]\n"
+        << "\n"
+        << "选项:\n"
+        << "  -g, --generator <名称>   只运行指定生成器（plates, perforated, bspline, boxes），可重复\n"
+        << "  -s, --sizes <列表>       规模参数列表，如 1,2,4,8（默认 1,2,4,8）\n"
+        << "  -r, --repeat <N>         每个规模重复次数，取中位数（默认3）\n"
+        << "  -o, --output <文件>      将结果写入CSV\n"
+        << "  -w, --work-dir <目录>    生成STEP文件的目录（默认系统临时目录）\n"
+        << "  -v, --verbose            输出流程内部日志\n"
+        << "  --<流程参数> <值>        与 sprayr-cli 相同的流程参数，如 --path-spacing 50\n";
+}
+
+// 解析逗号分隔的整数列表
+static bool parseSizes(const std::string& text, std::vector<int>& sizes) {
+    sizes.clear();
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos) end = text.size();
+        try {
+            int value = std::stoi(text.substr(start, end - start));
+            if (value <= 0) return false;
+            sizes.push_back(value);
+        } catch (...) {
+            return false;
+        }
+        start = end + 1;
+    }
+    return !sizes.empty();
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+    // 设置控制台输出编码为UTF-8，解决中文乱码问题
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+
+    std::vector<GeometryGenerator> generators = {
+        { "plates", makeStackedPlates },
+        { "perforated", makePerforatedSheet },
+        { "bspline", makeBSplinePanels },
+        { "boxes", makeBoxAssembly },
+    };
+
+    SprayPipelineParams params;
+    params.pathSpacing = 50.0;
+    params.offsetDistance = 0.0;
+    std::vector<std::string> selected;
+    std::vector<int> sizes = { 1, 2, 4, 8 };
+    int repeat = 3;
+    bool verbose = false;
+    std::string outputFile;
+    fs::path workDir = fs::temp_directory_path() / "sprayr-bench";
+
+    std::vector<std::string> args(argv + 1, argv + argc);
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string& arg = args[i];
+        bool hasValue = i + 1 < args.size();
+        std::string error;
+
+        if (arg == "-h" || arg == "--help") {
+            printUsage(std::cout);
+            return 0;
+        } else if (arg == "-v" || arg == "--verbose") {
+            verbose = true;
+        } else if ((arg == "-g" || arg == "--generator") && hasValue) {
+            selected.push_back(args[++i]);
+        } else if ((arg == "-s" || arg == "--sizes") && hasValue) {
+            if (!parseSizes(args[++i], sizes)) {
+                std::cerr << "❌ 无效的规模列表: " << args[i] << std::endl;
+                return 2;
+            }
+        } else if ((arg == "-r" || arg == "--repeat") && hasValue) {
+            repeat = std::max(1, std::atoi(args[++i].c_str()));
+        } else if ((arg == "-o" || arg == "--output") && hasValue) {
+            outputFile = args[++i];
+        } else if ((arg == "-w" || arg == "--work-dir") && hasValue) {
+            workDir = args[++i];
+        } else if (arg.size() > 2 && arg.compare(0, 2, "--") == 0 && hasValue) {
+            if (!setSprayPipelineParam(params, arg.substr(2), args[++i], error)) {
+                std::cerr << "❌ " << error << std::endl;
+                return 2;
+            }
+        } else {
+            std::cerr << "❌ 无效的参数: " << arg << std::endl;
+            printUsage(std::cerr);
+            return 2;
+        }
+    }
+
+    for (const std::string& name : selected) {
+        bool known = std::any_of(generators.begin(), generators.end(),
+                                 [&](const GeometryGenerator& generator) { return generator.name == name; });
+        if (!known) {
+            std::cerr << "❌ 未知生成器: " << name << std::endl;
+            return 2;
+        }
+    }
+
+    std::error_code ec;
+    fs::create_directories(workDir, ec);
+    if (ec) {
+        std::cerr << "❌ 无法创建工作目录: " << workDir.string() << " (" << ec.message() << ")" << std::endl;
+        return 2;
+    }
+
+    // 结果直接写到控制台；非详细模式下只保留流程内部的警告和错误日志
+    SprayLog::setLevel(verbose ? SprayLogLevel::Info : SprayLogLevel::Warn);
+    std::ostream& console = std::cout;
+
+    STEPControl_Controller::Init();
+
+    std::ofstream csv;
+    if (!outputFile.empty()) {
+        csv.open(outputFile);
+        csv << "generator,size,faces,load_ms,mesh_ms,extract_ms,occlusion_ms,paths_ms,integrate_ms,total_ms,trajectories,success\n";
+    }
+
+    console << std::left << std::setw(11) << "generator" << std::right
+            << std::setw(6) << "size" << std::setw(8) << "faces"
+            << std::setw(10) << "load" << std::setw(10) << "mesh" << std::setw(10) << "extract"
+            << std::setw(11) << "occlusion" << std::setw(10) << "paths" << std::setw(11) << "integrate"
+            << std::setw(10) << "total" << "   (ms)" << std::endl;
+
+    for (const GeometryGenerator& generator : generators) {
+        if (!selected.empty() && std::find(selected.begin(), selected.end(), generator.name) == selected.end()) {
+            continue;
+        }
+
+        for (int size : sizes) {
+            TopoDS_Shape shape;
+            try {
+                shape = generator.build(size);
+            } catch (const Standard_Failure& e) {
+                console << "❌ 生成失败 " << generator.name << " (" << size << "): " << e.GetMessageString() << std::endl;
+                continue;
+            } catch (const std::exception& e) {
+                console << "❌ 生成失败 " << generator.name << " (" << size << "): " << e.what() << std::endl;
+                continue;
+            }
+            std::string stepFile = (workDir / (generator.name + "_" + std::to_string(size) + ".step")).string();
+            if (shape.IsNull() || !writeStep(shape, stepFile)) {
+                console << "❌ 生成或写出 " << generator.name << " (" << size << ") 失败" << std::endl;
+                continue;
+            }
+
+            std::vector<StageTimings> runs;
+            for (int r = 0; r < repeat; r++) {
+                runs.push_back(runOnce(stepFile, params));
+            }
+            StageTimings timings = medianTimings(runs);
+            SprayLog::instance().flush();
+            double total = timings.load + timings.mesh + timings.extract + timings.occlusion +
+                           timings.paths + timings.integrate;
+
+            console << std::fixed << std::setprecision(1)
+                    << std::left << std::setw(11) << generator.name << std::right
+                    << std::setw(6) << size << std::setw(8) << timings.loadedFaces
+                    << std::setw(10) << timings.load << std::setw(10) << timings.mesh
+                    << std::setw(10) << timings.extract << std::setw(11) << timings.occlusion
+                    << std::setw(10) << timings.paths << std::setw(11) << timings.integrate
+                    << std::setw(10) << total << (timings.success ? "" : "   ❌ 未完成") << std::endl;
+
+            if (csv.is_open()) {
+                csv << generator.name << ',' << size << ',' << timings.loadedFaces << ','
+                    << timings.load << ',' << timings.mesh << ',' << timings.extract << ','
+                    << timings.occlusion << ',' << timings.paths << ',' << timings.integrate << ','
+                    << total << ',' << timings.trajectories << ',' << (timings.success ? 1 : 0) << '\n';
+            }
+        }
+    }
+
+    return 0;
+}
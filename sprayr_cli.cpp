@@ -0,0 +1,460 @@
+// 喷涂轨迹批处理命令行工具（无界面）
+// 对一组STEP文件执行与界面相同的流程：加载 → 修复 → 提取面 → 遮挡裁剪 → 路径 → 轨迹整合
+
+#include "SprayPipeline.h"
+#include "SprayProfiler.h"
+#include "SprayLog.h"
+#include "TrajectoryExporter.h"
+#include <STEPControl_Controller.hxx>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// 命令行选项
+struct CliOptions {
+    SprayPipelineParams params;      // 流程参数
+    std::vector<std::string> files;  // 待处理的STEP文件
+    std::string outputDir;           // 输出目录（为空时不写文件）
+    TrajectoryExportFormat exportFormat = TrajectoryExportFormat::Csv; // 轨迹文件格式
+    TrajectoryTemplate exportTemplate = TrajectoryTemplate::defaultTemplate(); // 机器人程序模板
+    bool saveProgram = false;        // 同时保存喷涂程序文件（.stf）
+    bool compressProgram = false;    // 喷涂程序文件的点块压缩
+    int jobs = 1;                    // 并行处理的零件数
+    bool quiet = false;              // 不输出各阶段的详细日志
+    SprayLogLevel logLevel = SprayLogLevel::Info; // 日志级别
+    std::string logFile;             // 日志文件（为空时只输出到控制台）
+    std::string profileFile;         // 性能报告（JSON）输出文件
+    std::string traceFile;           // Chrome Trace输出文件
+    bool listProducts = false;       // 只列出各文件的根实体（产品）后退出
+};
+
+// 打印用法
+static void printUsage(std::ostream& out) {
+    out << "用法: sprayr-cli [选项] <STEP文件>...\n"
+        << "\n"
+        << "选项:\n"
+        << "  -c, --config <文件>      从配置文件读取流程参数（每行 \"键 = 值\"）\n"
+        << "  -l, --list <文件>        从文件读取STEP文件列表（每行一个）\n"
+        << "  -o, --output <目录>      输出目录：每个零件的轨迹文件与汇总 summary.csv\n"
+        << "                           （不同目录中的同名文件，输出文件名附加输入序号）\n"
+        << "      --export-format <格式> 轨迹文件格式：csv/binary/template（默认 csv）\n"
+        << "      --export-template <文件> 机器人程序模板（需要 --export-format template，默认使用内置模板）\n"
+        << "      --save-program       同时保存可内存映射读取的喷涂程序文件（路径、轨迹与表面层级，.stf）\n"
+        << "      --compress-program   喷涂程序文件的点块使用异或差分压缩\n"
+        << "  -j, --jobs <N>           同时处理的零件数（默认1，0表示按CPU核数）\n"
+        << "  -q, --quiet              不输出各阶段的详细日志（等同 --log-level warn）\n"
+        << "      --log-level <级别>   日志级别：trace/debug/info/warn/error/off（默认 info）\n"
+        << "      --log-file <文件>    同时将日志写入文件\n"
+        << "      --profile <文件>     记录各阶段耗时与计数器，写出JSON报告\n"
+        << "      --trace <文件>       写出Chrome Trace（chrome://tracing 或 Perfetto 打开）\n"
+        << "      --list-products      列出各文件的根实体（产品）序号与名称后退出\n"
+        << "  -h, --help               显示帮助\n"
+        << "\n"
+        << "流程参数（命令行优先于配置文件）:\n"
+        << "  --direction <x,y,z>      喷涂方向（默认 0,0,1）\n"
+        << "  --angle-tolerance <度>   提取面的法向量夹角容差（默认 5）\n"
+        << "  --height-tolerance <值>  遮挡裁剪的分层高度容差（默认 1）\n"
+        << "  --path-spacing <值>      路径间距（默认 200）\n"
+        << "  --offset <值>            路径偏移距离（默认 300）\n"
+        << "  --point-density <值>     路径点密度（默认 0.2）\n"
+        << "  --move-to-origin <bool>  加载后移动到原点（默认 true）\n"
+        << "  --auto-repair <bool>     加载后自动修复（默认 true）\n"
+        << "  --visibility <bool>      路径级别可见性分析（默认 true）\n"
+        << "  --parallel <bool>        单个零件内部的并行遮挡裁剪（默认 true，-j>1 时关闭）\n"
+        << "  --parallel-import <bool> 并行转换STEP装配体的根实体（默认 false，需要OCCT 7.8及以上）\n"
+        << "  --partitioned-repair <bool> 按实体/壳/空间簇拆分后并行修复（默认 false）\n"
+        << "  --spatial-sewing <bool>  大面数模型按空间网格分块并行预缝合（默认 false）\n"
+        << "  --products <i,j,...>     只加载指定序号的根实体（见 --list-products）\n"
+        << "  --region <x0,y0,z0,x1,y1,z1> 只加载与该区域相交的部分（文件坐标系）\n"
+        << "  --shape-cache <目录>     修复后模型的BREP缓存目录，再次处理同一文件时跳过读取与修复\n";
+}
+
+// 从列表文件读取STEP文件路径
+static bool readFileList(const std::string& listFile, std::vector<std::string>& files) {
+    std::ifstream input(listFile);
+    if (!input) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(input, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        files.push_back(line);
+    }
+    return true;
+}
+
+// 解析日志级别名称
+static bool parseLogLevel(const std::string& name, SprayLogLevel& level) {
+    static const std::pair<const char*, SprayLogLevel> levels[] = {
+        {"trace", SprayLogLevel::Trace}, {"debug", SprayLogLevel::Debug}, {"info", SprayLogLevel::Info},
+        {"warn", SprayLogLevel::Warn},   {"error", SprayLogLevel::Error}, {"off", SprayLogLevel::Off}};
+    for (const auto& entry : levels) {
+        if (name == entry.first) {
+            level = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 解析命令行，返回值：0成功，1需退出（帮助），2参数错误
+static int parseArguments(int argc, char* argv[], CliOptions& options) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    std::string error;
+
+    // 先读取配置文件，使命令行参数可以覆盖配置
+    for (size_t i = 0; i < args.size(); i++) {
+        if ((args[i] == "-c" || args[i] == "--config") && i + 1 < args.size()) {
+            if (!loadSprayPipelineConfig(options.params, args[i + 1], error)) {
+                std::cerr << "❌ " << error << std::endl;
+                return 2;
+            }
+        }
+    }
+
+    // 检查选项是否带有参数值
+    auto requireValue = [&](size_t i) {
+        if (i + 1 >= args.size()) {
+            std::cerr << "❌ 选项缺少参数值: " << args[i] << std::endl;
+            return false;
+        }
+        return true;
+    };
+
+    bool parallelSpecified = false;
+    bool templateSpecified = false;
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string& arg = args[i];
+
+        if (arg == "-h" || arg == "--help") {
+            printUsage(std::cout);
+            return 1;
+        } else if (arg == "-q" || arg == "--quiet") {
+            options.quiet = true;
+            options.logLevel = SprayLogLevel::Warn;
+        } else if (arg == "--log-level") {
+            if (!requireValue(i)) return 2;
+            if (!parseLogLevel(args[++i], options.logLevel)) {
+                std::cerr << "❌ 无效的日志级别: " << args[i] << std::endl;
+                return 2;
+            }
+        } else if (arg == "--log-file") {
+            if (!requireValue(i)) return 2;
+            options.logFile = args[++i];
+        } else if (arg == "-c" || arg == "--config") {
+            if (!requireValue(i)) return 2;
+            i++; // 已在第一遍处理
+        } else if (arg == "-l" || arg == "--list") {
+            if (!requireValue(i)) return 2;
+            if (!readFileList(args[++i], options.files)) {
+                std::cerr << "❌ 无法读取文件列表: " << args[i] << std::endl;
+                return 2;
+            }
+        } else if (arg == "-o" || arg == "--output") {
+            if (!requireValue(i)) return 2;
+            options.outputDir = args[++i];
+        } else if (arg == "-j" || arg == "--jobs") {
+            if (!requireValue(i)) return 2;
+            try {
+                options.jobs = std::stoi(args[++i]);
+            } catch (...) {
+                options.jobs = -1;
+            }
+            if (options.jobs < 0) {
+                std::cerr << "❌ 无效的并行数: " << args[i] << std::endl;
+                return 2;
+            }
+        } else if (arg == "--profile") {
+            if (!requireValue(i)) return 2;
+            options.profileFile = args[++i];
+        } else if (arg == "--trace") {
+            if (!requireValue(i)) return 2;
+            options.traceFile = args[++i];
+        } else if (arg == "--export-format") {
+            if (!requireValue(i)) return 2;
+            if (!TrajectoryExporter::parseFormat(args[++i], options.exportFormat)) {
+                std::cerr << "❌ 无效的轨迹文件格式: " << args[i] << std::endl;
+                return 2;
+            }
+        } else if (arg == "--export-template") {
+            if (!requireValue(i)) return 2;
+            if (!TrajectoryTemplate::load(args[++i], options.exportTemplate, error)) {
+                std::cerr << "❌ " << error << std::endl;
+                return 2;
+            }
+            if (!TrajectoryExporter::validateTemplate(options.exportTemplate, error)) {
+                std::cerr << "❌ 轨迹模板无效: " << args[i] << ": " << error << std::endl;
+                return 2;
+            }
+            templateSpecified = true;
+        } else if (arg == "--save-program") {
+            options.saveProgram = true;
+        } else if (arg == "--compress-program") {
+            options.saveProgram = true;
+            options.compressProgram = true;
+        } else if (arg == "--list-products") {
+            options.listProducts = true;
+        } else if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+            if (!requireValue(i)) return 2;
+            std::string key = arg.substr(2);
+            if (!setSprayPipelineParam(options.params, key, args[++i], error)) {
+                std::cerr << "❌ " << error << std::endl;
+                return 2;
+            }
+            if (key == "parallel") parallelSpecified = true;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "❌ 未知选项: " << arg << std::endl;
+            return 2;
+        } else {
+            options.files.push_back(arg);
+        }
+    }
+
+    if (options.files.empty()) {
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    // 模板只用于template格式，其他格式下指定模板多半是漏写了 --export-format
+    if (templateSpecified && options.exportFormat != TrajectoryExportFormat::Template) {
+        std::cerr << "❌ --export-template 需要同时指定 --export-format template" << std::endl;
+        return 2;
+    }
+
+    if (options.jobs == 0) {
+        options.jobs = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    options.jobs = std::min<int>(options.jobs, static_cast<int>(options.files.size()));
+
+    // 多个零件并行处理时关闭零件内部的并行，避免线程数过度膨胀
+    if (options.jobs > 1 && !parallelSpecified) {
+        options.params.parallelMode = false;
+    }
+    return 0;
+}
+
+// 将轨迹流式写入文件（格式见TrajectoryExporter）
+static bool writeTrajectories(const fs::path& filename, const std::vector<IntegratedTrajectory>& trajectories,
+                              const CliOptions& options) {
+    TrajectoryExporter exporter;
+    exporter.setTemplate(options.exportTemplate);
+    exporter.setProgramName(filename.stem().string());
+    if (!exporter.open(filename.string(), options.exportFormat)) {
+        return false;
+    }
+    for (const IntegratedTrajectory& trajectory : trajectories) {
+        if (!exporter.writeTrajectory(trajectory)) {
+            exporter.close();
+            return false;
+        }
+    }
+    return exporter.close();
+}
+
+// 写入汇总表
+static void writeSummary(std::ostream& out, const std::vector<SprayPipelineResult>& results,
+                         const std::vector<std::string>& outputNames) {
+    out << "file,output,success,failed_stage,extracted_faces,processed_faces,paths,trajectories,trajectory_length,seconds\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const SprayPipelineResult& result = results[i];
+        out << '"' << result.inputFile << "\",\"" << outputNames[i] << "\"," << (result.success ? 1 : 0) << ','
+            << result.failedStage << ',' << result.extractedFaceCount << ',' << result.processedFaceCount << ','
+            << result.pathCount << ',' << result.trajectoryCount << ','
+            << result.trajectoryLength << ',' << result.elapsedSeconds << '\n';
+    }
+}
+
+// 各输入文件的输出文件名前缀：通常为文件名（不含扩展名）；不同目录中的同名文件加上输入序号，避免互相覆盖。
+// 比较时不区分大小写（Windows文件名不区分大小写）
+static std::vector<std::string> outputBaseNames(const std::vector<std::string>& files) {
+    auto key = [](std::string name) {
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return name;
+    };
+
+    std::map<std::string, int> stemCount;
+    for (const std::string& file : files) {
+        stemCount[key(fs::path(file).stem().string())]++;
+    }
+
+    std::vector<std::string> names(files.size());
+    std::set<std::string> used;
+    for (size_t i = 0; i < files.size(); i++) {
+        std::string name = fs::path(files[i]).stem().string();
+        const std::string suffix = "_" + std::to_string(i + 1);
+        if (stemCount[key(name)] > 1) {
+            name += suffix;
+        }
+        while (!used.insert(key(name)).second) {
+            name += suffix;
+        }
+        names[i] = name;
+    }
+    return names;
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+    // 设置控制台输出编码为UTF-8，解决中文乱码问题
+    SetConsoleOutputCP(CP_UTF8);
+#endif
+
+    CliOptions options;
+    int parseStatus = parseArguments(argc, argv, options);
+    if (parseStatus == 1) return 0;
+    if (parseStatus != 0) return 2;
+
+    if (!options.outputDir.empty()) {
+        std::error_code ec;
+        fs::create_directories(options.outputDir, ec);
+        if (ec) {
+            std::cerr << "❌ 无法创建输出目录: " << options.outputDir << " (" << ec.message() << ")" << std::endl;
+            return 2;
+        }
+    }
+
+    // 流程内部的日志按级别过滤；进度信息直接写到控制台，写之前先清空日志队列以保持先后顺序
+    SprayLog::setLevel(options.logLevel);
+    if (!options.logFile.empty() && !SprayLog::instance().setLogFile(options.logFile)) {
+        std::cerr << "❌ 无法打开日志文件: " << options.logFile << std::endl;
+        return 2;
+    }
+    std::ostream& console = std::cout;
+
+    // 开启性能记录
+    bool profiling = !options.profileFile.empty() || !options.traceFile.empty();
+    if (profiling) {
+        SprayProfiler::instance().reset();
+        SprayProfiler::instance().setEnabled(true);
+    }
+
+    // STEP转换器的全局参数只初始化一次，避免多线程同时初始化
+    STEPControl_Controller::Init();
+
+    // 只列出根实体：用于确定 --products 的序号
+    if (options.listProducts) {
+        OCCHandler handler;
+        int status = 0;
+        for (const std::string& file : options.files) {
+            std::vector<StepProductInfo> products;
+            if (!handler.listStepProducts(file, products)) {
+                status = 1;
+                continue;
+            }
+            SprayLog::instance().flush();
+            console << file << ": " << products.size() << " 个根实体" << std::endl;
+            for (const StepProductInfo& product : products) {
+                console << "  " << product.rootIndex << "\t" << (product.name.empty() ? "-" : product.name)
+                        << "\t" << product.entityType << " " << product.label << std::endl;
+            }
+        }
+        return status;
+    }
+
+    console << "🚀 批处理 " << options.files.size() << " 个零件，并行数 " << options.jobs << std::endl;
+
+    std::vector<SprayPipelineResult> results(options.files.size());
+    const std::vector<std::string> outputNames = outputBaseNames(options.files);
+    std::atomic<size_t> nextIndex(0);
+    std::atomic<int> finishedCount(0);
+    std::mutex consoleMutex;
+
+    // 每个工作线程依次领取下一个零件，使用独立的流程实例处理
+    auto worker = [&]() {
+        for (size_t index = nextIndex++; index < options.files.size(); index = nextIndex++) {
+            const std::string& file = options.files[index];
+            SprayPipeline pipeline(options.params);
+            SprayPipelineResult result = pipeline.run(file);
+
+            bool written = true;
+            if (result.success && !options.outputDir.empty() && pipeline.getProcessor()) {
+                fs::path trajectoryPath = fs::path(options.outputDir) / (outputNames[index] + "_trajectories" +
+                                                                        TrajectoryExporter::fileExtension(options.exportFormat));
+                written = writeTrajectories(trajectoryPath, pipeline.getProcessor()->getIntegratedTrajectories(), options);
+                if (options.saveProgram) {
+                    fs::path programPath = fs::path(options.outputDir) / (outputNames[index] + ".stf");
+                    written = pipeline.getProcessor()->saveProgram(programPath.string(), options.compressProgram) && written;
+                }
+            }
+            // 输出文件写入失败时该零件记为失败（影响退出码与summary.csv）
+            if (!written) {
+                result.success = false;
+                result.failedStage = "export";
+            }
+
+            results[index] = result;
+            int finished = ++finishedCount;
+
+            std::lock_guard<std::mutex> lock(consoleMutex);
+            SprayLog::instance().flush();
+            console << "[" << finished << "/" << options.files.size() << "] ";
+            if (result.success) {
+                console << "✅ " << file << ": " << result.trajectoryCount << " 条轨迹, "
+                        << result.pathCount << " 条路径, " << std::fixed << std::setprecision(2)
+                        << result.elapsedSeconds << " s" << std::defaultfloat << std::endl;
+            } else {
+                console << "❌ " << file << ": 在阶段 " << result.failedStage << " 失败" << std::endl;
+            }
+            if (!written) {
+                console << "⚠️ 写入输出文件失败: " << file << std::endl;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < options.jobs; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    SprayLog::instance().flush();
+
+    int failedCount = 0;
+    for (const SprayPipelineResult& result : results) {
+        if (!result.success) failedCount++;
+    }
+
+    if (!options.outputDir.empty()) {
+        std::ofstream summary(fs::path(options.outputDir) / "summary.csv");
+        writeSummary(summary, results, outputNames);
+    }
+
+    if (profiling) {
+        SprayProfiler& profiler = SprayProfiler::instance();
+        profiler.setEnabled(false);
+        console << profiler.report().toText();
+        if (!options.profileFile.empty() && !profiler.writeJson(options.profileFile)) {
+            console << "⚠️ 写入性能报告失败: " << options.profileFile << std::endl;
+        }
+        if (!options.traceFile.empty() && !profiler.writeChromeTrace(options.traceFile)) {
+            console << "⚠️ 写入Chrome Trace失败: " << options.traceFile << std::endl;
+        }
+    }
+
+    console << "📊 完成: 成功 " << (results.size() - failedCount) << " 个，失败 " << failedCount << " 个" << std::endl;
+    return failedCount == 0 ? 0 : 1;
+}
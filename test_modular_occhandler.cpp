@@ -2,8 +2,77 @@
 // 用于验证模块化重构是否正常工作
 
 #include "OCCHandler.h"
+#include "FaceNormalService.h"
+#include "TrajectoryExporter.h"
+#include "TrajectoryFile.h"
+#include <BRepBuilderAPI_MakeEdge.hxx>
+#include <BRepBuilderAPI_MakeFace.hxx>
+#include <BRepBuilderAPI_MakeWire.hxx>
+#include <BRepLib.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <GCE2d_MakeSegment.hxx>
+#include <Geom_CylindricalSurface.hxx>
+#include <gp_Ax3.hxx>
+#include <gp_Pnt2d.hxx>
+#include <gp_Trsf.hxx>
+#include <TopLoc_Location.hxx>
+#include <STEPControl_Writer.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
+
+// 检查失败的数量（非零时程序返回1）
+static int failureCount = 0;
+
+// 输出检查结果
+static void check(bool condition, const std::string& message) {
+    if (condition) {
+        std::cout << "✓ " << message << std::endl;
+    } else {
+        std::cout << "❌ " << message << std::endl;
+        failureCount++;
+    }
+}
+
+// 读取文件的全部字节
+static std::vector<char> readBytes(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    return std::vector<char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// 写入字节到文件
+static void writeBytes(const std::string& filename, const std::vector<char>& bytes) {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// 按小端字节序读取无符号整数
+static uint64_t readLittleEndian(const std::vector<char>& bytes, size_t offset, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; i++) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(bytes[offset + i])) << (8 * i);
+    }
+    return value;
+}
+
+// 测试用的螺旋线路径（相邻点高位字节接近，压缩有效）
+static std::vector<PathPoint> makeHelixPoints(int count) {
+    std::vector<PathPoint> points;
+    for (int i = 0; i < count; i++) {
+        double angle = i * 0.05;
+        gp_Pnt position(100.0 * std::cos(angle), 100.0 * std::sin(angle), 0.5 * i);
+        gp_Dir normal(std::cos(angle), std::sin(angle), 0.2);
+        points.emplace_back(position, normal, i % 50 != 49);
+    }
+    return points;
+}
 
 void testCoreModule() {
     std::cout << "\n=== 测试核心模块 ===" << std::endl;
@@ -61,6 +130,11 @@ void testAdvancedRepairModule() {
     if (!result2) {
         std::cout << "✓ sprayTrajectoryOptimizedRepair()正确处理空模型" << std::endl;
     }
+
+    bool result3 = handler.repairWithPlan(1e-3, false);
+    if (!result3 && handler.getLastRepairReport().operators.empty()) {
+        std::cout << "✓ repairWithPlan()正确处理空模型" << std::endl;
+    }
 }
 
 void testShapeAnalysisModule() {
@@ -92,6 +166,123 @@ void testFaceProcessingModule() {
     if (extractedFaces.IsNull()) {
         std::cout << "✓ extractFacesByNormal()正确处理空模型" << std::endl;
     }
+
+    // 测试多方向面提取
+    std::vector<gp_Dir> directions = { gp_Dir(0, 0, 1), gp_Dir(0, 0, -1), gp_Dir(1, 0, 0) };
+    std::vector<TopoDS_Shape> partitions = handler.extractFacesByNormals(directions, 5.0);
+    if (partitions.size() == directions.size() && partitions.front().IsNull()) {
+        std::cout << "✓ extractFacesByNormals()正确处理空模型" << std::endl;
+    }
+
+    // 测试面法向量服务
+    if (handler.getFaceNormalService() && handler.getFaceNormalService()->size() == 0) {
+        std::cout << "✓ getFaceNormalService()空模型没有缓存项" << std::endl;
+    }
+}
+
+// 形状中的面数量
+static int countFaces(const TopoDS_Shape& shape) {
+    int count = 0;
+    for (TopExp_Explorer exp(shape, TopAbs_FACE); exp.More(); exp.Next()) {
+        count++;
+    }
+    return count;
+}
+
+void testFaceExtractionOnBox() {
+    std::cout << "\n=== 测试长方体的面提取 ===" << std::endl;
+
+    namespace fs = std::filesystem;
+    // OCCHandler只能从STEP文件加载模型：长方体写入临时文件后加载（不修复、不移动）
+    const std::string stepFile = (fs::temp_directory_path() / "sprayr_test_box.step").string();
+    STEPControl_Writer writer;
+    check(writer.Transfer(BRepPrimAPI_MakeBox(100.0, 60.0, 40.0).Shape(), STEPControl_AsIs) == IFSelect_RetDone &&
+          writer.Write(stepFile.c_str()) == IFSelect_RetDone, "长方体STEP文件写出成功");
+
+    OCCHandler handler;
+    check(handler.loadStepFile(stepFile, false, false), "长方体STEP文件加载成功");
+    fs::remove(stepFile);
+
+    // 六个方向各对应长方体的一个面
+    const std::vector<gp_Dir> directions = { gp_Dir(1, 0, 0), gp_Dir(-1, 0, 0), gp_Dir(0, 1, 0),
+                                             gp_Dir(0, -1, 0), gp_Dir(0, 0, 1), gp_Dir(0, 0, -1) };
+    std::vector<TopoDS_Shape> partitions = handler.extractFacesByNormals(directions, 5.0);
+    check(partitions.size() == directions.size(), "extractFacesByNormals()按方向返回结果");
+    for (size_t i = 0; i < partitions.size(); i++) {
+        check(countFaces(partitions[i]) == 1, "extractFacesByNormals()方向 " + std::to_string(i) + " 提取1个面");
+    }
+
+    // 单方向提取与多方向提取的结果一致
+    TopoDS_Shape top = handler.extractFacesByNormal(gp_Dir(0, 0, 1), 5.0, true);
+    check(countFaces(top) == 1, "extractFacesByNormal(+Z)提取1个面");
+    if (countFaces(top) == 1 && partitions.size() == directions.size() && countFaces(partitions[4]) == 1) {
+        TopExp_Explorer single(top, TopAbs_FACE);
+        TopExp_Explorer multiple(partitions[4], TopAbs_FACE);
+        check(single.Current().IsSame(multiple.Current()), "extractFacesByNormal(+Z)与多方向提取的+Z面相同");
+    }
+}
+
+// 两个方向的夹角（度）
+static double angleBetween(const gp_Dir& a, const gp_Dir& b) {
+    return a.Angle(b) * 180.0 / M_PI;
+}
+
+void testFaceNormalService() {
+    std::cout << "\n=== 测试面法向量服务 ===" << std::endl;
+
+    FaceNormalService service;
+    TopoDS_Shape box = BRepPrimAPI_MakeBox(100.0, 60.0, 40.0).Shape();
+    TopoDS_Face top;
+    for (TopExp_Explorer exp(box, TopAbs_FACE); exp.More(); exp.Next()) {
+        gp_Dir normal;
+        if (service.normal(TopoDS::Face(exp.Current()), normal) && angleBetween(normal, gp_Dir(0, 0, 1)) < 1e-6) {
+            top = TopoDS::Face(exp.Current());
+        }
+    }
+    check(!top.IsNull(), "长方体顶面的法向量为+Z");
+    check(service.size() == 6, "长方体六个面各有一个缓存项");
+    if (top.IsNull()) {
+        return;
+    }
+
+    // 反向的面返回相反的法向量（同一缓存项）
+    gp_Dir reversedNormal;
+    check(service.normal(TopoDS::Face(top.Reversed()), reversedNormal) &&
+          angleBetween(reversedNormal, gp_Dir(0, 0, -1)) < 1e-6, "反向面的法向量为-Z");
+
+    // 移动后的面命中缓存，法向量随位置变换（绕X轴旋转90°：+Z → -Y）
+    gp_Trsf rotation;
+    rotation.SetRotation(gp::OX(), M_PI / 2.0);
+    TopoDS_Face moved = TopoDS::Face(top.Moved(TopLoc_Location(rotation)));
+    gp_Dir movedNormal;
+    check(service.normal(moved, movedNormal) && angleBetween(movedNormal, gp_Dir(0, -1, 0)) < 1e-6,
+          "移动后面的法向量随位置变换");
+    check(service.size() == 6, "反向和移动后的面命中缓存");
+
+    // 半圆柱面（半径R，高H）沿对角线裁剪：UV范围内的三角形 (0,0)-(π,0)-(0,H)，
+    // 高度随角度线性减小。面积加权法向量 ∝ (2/π, 1, 0)，而UV中点处的法向量为+Y
+    const double radius = 50.0;
+    const double height = 80.0;
+    Handle(Geom_CylindricalSurface) cylinder = new Geom_CylindricalSurface(gp_Ax3(gp::XOY()), radius);
+    const gp_Pnt2d corners[] = { gp_Pnt2d(0.0, 0.0), gp_Pnt2d(M_PI, 0.0), gp_Pnt2d(0.0, height) };
+    BRepBuilderAPI_MakeWire wire;
+    for (int i = 0; i < 3; i++) {
+        wire.Add(BRepBuilderAPI_MakeEdge(GCE2d_MakeSegment(corners[i], corners[(i + 1) % 3]).Value(), cylinder).Edge());
+    }
+    BRepBuilderAPI_MakeFace makeFace(cylinder, wire.Wire(), Standard_True);
+    check(makeFace.IsDone(), "裁剪半圆柱面创建成功");
+    if (!makeFace.IsDone()) {
+        return;
+    }
+    TopoDS_Face halfCylinder = makeFace.Face();
+    BRepLib::BuildCurves3d(halfCylinder);
+    BRepMesh_IncrementalMesh mesher(halfCylinder, 0.05, Standard_False, 0.05);
+
+    gp_Dir cylinderNormal;
+    const gp_Dir weighted(2.0 / M_PI, 1.0, 0.0);
+    check(service.normal(halfCylinder, cylinderNormal) && angleBetween(cylinderNormal, weighted) < 1.0,
+          "裁剪半圆柱面的法向量为面积加权方向");
+    check(angleBetween(cylinderNormal, gp_Dir(0, 1, 0)) > 20.0, "裁剪半圆柱面的法向量不是UV中点处的法向量");
 }
 
 void testVisualizationModule() {
@@ -108,6 +299,12 @@ void testVisualizationModule() {
     } catch (...) {
         std::cout << "✓ shapeToPolyData()正确处理空模型" << std::endl;
     }
+
+    // 测试B-rep边转换
+    vtkSmartPointer<vtkPolyData> edgeData = handler.shapeEdgesToPolyData();
+    if (edgeData && edgeData->GetNumberOfLines() == 0) {
+        std::cout << "✓ shapeEdgesToPolyData()正确处理空模型" << std::endl;
+    }
 }
 
 void testOcclusionModule() {
@@ -129,6 +326,231 @@ void testOcclusionModule() {
     }
 }
 
+void testTrajectoryFile() {
+    std::cout << "\n=== 测试喷涂程序文件 ===" << std::endl;
+
+    namespace fs = std::filesystem;
+    const std::string directory = fs::temp_directory_path().string();
+
+    SprayPath path;
+    path.points = makeHelixPoints(1000);
+    path.width = 12.5;
+    path.pathIndex = 3;
+    path.planeIndex = 7;
+    path.isConnected = true;
+
+    IntegratedTrajectory trajectory;
+    trajectory.points = makeHelixPoints(600);
+    trajectory.pathSegments = { 0, 200, 400 };
+    trajectory.totalLength = 1234.5;
+    trajectory.trajectoryIndex = 1;
+
+    SurfaceLayer layer;
+    layer.pathIndices = { 3, 4, 5 };
+    layer.averageDepth = 42.0;
+    layer.layerIndex = 0;
+
+    for (bool compress : { false, true }) {
+        const std::string mode = compress ? "压缩" : "未压缩";
+        const std::string filename = directory + (compress ? "/sprayr_test_compressed.stf" : "/sprayr_test_raw.stf");
+
+        TrajectoryFileWriter writer(compress);
+        bool written = writer.open(filename) && writer.writePath(path) && writer.writeTrajectory(trajectory) &&
+                       writer.writeSurfaceLayer(layer) && writer.close();
+        check(written, mode + "文件写入成功");
+
+        TrajectoryFileReader reader;
+        check(reader.open(filename) && reader.getRecordCount() == 3, mode + "文件打开并有3条记录");
+        check(reader.getEntry(0) != nullptr && reader.getEntry(3) == nullptr, mode + "getEntry()检查序号范围");
+        if (compress) {
+            check(reader.getEntry(0) && (reader.getEntry(0)->flags & TRAJECTORY_ENTRY_COMPRESSED),
+                  "路径点块已压缩");
+        }
+
+        std::vector<SprayPath> paths;
+        std::vector<IntegratedTrajectory> trajectories;
+        std::vector<SurfaceLayer> layers;
+        bool read = reader.readAll(paths, trajectories, layers);
+        check(read && paths.size() == 1 && trajectories.size() == 1 && layers.size() == 1, mode + "readAll()读取全部记录");
+        if (read && paths.size() == 1 && trajectories.size() == 1 && layers.size() == 1) {
+            // 位置按double原样保存，法向量保存为float
+            bool pointsMatch = paths[0].points.size() == path.points.size();
+            for (size_t i = 0; pointsMatch && i < path.points.size(); i++) {
+                const PathPoint& expected = path.points[i];
+                const PathPoint& actual = paths[0].points[i];
+                pointsMatch = expected.position.X() == actual.position.X() &&
+                              expected.position.Y() == actual.position.Y() &&
+                              expected.position.Z() == actual.position.Z() &&
+                              expected.normal.Angle(actual.normal) < 1e-5 &&
+                              expected.isSprayPoint == actual.isSprayPoint;
+            }
+            check(pointsMatch, mode + "路径点往返一致");
+            check(paths[0].width == path.width && paths[0].pathIndex == path.pathIndex &&
+                  paths[0].planeIndex == path.planeIndex && paths[0].isConnected,
+                  mode + "路径属性往返一致");
+            check(trajectories[0].points.size() == trajectory.points.size() &&
+                  trajectories[0].pathSegments == trajectory.pathSegments &&
+                  trajectories[0].totalLength == trajectory.totalLength &&
+                  trajectories[0].trajectoryIndex == trajectory.trajectoryIndex,
+                  mode + "整合轨迹往返一致");
+            check(layers[0].pathIndices == layer.pathIndices && layers[0].averageDepth == layer.averageDepth,
+                  mode + "表面层级往返一致");
+        }
+        reader.close();
+
+        const std::vector<char> original = readBytes(filename);
+        const std::string damaged = directory + "/sprayr_test_damaged.stf";
+
+        // 截断的文件（文件头记录的大小不符）
+        std::vector<char> bytes(original.begin(), original.begin() + original.size() / 2);
+        writeBytes(damaged, bytes);
+        check(!reader.open(damaged), mode + "截断的文件被拒绝");
+
+        // 不足一个文件头
+        bytes.assign(original.begin(), original.begin() + 16);
+        writeBytes(damaged, bytes);
+        check(!reader.open(damaged), mode + "短于文件头的文件被拒绝");
+
+        // 损坏的文件标识
+        bytes = original;
+        bytes[0] = 'X';
+        writeBytes(damaged, bytes);
+        check(!reader.open(damaged), mode + "文件标识损坏的文件被拒绝");
+
+        // 索引偏移超出文件
+        bytes = original;
+        TrajectoryFileHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        header.indexOffset = original.size() + 64;
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        writeBytes(damaged, bytes);
+        check(!reader.open(damaged), mode + "索引偏移损坏的文件被拒绝");
+
+        // 索引项的点块越界：文件可以打开，读取该记录失败
+        bytes = original;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        TrajectoryFileEntry entry;
+        std::memcpy(&entry, bytes.data() + header.indexOffset, sizeof(entry));
+        entry.pointBytes = original.size();
+        std::memcpy(bytes.data() + header.indexOffset, &entry, sizeof(entry));
+        writeBytes(damaged, bytes);
+        SprayPath damagedPath;
+        check(reader.open(damaged) && !reader.readPath(0, damagedPath) && !reader.readAll(paths, trajectories, layers),
+              mode + "点块越界的索引项读取失败");
+        reader.close();
+
+        if (compress) {
+            // 压缩点块的列字节数损坏
+            bytes = original;
+            std::memcpy(&entry, bytes.data() + header.indexOffset, sizeof(entry));
+            uint64_t columnBytes = 1;
+            std::memcpy(bytes.data() + entry.pointOffset, &columnBytes, sizeof(columnBytes));
+            writeBytes(damaged, bytes);
+            check(reader.open(damaged) && !reader.readPath(0, damagedPath), "列字节数损坏的压缩点块读取失败");
+            reader.close();
+        }
+
+        fs::remove(filename);
+        fs::remove(damaged);
+    }
+}
+
+void testTrajectoryExporter() {
+    std::cout << "\n=== 测试轨迹导出 ===" << std::endl;
+
+    namespace fs = std::filesystem;
+    const std::string directory = fs::temp_directory_path().string();
+
+    // 两个路径段，第三个点关闭喷枪
+    IntegratedTrajectory trajectory;
+    trajectory.points = { PathPoint(gp_Pnt(1, 2, 3), gp_Dir(0, 0, 1), true),
+                          PathPoint(gp_Pnt(4, 5, 6), gp_Dir(0, 0, 1), true),
+                          PathPoint(gp_Pnt(7, 8, 9), gp_Dir(0, 1, 0), false) };
+    trajectory.pathSegments = { 0, 2 };
+    trajectory.totalLength = 10.0;
+    trajectory.trajectoryIndex = 7;
+
+    // CSV：表头 + 每点一行，第10列为路径段序号
+    const std::string csvFile = directory + "/sprayr_test_export.csv";
+    TrajectoryExporter csvExporter;
+    check(csvExporter.open(csvFile, TrajectoryExportFormat::Csv) && csvExporter.writeTrajectory(trajectory) &&
+          csvExporter.close() && csvExporter.getPointCount() == 3, "CSV导出成功");
+    std::ifstream csvStream(csvFile);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(csvStream, line);) {
+        lines.push_back(line);
+    }
+    csvStream.close();
+    check(lines.size() == 4 && lines[0] == "trajectory,point,x,y,z,nx,ny,nz,spray,segment,a,b,c", "CSV表头与行数正确");
+    check(lines.size() == 4 && lines[1].compare(0, 20, "7,0,1,2,3,0,0,1,1,0,") == 0 &&
+          lines[3].compare(0, 20, "7,2,7,8,9,0,1,0,0,1,") == 0,
+          "CSV点行内容正确");
+    fs::remove(csvFile);
+
+    // 二进制：文件头32字节、轨迹头16字节、点记录37字节，全部小端
+    const std::string binaryFile = directory + "/sprayr_test_export.bin";
+    TrajectoryExporter binaryExporter;
+    check(binaryExporter.open(binaryFile, TrajectoryExportFormat::Binary) &&
+          binaryExporter.writeTrajectory(trajectory) && binaryExporter.writeTrajectory(trajectory) &&
+          binaryExporter.close(), "二进制导出成功");
+    const std::vector<char> binary = readBytes(binaryFile);
+    const size_t trajectoryBytes = 16 + 3 * 37;
+    bool binarySize = binary.size() == 32 + 2 * trajectoryBytes;
+    check(binarySize && std::memcmp(binary.data(), "SPRAYTRJ", 8) == 0 && readLittleEndian(binary, 8, 4) == 1 &&
+          readLittleEndian(binary, 12, 4) == 37 && readLittleEndian(binary, 16, 8) == 2 &&
+          readLittleEndian(binary, 24, 8) == 6, "二进制文件头与回填计数正确");
+    if (binarySize) {
+        uint64_t xBits = readLittleEndian(binary, 32 + 16, 8);
+        double x = 0.0;
+        std::memcpy(&x, &xBits, sizeof(x));
+        uint32_t nyBits = static_cast<uint32_t>(readLittleEndian(binary, 32 + 16 + 2 * 37 + 24 + 4, 4));
+        float ny = 0.0f;
+        std::memcpy(&ny, &nyBits, sizeof(ny));
+        check(readLittleEndian(binary, 32, 4) == 7 && readLittleEndian(binary, 32 + 8, 8) == 3 && x == 1.0 &&
+              ny == 1.0f && readLittleEndian(binary, 32 + 16 + 36, 1) == 3 &&
+              readLittleEndian(binary, 32 + 16 + 37 + 36, 1) == 1 &&
+              readLittleEndian(binary, 32 + 16 + 2 * 37 + 36, 1) == 2,
+              "二进制轨迹头与点记录正确");
+    }
+    fs::remove(binaryFile);
+
+    // 模板：从文件读取模板，检查节的输出顺序与占位符替换
+    const std::string templateFile = directory + "/sprayr_test_template.txt";
+    std::ofstream templateStream(templateFile);
+    templateStream << "[header]\nBEGIN {program}\n[trajectory]\nT{trajectory}\n[segment]\nS{segment}\n"
+                   << "[spray_on]\nON\n[spray_off]\nOFF\n[point]\nP{index} {x} {y} {z} {spray}\n"
+                   << "[trajectory_end]\nTE\n[footer]\nEND\n";
+    templateStream.close();
+    TrajectoryTemplate textTemplate;
+    std::string error;
+    check(TrajectoryTemplate::load(templateFile, textTemplate, error), "模板文件读取成功");
+
+    const std::string programFile = directory + "/sprayr_test_export.src";
+    TrajectoryExporter templateExporter;
+    templateExporter.setTemplate(textTemplate);
+    templateExporter.setProgramName("TEST");
+    templateExporter.setDecimals(1);
+    check(templateExporter.open(programFile, TrajectoryExportFormat::Template) &&
+          templateExporter.writeTrajectory(trajectory) && templateExporter.close(), "模板导出成功");
+    const std::vector<char> program = readBytes(programFile);
+    const std::string expected = "BEGIN TEST\nT7\nS0\nON\nP0 1.0 2.0 3.0 1\nP1 4.0 5.0 6.0 1\n"
+                                 "S1\nOFF\nP2 7.0 8.0 9.0 0\nTE\nEND\n";
+    check(std::string(program.begin(), program.end()) == expected, "模板输出内容正确");
+
+    // 未知占位符被拒绝
+    TrajectoryTemplate badTemplate = TrajectoryTemplate::defaultTemplate();
+    badTemplate.point = "{unknown}\n";
+    TrajectoryExporter badExporter;
+    badExporter.setTemplate(badTemplate);
+    check(!badExporter.open(programFile, TrajectoryExportFormat::Template), "未知占位符的模板被拒绝");
+    check(TrajectoryExporter::validateTemplate(textTemplate, error), "有效模板通过检查");
+    check(!TrajectoryExporter::validateTemplate(badTemplate, error) && error.find("{unknown}") != std::string::npos,
+          "模板检查报告未知占位符");
+
+    fs::remove(templateFile);
+    fs::remove(programFile);
+}
+
 void testWithRealModel() {
     std::cout << "\n=== 测试真实模型加载 ===" << std::endl;
     
@@ -172,12 +594,20 @@ int main() {
         testAdvancedRepairModule();
         testShapeAnalysisModule();
         testFaceProcessingModule();
+        testFaceExtractionOnBox();
+        testFaceNormalService();
         testVisualizationModule();
         testOcclusionModule();
+        testTrajectoryFile();
+        testTrajectoryExporter();
         
         // 测试真实模型（可选）
         testWithRealModel();
         
+        if (failureCount > 0) {
+            std::cerr << "\n❌ " << failureCount << " 项检查失败" << std::endl;
+            return 1;
+        }
         std::cout << "\n🎉 所有模块测试完成！" << std::endl;
         std::cout << "✅ OCCHandler模块化重构成功" << std::endl;
         
@@ -195,6 +625,6 @@ int main() {
 // 编译说明：
 // 1. 确保所有OCCHandler模块文件都在同一目录
 // 2. 使用以下命令编译（需要配置OCCT和VTK路径）：
-//    g++ -std=c++17 test_modular_occhandler.cpp OCCHandler_*.cpp -I/path/to/occt/include -I/path/to/vtk/include -L/path/to/libs -locct -lvtk -o test_occhandler
+//    g++ -std=c++17 test_modular_occhandler.cpp OCCHandler_*.cpp FaceNormalService.cpp FaceProcessor.cpp TrajectoryFile.cpp TrajectoryExporter.cpp SprayLog.cpp SprayProfiler.cpp -I/path/to/occt/include -I/path/to/vtk/include -L/path/to/libs -locct -lvtk -o test_occhandler
 // 3. 运行测试：
 //    ./test_occhandler